@@ -0,0 +1,379 @@
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+#undef  INCLUDE_TESTSETUP_WITHOUT_BOOST
+
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+
+#include "zypp/base/Json.h"
+#include "zypp/base/Measure.h"
+#include "zypp/PoolQuery.h"
+#include "zypp/Resolver.h"
+#include "zypp/ResPoolProxy.h"
+#include "zypp/DiskUsageCounter.h"
+
+///////////////////////////////////////////////////////////////////
+//
+// Benchmark driver for the hot paths of libzypp.
+//
+// Loads the fixtures in tests/data plus synthetic repositories of
+// configurable size and times the phases users wait for. The result
+// is written as JSON, so it can be compared across releases.
+//
+// Run it via 'make benchmark' or directly:
+//   zypp-benchmark [--repeat N] [--synthetic N] [--filter STRING] [--output FILE]
+//
+// Set ZYPP_PROFILING=/some/file.json to additionally get the
+// aggregated debug::MeasureCounter statistics of the run.
+//
+///////////////////////////////////////////////////////////////////
+
+static std::string appname( "zypp-benchmark" );
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+  {
+    cerr << endl << msg_r << endl << endl;
+  }
+  return exit_r;
+}
+
+int usage( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+  {
+    cerr << endl << msg_r << endl << endl;
+  }
+  cerr << "Usage: " << appname << " [OPTIONS]" << endl;
+  cerr << "  Time pool load, query, solve and commit planning on the test" << endl;
+  cerr << "  fixtures and on synthetic repositories. Writes JSON." << endl;
+  cerr << "  --repeat N     Number of timed iterations per benchmark (default 5)." << endl;
+  cerr << "  --synthetic N  Number of packages in the synthetic repos (default 20000," << endl;
+  cerr << "                 0 to skip them)." << endl;
+  cerr << "  --filter STR   Run only benchmarks whose 'fixture/name' contains STR." << endl;
+  cerr << "  --output FILE  Write the JSON result to FILE instead of stdout." << endl;
+  cerr << "" << endl;
+  return exit_r;
+}
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class Benchmark
+  /// \brief Time a function several times and collect the statistics.
+  ///////////////////////////////////////////////////////////////////
+  class Benchmark
+  {
+  public:
+    Benchmark( unsigned repeat_r, const std::string & filter_r )
+    : _repeat( repeat_r ? repeat_r : 1 )
+    , _filter( filter_r )
+    {}
+
+    /** Whether the benchmark \a name_r on \a fixture_r is selected. */
+    bool wanted( const std::string & fixture_r, const std::string & name_r ) const
+    { return _filter.empty() || ( fixture_r + "/" + name_r ).find( _filter ) != std::string::npos; }
+
+    /** Time \a run_r (returning some result count), calling the untimed \a setup_r before each iteration. */
+    template <class TSetup, class TRun>
+    void run( const std::string & fixture_r, const std::string & name_r, TSetup setup_r, TRun run_r )
+    {
+      if ( ! wanted( fixture_r, name_r ) )
+        return;
+
+      std::vector<unsigned long long> samples;
+      unsigned long long result = 0;
+      for ( unsigned i = 0; i < _repeat; ++i )
+      {
+        setup_r();
+        Clock::time_point start( Clock::now() );
+        result = run_r();
+        samples.push_back( std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - start ).count() );
+      }
+      std::sort( samples.begin(), samples.end() );
+      unsigned long long total = std::accumulate( samples.begin(), samples.end(), 0ULL );
+
+      MIL << fixture_r << "/" << name_r << ": median " << samples[samples.size()/2] << "us (" << result << ")" << endl;
+      _results.add( json::Object {
+        { "fixture",	fixture_r },
+        { "name",	name_r },
+        { "iterations",	samples.size() },
+        { "result",	result },
+        { "min_us",	samples.front() },
+        { "median_us",	samples[samples.size()/2] },
+        { "mean_us",	total / samples.size() },
+        { "max_us",	samples.back() },
+      } );
+    }
+
+    /** JSON representation */
+    std::string asJSON() const
+    {
+      return json::Object {
+        { "libzypp",	VERSION },
+        { "repeat",	_repeat },
+        { "benchmarks",	_results },
+      }.asJSON();
+    }
+
+  private:
+    unsigned _repeat;
+    std::string _filter;
+    json::Array _results;
+  };
+
+  /** Mark the sat pool dirty, so the next access has to prepare it again. */
+  void dirtyPool()
+  {
+    sat::Pool::instance().reposInsert( "benchmark-dirty" ).eraseFromPool();
+  }
+
+  /** Remove all repos from the pool. */
+  void clearPool()
+  {
+    sat::Pool satpool( sat::Pool::instance() );
+    while ( ! satpool.reposEmpty() )
+      satpool.reposBegin()->eraseFromPool();
+  }
+
+  /** Reset all transact states and the resolvers upgrade mode. */
+  void resetPool()
+  {
+    for ( const PoolItem & pi : ResPool::instance() )
+      pi.statusReset();
+    getZYpp()->resolver()->setUpgradeMode( false );
+  }
+
+  /** Select every \a step_r-th available package not yet installed (deterministic). */
+  unsigned selectPackages( unsigned step_r = 50 )
+  {
+    unsigned cnt = 0;
+    unsigned selected = 0;
+    for ( const PoolItem & pi : ResPool::instance().byKind<Package>() )
+    {
+      if ( pi.status().isInstalled() || ( ++cnt % step_r ) )
+        continue;
+      pi.status().setToBeInstalled( ResStatus::USER );
+      ++selected;
+    }
+    return selected;
+  }
+
+  /** Load \a path_r as repo \a alias_r via the RepoManager and time reloading it from the solv cache. */
+  void benchLoadFromCache( Benchmark & bench_r, TestSetup & test_r, const std::string & fixture_r, const Pathname & path_r, const std::string & alias_r )
+  {
+    RepoManager repoManager( test_r.repomanager() );
+    RepoInfo nrepo;
+    nrepo.setAlias( alias_r );
+    nrepo.setGpgCheck( false );
+    nrepo.addBaseUrl( path_r.asUrl() );
+    repoManager.addRepository( nrepo );
+    repoManager.buildCache( nrepo );
+
+    bench_r.run( fixture_r, "RepoManager::loadFromCache",
+                 [&]() { sat::Pool::instance().reposErase( alias_r ); },
+                 [&]() { repoManager.loadFromCache( nrepo ); return sat::Pool::instance().reposFind( alias_r ).solvablesSize(); } );
+
+    if ( sat::Pool::instance().reposFind( alias_r ) == Repository::noRepository )
+      repoManager.loadFromCache( nrepo );	// filtered out
+  }
+
+  /** The benchmarks running on whatever is currently loaded. */
+  void benchPool( Benchmark & bench_r, const std::string & fixture_r, const std::string & searchstr_r )
+  {
+    bench_r.run( fixture_r, "sat::Pool::prepare",
+                 dirtyPool,
+                 []() { sat::Pool::instance().prepare(); return sat::Pool::instance().solvablesSize(); } );
+
+    bench_r.run( fixture_r, "ResPoolProxy",
+                 []() { dirtyPool(); ResPool::instance().size(); },
+                 []() { return ResPool::instance().proxy().size(); } );
+
+    bench_r.run( fixture_r, "PoolQuery::name",
+                 [](){},
+                 [&]() {
+                   PoolQuery q;
+                   q.addAttribute( sat::SolvAttr::name, searchstr_r );
+                   q.setMatchSubstring();
+                   q.setCaseSensitive( false );
+                   return q.size();
+                 } );
+
+    bench_r.run( fixture_r, "PoolQuery::description",
+                 [](){},
+                 [&]() {
+                   PoolQuery q;
+                   q.addString( searchstr_r );
+                   q.addAttribute( sat::SolvAttr::summary );
+                   q.addAttribute( sat::SolvAttr::description );
+                   q.setMatchSubstring();
+                   q.setCaseSensitive( false );
+                   return q.size();
+                 } );
+
+    bench_r.run( fixture_r, "Resolver::resolvePool",
+                 []() { resetPool(); selectPackages(); },
+                 []() { return (unsigned long long)getZYpp()->resolver()->resolvePool(); } );
+
+    bench_r.run( fixture_r, "DiskUsageCounter::disk_usage",
+                 []() { resetPool(); selectPackages( 5 ); },
+                 []() {
+                   DiskUsageCounter counter( DiskUsageCounter::justRootPartition() );
+                   return counter.disk_usage( ResPool::instance() ).begin()->pkg_size;
+                 } );
+
+    if ( ! sat::Pool::instance().systemRepo().solvablesEmpty() )
+    {
+      bench_r.run( fixture_r, "Resolver::doUpgrade",
+                   resetPool,
+                   []() { return (unsigned long long)getZYpp()->resolver()->doUpgrade(); } );
+    }
+    resetPool();
+  }
+
+  /** Write a rpm-md repo of \a size_r packages (with dependency chains) below \a dir_r. */
+  void writeSyntheticRepo( const Pathname & dir_r, unsigned size_r, const std::string & version_r )
+  {
+    filesystem::assert_dir( dir_r / "repodata" );
+    Pathname primary( dir_r / "repodata/primary.xml" );
+    {
+      std::ofstream out( primary.c_str() );
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
+      out << "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\"" << size_r << "\">" << endl;
+      for ( unsigned i = 0; i < size_r; ++i )
+      {
+        std::string name( str::form( "synthetic-%06u", i ) );
+        out << "<package type=\"rpm\">" << endl;
+        out << "  <name>" << name << "</name>" << endl;
+        out << "  <arch>x86_64</arch>" << endl;
+        out << "  <version epoch=\"0\" ver=\"" << version_r << "\" rel=\"1\"/>" << endl;
+        out << "  <summary>Synthetic package number " << i << "</summary>" << endl;
+        out << "  <description>Benchmark data for the " << ( i % 3 ? "console" : "graphical" ) << " group, package " << i << ".</description>" << endl;
+        out << "  <time file=\"1\" build=\"1\"/>" << endl;
+        out << "  <size package=\"" << 1000 + i << "\" installed=\"" << 4000 + i << "\" archive=\"" << 4000 + i << "\"/>" << endl;
+        out << "  <location href=\"x86_64/" << name << "-" << version_r << "-1.x86_64.rpm\"/>" << endl;
+        out << "  <format>" << endl;
+        out << "    <rpm:license>GPL</rpm:license>" << endl;
+        out << "    <rpm:provides>" << endl;
+        out << "      <rpm:entry name=\"" << name << "\" flags=\"EQ\" epoch=\"0\" ver=\"" << version_r << "\" rel=\"1\"/>" << endl;
+        out << "      <rpm:entry name=\"synthetic-capability-" << i % 100 << "\"/>" << endl;
+        out << "    </rpm:provides>" << endl;
+        if ( i % 10 )	// chains of 10 packages; each one requiring its predecessor
+        {
+          out << "    <rpm:requires>" << endl;
+          out << "      <rpm:entry name=\"" << str::form( "synthetic-%06u", i-1 ) << "\"/>" << endl;
+          out << "      <rpm:entry name=\"synthetic-capability-" << ( i + 7 ) % 100 << "\"/>" << endl;
+          out << "    </rpm:requires>" << endl;
+        }
+        out << "    <rpm:file>/usr/share/synthetic/" << name << "</rpm:file>" << endl;
+        out << "  </format>" << endl;
+        out << "</package>" << endl;
+      }
+      out << "</metadata>" << endl;
+    }
+
+    std::ofstream out( ( dir_r / "repodata/repomd.xml" ).c_str() );
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
+    out << "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">" << endl;
+    out << "  <data type=\"primary\">" << endl;
+    out << "    <checksum type=\"sha256\">" << filesystem::checksum( primary, "sha256" ) << "</checksum>" << endl;
+    out << "    <location href=\"repodata/primary.xml\"/>" << endl;
+    out << "  </data>" << endl;
+    out << "</repomd>" << endl;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+/******************************************************************
+**
+**      FUNCTION NAME : main
+**      FUNCTION TYPE : int
+*/
+int main( int argc, char * argv[] )
+{
+  INT << "===[START]==========================================" << endl;
+  appname = Pathname::basename( argv[0] );
+  --argc,++argv;
+
+  unsigned repeat = 5;
+  unsigned synthetic = 20000;
+  std::string filter;
+  Pathname output;
+
+  while ( argc && (*argv)[0] == '-' )
+  {
+    std::string opt( *argv );
+    if ( opt == "--help" || opt == "-h" )
+      return usage( std::string(), 0 );
+
+    --argc,++argv;
+    if ( ! argc )
+      return usage( opt + " requires an argument." );
+
+    if ( opt == "--repeat" )
+      repeat = str::strtonum<unsigned>( *argv );
+    else if ( opt == "--synthetic" )
+      synthetic = str::strtonum<unsigned>( *argv );
+    else if ( opt == "--filter" )
+      filter = *argv;
+    else if ( opt == "--output" )
+      output = *argv;
+    else
+      return usage( "Unknown option " + opt );
+    --argc,++argv;
+  }
+  if ( argc )
+    return usage( "Unexpected argument " + std::string( *argv ) );
+
+  Benchmark bench( repeat, filter );
+  const Pathname datadir( TESTS_SRC_DIR "/data" );
+
+  {
+    TestSetup test( Arch_x86_64 );
+    benchLoadFromCache( bench, test, "openSUSE-11.1", datadir/"openSUSE-11.1", "opensuse" );
+    benchPool( bench, "openSUSE-11.1", "lib" );
+    clearPool();
+  }
+  {
+    TestSetup test( Arch_x86_64 );
+    benchLoadFromCache( bench, test, "obs_virtualbox_11_1", datadir/"obs_virtualbox_11_1", "virtualbox" );
+    benchPool( bench, "obs_virtualbox_11_1", "virtualbox" );
+    clearPool();
+  }
+  {
+    TestSetup test( Arch_x86_64 );
+    test.loadTestcaseRepos( datadir/"TCdup" );
+    benchPool( bench, "TCdup", "package" );
+    clearPool();
+  }
+  if ( synthetic )
+  {
+    const std::string fixture( str::form( "synthetic-%u", synthetic ) );
+    TestSetup test( Arch_x86_64 );
+    writeSyntheticRepo( test.root() / "synthetic-system", synthetic, "1.0" );
+    writeSyntheticRepo( test.root() / "synthetic-update", synthetic, "1.1" );
+    test.loadTargetRepo( test.root() / "synthetic-system" );
+    benchLoadFromCache( bench, test, fixture, test.root() / "synthetic-update", "synthetic" );
+    benchPool( bench, fixture, "graphical" );
+    clearPool();
+  }
+
+  if ( output.empty() )
+    cout << bench.asJSON() << endl;
+  else
+  {
+    std::ofstream out( output.c_str() );
+    out << bench.asJSON() << endl;
+    if ( ! out )
+      return errexit( "Can't write " + output.asString() );
+  }
+
+  INT << "===[END]============================================" << endl << endl;
+  return 0;
+}
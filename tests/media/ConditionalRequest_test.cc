@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/ConditionalRequest.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  CacheValidators validators( const std::string & etag_r, const std::string & lastModified_r )
+  {
+    CacheValidators ret;
+    ret.etag = etag_r;
+    ret.lastModified = lastModified_r;
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/".validators" );
+  Url url( "http://example.com/repo/oss?proxy=none" );
+
+  {
+    ScopedConditionalRequest conditional( file, url );
+    BOOST_CHECK( conditional.request( "repodata/repomd.xml" ).empty() );
+    BOOST_CHECK( ! conditional.notModified() );
+
+    conditional.reply( "repodata/repomd.xml", validators( "\"abc\"", "Tue, 15 Nov 1994 08:12:31 GMT" ), false );
+    conditional.reply( "repodata/other", validators( "bad|etag", "" ), false );
+    conditional.save();
+  }
+  BOOST_CHECK( PathInfo( file ).isFile() );
+
+  {
+    // query string is not part of the validators url
+    ScopedConditionalRequest conditional( file, Url( "http://example.com/repo/oss" ) );
+    CacheValidators sent( conditional.request( "/repodata/repomd.xml" ) );
+    BOOST_CHECK_EQUAL( sent.etag, "\"abc\"" );
+    BOOST_CHECK_EQUAL( sent.lastModified, "Tue, 15 Nov 1994 08:12:31 GMT" );
+    BOOST_CHECK( conditional.request( "/repodata/other" ).empty() );	// not saved
+  }
+  {
+    // validators from a different server are not used
+    ScopedConditionalRequest conditional( file, Url( "http://mirror.example.com/repo/oss" ) );
+    BOOST_CHECK( conditional.request( "/repodata/repomd.xml" ).empty() );
+
+    conditional.save();	// nothing received: file is removed
+  }
+  BOOST_CHECK( ! PathInfo( file ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(not_modified)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/".validators" );
+  Url url( "http://example.com/repo" );
+  {
+    ScopedConditionalRequest conditional( file, url );
+    conditional.reply( "content", validators( "\"1\"", "" ), false );
+    conditional.reply( "media.1/media", validators( "", "Tue, 15 Nov 1994 08:12:31 GMT" ), false );
+    conditional.save();
+  }
+
+  ScopedConditionalRequest conditional( file, url );
+  // 304 need not repeat the validators; the ones sent are kept
+  conditional.reply( "content", CacheValidators(), true );
+  BOOST_CHECK( conditional.notModified( "content" ) );
+  BOOST_CHECK( conditional.notModified() );
+
+  conditional.reply( "media.1/media", validators( "", "Wed, 16 Nov 1994 08:12:31 GMT" ), false );
+  BOOST_CHECK( ! conditional.notModified( "media.1/media" ) );
+  BOOST_CHECK( ! conditional.notModified() );
+
+  conditional.save();
+  ScopedConditionalRequest reloaded( file, url );
+  BOOST_CHECK_EQUAL( reloaded.request( "content" ).etag, "\"1\"" );
+  BOOST_CHECK_EQUAL( reloaded.request( "media.1/media" ).lastModified, "Wed, 16 Nov 1994 08:12:31 GMT" );
+}
+
+BOOST_AUTO_TEST_CASE(scope)
+{
+  filesystem::TmpDir tmp;
+  BOOST_CHECK( ! ScopedConditionalRequest::current() );
+  {
+    ScopedConditionalRequest outer( tmp.path()/"outer", Url( "http://example.com" ) );
+    BOOST_CHECK_EQUAL( ScopedConditionalRequest::current(), &outer );
+    {
+      ScopedConditionalRequest inner( tmp.path()/"inner", Url( "http://example.com" ) );
+      BOOST_CHECK_EQUAL( ScopedConditionalRequest::current(), &inner );
+    }
+    BOOST_CHECK_EQUAL( ScopedConditionalRequest::current(), &outer );
+  }
+  BOOST_CHECK( ! ScopedConditionalRequest::current() );
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/MediaBlockList.h"
+#include "zypp/Digest.h"
+#include "zypp/TmpPath.h"
+#include "zypp/base/String.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  const size_t blksize = 1024;
+
+  string block( char c )
+  {
+    string ret( blksize, c );
+    ret[0] = '#';	// not just a single repeated char
+    return ret;
+  }
+
+  void writeFile( const Pathname & file_r, const string & content_r )
+  {
+    ofstream str( file_r.c_str() );
+    str << content_r;
+  }
+
+  MediaBlockList blockList( const string & content_r )
+  {
+    MediaBlockList bl( content_r.size() );
+    for ( size_t off = 0; off < content_r.size(); off += blksize )
+    {
+      size_t blkno = bl.addBlock( off, blksize );
+      Digest dig;
+      dig.create( Digest::sha1() );
+      dig.update( content_r.data() + off, blksize );
+      vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, "SHA1", sum.size(), &sum[0] );
+      bl.setRsum( blkno, 4, bl.updateRsum( 0, content_r.data() + off, blksize ) );
+    }
+    return bl;
+  }
+
+  string readBack( FILE * fp_r, size_t size_r )
+  {
+    string ret( size_r, '\0' );
+    rewind( fp_r );
+    size_t got = fread( &ret[0], 1, size_r, fp_r );
+    ret.resize( got );
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_from_many_files)
+{
+  filesystem::TmpDir tmp;
+  string content( block('A') + block('B') + block('C') );
+  MediaBlockList bl( blockList( content ) );
+  BOOST_CHECK_EQUAL( bl.numBlocks(), 3 );
+
+  // blocks are found at any offset, spread over several files
+  writeFile( tmp.path()/"seed1", "xxxxx" + block('A') + block('X') );
+  writeFile( tmp.path()/"seed2", block('C') + "yyy" + block('B') );
+  vector<string> seeds;
+  seeds.push_back( (tmp.path()/"missing").asString() );
+  seeds.push_back( (tmp.path()/"seed1").asString() );
+  seeds.push_back( (tmp.path()/"seed2").asString() );
+
+  FILE * fp = tmpfile();
+  bl.reuseBlocks( fp, seeds );
+  BOOST_CHECK_EQUAL( bl.numBlocks(), 0 );
+  BOOST_CHECK( readBack( fp, content.size() ) == content );
+  fclose( fp );
+}
+
+BOOST_AUTO_TEST_CASE(reuse_partial)
+{
+  filesystem::TmpDir tmp;
+  string content( block('A') + block('B') + block('C') );
+  MediaBlockList bl( blockList( content ) );
+
+  writeFile( tmp.path()/"seed", block('C') );
+  FILE * fp = tmpfile();
+  bl.reuseBlocks( fp, vector<string>( 1, (tmp.path()/"seed").asString() ) );
+  // only the missing blocks are left to download
+  BOOST_REQUIRE_EQUAL( bl.numBlocks(), 2 );
+  BOOST_CHECK_EQUAL( bl.getBlock(0).off, 0 );
+  BOOST_CHECK_EQUAL( bl.getBlock(1).off, blksize );
+  fclose( fp );
+}
+
+BOOST_AUTO_TEST_CASE(rsum)
+{
+  MediaBlockList bl( 0 );
+  string data;
+  for ( unsigned i = 0; i < 1000; ++i )
+    data += char( i * 7919 % 251 );
+
+  // any length and any start value, compared to the plain definition
+  for ( size_t len = 0; len < 100; ++len )
+  {
+    unsigned short s = 0x1234, m = 0xfedc;
+    for ( size_t i = 0; i < len; ++i )
+    {
+      s += (unsigned char)data[i+3];
+      m += s;
+    }
+    BOOST_CHECK_EQUAL( bl.updateRsum( 0x1234fedc, data.data() + 3, len ), unsigned(s) << 16 | m );
+  }
+  BOOST_CHECK_EQUAL( bl.updateRsum( bl.updateRsum( 0, data.data(), 333 ), data.data() + 333, 667 ),
+                     bl.updateRsum( 0, data.data(), 1000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(reuse_large_shifted)
+{
+  filesystem::TmpDir tmp;
+  // larger than the scan buffer, so the window crosses its boundaries
+  string content;
+  for ( char c = 'A'; content.size() < 1024 * blksize; c = ( c == 'Z' ? 'A' : c + 1 ) )
+    content += block( c ) + str::numstring( content.size() );
+  content.resize( 1024 * blksize );
+  MediaBlockList bl( blockList( content ) );
+
+  // shifted and with one block changed
+  string seed( "xyz" + content );
+  seed[3 + 700 * blksize + 5] ^= 1;
+  writeFile( tmp.path()/"seed", seed );
+  FILE * fp = tmpfile();
+  bl.reuseBlocks( fp, vector<string>( 1, (tmp.path()/"seed").asString() ) );
+  BOOST_REQUIRE_EQUAL( bl.numBlocks(), 1 );
+  BOOST_CHECK_EQUAL( bl.getBlock(0).off, 700 * blksize );
+  string result( readBack( fp, content.size() ) );
+  BOOST_CHECK( result.compare( 0, 700 * blksize, content, 0, 700 * blksize ) == 0 );
+  BOOST_CHECK( result.compare( 701 * blksize, string::npos, content, 701 * blksize, string::npos ) == 0 );
+  fclose( fp );
+}
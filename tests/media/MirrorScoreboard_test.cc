@@ -0,0 +1,115 @@
+#include <cstdarg>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/MirrorScoreboard.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  vector<Url> urls( const char * first_r, ... )
+  {
+    vector<Url> ret;
+    va_list ap;
+    va_start( ap, first_r );
+    for ( const char * url = first_r; url; url = va_arg( ap, const char * ) )
+      ret.push_back( Url( url ) );
+    va_end( ap );
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(score)
+{
+  filesystem::TmpDir tmp;
+  MirrorScoreboard board( tmp.path()/"mirrors.scores" );
+  Url url( "http://fast.example.com/repo/x.rpm" );
+  BOOST_CHECK( board.score( url ).empty() );
+
+  board.success( url, 1000000, 0.1 );
+  MirrorScoreboard::Score s( board.score( Url( "http://fast.example.com/other/path" ) ) );	// per host
+  BOOST_CHECK( ! s.empty() );
+  BOOST_CHECK_EQUAL( s.throughput, 1000000 );
+  BOOST_CHECK_EQUAL( s.failureRate, 0 );
+
+  board.failure( url );
+  BOOST_CHECK( board.score( url ).failureRate > 0 );
+  BOOST_CHECK( board.score( url ).rank() > s.rank() );
+
+  // different port, different server
+  BOOST_CHECK( board.score( Url( "http://fast.example.com:8080/repo" ) ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE(order_and_persist)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path()/"mirrors.scores" );
+  {
+    MirrorScoreboard board( file );
+    board.success( Url( "http://slow.example.com" ), 10000, 1.0 );
+    board.success( Url( "http://fast.example.com" ), 10000000, 0.05 );
+    board.success( Url( "http://medium.example.com" ), 500000, 0.2 );
+    board.failure( Url( "http://broken.example.com" ) );
+    board.failure( Url( "http://broken.example.com" ) );
+    board.save();
+  }
+  BOOST_CHECK( PathInfo( file ).isFile() );
+
+  MirrorScoreboard board( file );
+  vector<Url> mirrors( urls( "http://slow.example.com/repo",
+                             "http://unknown1.example.com/repo",
+                             "http://broken.example.com/repo",
+                             "http://fast.example.com/repo",
+                             "http://unknown2.example.com/repo",
+                             "http://medium.example.com/repo",
+                             nullptr ) );
+  board.order( mirrors );
+  // unknown hosts rank like the median, keeping their relative order
+  BOOST_CHECK_EQUAL( mirrors[0].getHost(), "fast.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[1].getHost(), "unknown1.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[2].getHost(), "unknown2.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[3].getHost(), "medium.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[4].getHost(), "slow.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[5].getHost(), "broken.example.com" );
+
+  // without any score the order is kept
+  vector<Url> none( urls( "http://b.example.com", "http://a.example.com", nullptr ) );
+  board.order( none );
+  BOOST_CHECK_EQUAL( none[0].getHost(), "b.example.com" );
+}
+
+BOOST_AUTO_TEST_CASE(unknown_throughput)
+{
+  filesystem::TmpDir tmp;
+  MirrorScoreboard board( tmp.path()/"mirrors.scores" );
+  // only small files were fetched from 'small': no throughput
+  board.success( Url( "http://small.example.com" ), 0, 0.05 );
+  board.success( Url( "http://slow.example.com" ), 10000, 1.0 );
+  board.success( Url( "http://fast.example.com" ), 10000000, 0.05 );
+  board.success( Url( "http://medium.example.com" ), 500000, 0.2 );
+  BOOST_CHECK_EQUAL( board.score( Url( "http://small.example.com" ) ).throughput, 0 );
+  BOOST_CHECK( board.score( Url( "http://small.example.com" ) ).rank() < board.score( Url( "http://slow.example.com" ) ).rank() );
+
+  // a later small transfer does not spoil the known throughput
+  board.success( Url( "http://fast.example.com" ), 0, 0.05 );
+  BOOST_CHECK_EQUAL( board.score( Url( "http://fast.example.com" ) ).throughput, 10000000 );
+
+  vector<Url> mirrors( urls( "http://slow.example.com/repo",
+                             "http://medium.example.com/repo",
+                             "http://small.example.com/repo",
+                             "http://fast.example.com/repo",
+                             nullptr ) );
+  board.order( mirrors );
+  // 'small' is assumed to have the median throughput
+  BOOST_CHECK_EQUAL( mirrors[0].getHost(), "fast.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[1].getHost(), "small.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[2].getHost(), "medium.example.com" );
+  BOOST_CHECK_EQUAL( mirrors[3].getHost(), "slow.example.com" );
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/Mount.h"
+#include "zypp/TmpPath.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+BOOST_AUTO_TEST_CASE(entries_from_file)
+{
+  filesystem::TmpDir tmp;
+  Pathname mtab( tmp.path()/"mtab" );
+  {
+    ofstream str( mtab.c_str() );
+    str << "/dev/sda1 / ext4 rw,relatime 0 1" << endl;
+    str << "//server/share/ /mnt/share cifs ro 0 0" << endl;
+  }
+  MountEntries entries( Mount::getEntries( mtab.asString() ) );
+  BOOST_REQUIRE_EQUAL( entries.size(), 2 );
+  BOOST_CHECK_EQUAL( entries[0].dir, "/" );
+  BOOST_CHECK_EQUAL( entries[0].pass, 1 );
+  BOOST_CHECK_EQUAL( entries[1].src, "//server/share" );	// trailing '/' removed
+  BOOST_CHECK_EQUAL( entries[1].type, "cifs" );
+}
+
+BOOST_AUTO_TEST_CASE(cached_entries)
+{
+  MountEntries entries( Mount::getEntries() );
+  BOOST_CHECK( ! entries.empty() );
+
+  // nothing mounted meanwhile, so the time stamp does not change
+  time_t mtime = Mount::getMTime();
+  BOOST_CHECK( mtime > 0 );
+  BOOST_CHECK_EQUAL( Mount::getMTime(), mtime );
+  BOOST_CHECK_EQUAL( Mount::getEntries().size(), entries.size() );
+  BOOST_CHECK_EQUAL( Mount::getMTime(), mtime );
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/PartialDownload.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/base/String.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  CacheValidators validators( const std::string & etag_r, const std::string & lastModified_r )
+  {
+    CacheValidators ret;
+    ret.etag = etag_r;
+    ret.lastModified = lastModified_r;
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(state)
+{
+  filesystem::TmpDir tmp;
+  Url url( "http://example.com/repo/x86_64/foo-1.0-1.x86_64.rpm" );
+  {
+    PartialDownload partial( tmp.path(), url );
+    BOOST_CHECK_EQUAL( partial.file().dirname(), tmp.path() );
+    BOOST_CHECK( str::hasPrefix( partial.file().basename(), "foo-1.0-1.x86_64.rpm-" ) );
+    BOOST_CHECK( ! partial.exists() );
+    BOOST_CHECK( ! partial.resumable() );
+
+    Pathname data( tmp.path()/"data" );
+    ofstream( data.c_str() ) << "0123456789";
+    BOOST_CHECK( partial.keep( data ) );
+    partial.save( validators( "\"abc\"", "Tue, 15 Nov 1994 08:12:31 GMT" ), 100 );
+  }
+  {
+    // the data survive the (temporary) download target
+    PartialDownload partial( tmp.path(), url );
+    BOOST_CHECK( partial.exists() );
+    BOOST_CHECK_EQUAL( partial.validators().lastModified, "Tue, 15 Nov 1994 08:12:31 GMT" );
+    BOOST_CHECK_EQUAL( partial.ifRange(), "\"abc\"" );
+    BOOST_CHECK_EQUAL( partial.size(), 100 );
+    BOOST_CHECK( partial.resumable() );
+
+    // a different url uses a different file
+    PartialDownload mirror( tmp.path(), Url( "http://mirror.example.com/repo/x86_64/foo-1.0-1.x86_64.rpm" ) );
+    BOOST_CHECK( mirror.file() != partial.file() );
+    BOOST_CHECK( ! mirror.exists() );
+
+    // weak etags can't be used in If-Range
+    partial.save( validators( "W/\"abc\"", "Tue, 15 Nov 1994 08:12:31 GMT" ), 100 );
+    BOOST_CHECK_EQUAL( partial.ifRange(), "Tue, 15 Nov 1994 08:12:31 GMT" );
+    BOOST_CHECK( partial.resumable() );
+
+    // no validator: the changed file would not be detected
+    partial.save( validators( "W/\"abc\"", "" ), 100 );
+    BOOST_CHECK( partial.exists() );
+    BOOST_CHECK( ! partial.resumable() );
+
+    // nothing left to resume
+    partial.save( validators( "\"abc\"", "" ), 10 );
+    BOOST_CHECK( ! partial.resumable() );
+
+    partial.discard();
+    BOOST_CHECK( ! partial.exists() );
+    BOOST_CHECK( ! PathInfo( partial.file().extend( ".state" ) ).isExist() );
+  }
+}
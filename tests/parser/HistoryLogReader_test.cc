@@ -1,6 +1,16 @@
 #include "TestSetup.h"
 #include "zypp/parser/HistoryLogReader.h"
 #include "zypp/parser/ParseException.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/HistoryLog.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/base/GzStream.h"
+
+#include <unistd.h>
+#include <fstream>
 
 using namespace zypp;
 
@@ -48,3 +58,255 @@ BOOST_AUTO_TEST_CASE(basic)
   HistoryLogDataInstall::Ptr p = dynamic_pointer_cast<HistoryLogDataInstall>( history[1] );
   BOOST_CHECK_EQUAL( p->userdata(), "trans|ID" ); // properly (un)escaped?
 }
+
+namespace
+{
+  /** Write a time ordered log with a record every 10 minutes,
+   * optionally along with a day index.
+   */
+  void writeLog( const Pathname & file_r, unsigned records_r, bool index_r )
+  {
+    std::ofstream log( file_r.c_str() );
+    std::ofstream index;
+    if ( index_r )
+      index.open( file_r.extend( HISTORY_LOG_INDEX_SUFFIX ).c_str() );
+
+    std::string lastDay;
+    Date start( "2015-01-01 00:00:00", HISTORY_LOG_DATE_FORMAT );
+    for ( unsigned i = 0; i < records_r; ++i )
+    {
+      std::string date( (start + i*10*Date::minute).form( HISTORY_LOG_DATE_FORMAT ) );
+      if ( index_r && date.substr( 0, 10 ) != lastDay )
+      {
+	lastDay = date.substr( 0, 10 );
+	index << lastDay << "|" << log.tellp() << endl;
+      }
+      log << date << "|command|root@host|'zypper' 'ref' '" << i << "'|" << endl;
+      if ( i % 100 == 0 )
+	log << "# comment" << endl;
+    }
+  }
+
+  unsigned countFrom( const Pathname & file_r, const Date & from_r, const Date & to_r = Date() )
+  {
+    unsigned count = 0;
+    parser::HistoryLogReader parser( file_r, parser::HistoryLogReader::Options(),
+      [&count,&from_r]( HistoryLogData::Ptr ptr )->bool {
+	BOOST_CHECK( ptr->date() > from_r );
+	++count;
+	return true;
+      } );
+    if ( to_r )
+      parser.readFromTo( from_r, to_r );
+    else
+      parser.readFrom( from_r );
+    return count;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(readFrom_seek)
+{
+  filesystem::TmpDir tmp;
+  Pathname logfile( tmp.path() / "history" );
+  Date start( "2015-01-01 00:00:00", HISTORY_LOG_DATE_FORMAT );
+  Date from( start + 5000*10*Date::minute );
+  Date to( start + 7000*10*Date::minute );
+
+  // bisect
+  writeLog( logfile, 10000, false );
+  BOOST_CHECK_EQUAL( countFrom( logfile, start - Date::day ), 10000 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from ), 4999 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from + Date::minute ), 4999 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from, to ), 1999 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, start + 20000*10*Date::minute ), 0 );
+
+  // day index
+  writeLog( logfile, 10000, true );
+  BOOST_CHECK_EQUAL( countFrom( logfile, start - Date::day ), 10000 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from ), 4999 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from, to ), 1999 );
+
+  // stale index is ignored
+  writeLog( logfile, 5000, false );
+  BOOST_CHECK_EQUAL( countFrom( logfile, start + 4000*10*Date::minute ), 999 );
+
+  // stale offsets within the file (pointing mid-line) are ignored too
+  writeLog( logfile, 10000, true );
+  {
+    std::ifstream in( logfile.c_str() );
+    std::string content( (std::istreambuf_iterator<char>( in )), std::istreambuf_iterator<char>() );
+    std::ofstream out( logfile.c_str() );
+    out << "# shifted" << endl << content;
+  }
+  BOOST_CHECK_EQUAL( countFrom( logfile, from ), 4999 );
+  BOOST_CHECK_EQUAL( countFrom( logfile, from, to ), 1999 );
+}
+
+BOOST_AUTO_TEST_CASE(writer_index)
+{
+  filesystem::TmpDir tmp;
+  {
+    HistoryLog log( tmp.path() );
+    log.stampCommand();
+    log.comment( "some comment" );
+    log.stampCommand();
+  }
+  Pathname logfile( tmp.path() / ZConfig::instance().historyLogFile() );
+
+  std::vector<std::string> index;
+  iostr::forEachLine( InputStream( logfile.extend( HISTORY_LOG_INDEX_SUFFIX ) ),
+		      [&index]( int num_r, std::string line_r )->bool { index.push_back( line_r ); return true; } );
+  BOOST_REQUIRE_EQUAL( index.size(), 1 );
+  BOOST_CHECK_EQUAL( index[0], Date::now().form( "%Y-%m-%d" ) + "|0" );
+
+  // a day already in the log is not indexed again
+  filesystem::unlink( logfile.extend( HISTORY_LOG_INDEX_SUFFIX ) );
+  HistoryLog().stampCommand();
+  BOOST_CHECK( ! PathInfo( logfile.extend( HISTORY_LOG_INDEX_SUFFIX ) ).isExist() );
+
+  unsigned count = 0;
+  parser::HistoryLogReader parser( logfile, parser::HistoryLogReader::Options(),
+    [&count]( HistoryLogData::Ptr ptr )->bool { ++count; return true; } );
+  parser.readFrom( Date::now() - Date::day );
+  BOOST_CHECK_EQUAL( count, 3 );
+}
+
+BOOST_AUTO_TEST_CASE(rotated_logs)
+{
+  filesystem::TmpDir tmp;
+  Pathname logfile( tmp.path() / "history" );
+  Date start( "2015-01-01 00:00:00", HISTORY_LOG_DATE_FORMAT );
+
+  // 3 rotated logs (1 plain, 2 compressed) and the current one; 1000 records each
+  writeLog( logfile, 4000, false );
+  {
+    std::ifstream in( logfile.c_str() );
+    std::string line;
+    for ( unsigned seg = 0; seg < 4; ++seg )
+    {
+      Date rotated( start + (seg+1)*1000*10*Date::minute );
+      Pathname file( seg == 3 ? logfile.extend( ".tmp" )
+                              : logfile.extend( rotated.form( "-%Y%m%d%H%M%S" ) + ( seg ? ".gz" : "" ) ) );
+      ofgzstream gzout;
+      std::ofstream out;
+      std::ostream & str( seg ? static_cast<std::ostream&>(gzout) : static_cast<std::ostream&>(out) );
+      if ( seg )
+	gzout.open( file.c_str() );
+      else
+	out.open( file.c_str() );
+
+      for ( unsigned cnt = 0; cnt < 1000 && std::getline( in, line ); )
+      {
+	str << line << endl;
+	if ( line[0] != '#' )
+	  ++cnt;
+      }
+    }
+  }
+  filesystem::rename( logfile.extend( ".tmp" ), logfile );
+  BOOST_CHECK_EQUAL( HistoryLog::rotatedLogs( logfile ).size(), 3 );
+
+  std::vector<unsigned> seen;
+  parser::HistoryLogReader parser( logfile, parser::HistoryLogReader::READ_ROTATED,
+    [&seen]( HistoryLogData::Ptr ptr )->bool {
+      seen.push_back( str::strtonum<unsigned>( (*ptr)[HistoryLogDataStampCommand::COMMAND_INDEX].substr( 11 ) ) );
+      return true;
+    } );
+
+  parser.readAll();
+  BOOST_REQUIRE_EQUAL( seen.size(), 4000 );
+  BOOST_CHECK_EQUAL( seen.front(), 0 );
+  BOOST_CHECK_EQUAL( seen.back(), 3999 );
+
+  seen.clear();
+  parser.readFromTo( start + 1500*10*Date::minute, start + 2500*10*Date::minute );
+  BOOST_REQUIRE_EQUAL( seen.size(), 999 );
+  BOOST_CHECK_EQUAL( seen.front(), 1501 );
+  BOOST_CHECK_EQUAL( seen.back(), 2499 );
+
+  seen.clear();
+  parser::HistoryLogReader rparser( logfile, parser::HistoryLogReader::READ_ROTATED|parser::HistoryLogReader::NEWEST_FIRST,
+    [&seen]( HistoryLogData::Ptr ptr )->bool {
+      seen.push_back( str::strtonum<unsigned>( (*ptr)[HistoryLogDataStampCommand::COMMAND_INDEX].substr( 11 ) ) );
+      return seen.size() < 1500;
+    } );
+  rparser.readFrom( start + 500*10*Date::minute );
+  BOOST_REQUIRE_EQUAL( seen.size(), 1500 );
+  BOOST_CHECK_EQUAL( seen.front(), 3999 );
+  BOOST_CHECK_EQUAL( seen.back(), 2500 );
+
+  seen.clear();
+  parser::HistoryLogReader rparser2( logfile, parser::HistoryLogReader::READ_ROTATED|parser::HistoryLogReader::NEWEST_FIRST,
+    [&seen]( HistoryLogData::Ptr ptr )->bool {
+      seen.push_back( str::strtonum<unsigned>( (*ptr)[HistoryLogDataStampCommand::COMMAND_INDEX].substr( 11 ) ) );
+      return true;
+    } );
+  rparser2.readFromTo( start + 1500*10*Date::minute, start + 2500*10*Date::minute );
+  BOOST_REQUIRE_EQUAL( seen.size(), 999 );
+  BOOST_CHECK_EQUAL( seen.front(), 2499 );
+  BOOST_CHECK_EQUAL( seen.back(), 1501 );
+  for ( unsigned i = 1; i < seen.size(); ++i )
+    BOOST_REQUIRE_EQUAL( seen[i], seen[i-1]-1 );
+
+  seen.clear();
+  rparser2.readAll();
+  BOOST_REQUIRE_EQUAL( seen.size(), 4000 );
+  BOOST_CHECK_EQUAL( seen.front(), 3999 );
+  BOOST_CHECK_EQUAL( seen.back(), 0 );
+}
+
+namespace
+{
+  unsigned countAll( const Pathname & file_r )
+  {
+    unsigned count = 0;
+    parser::HistoryLogReader parser( file_r, parser::HistoryLogReader::READ_ROTATED,
+      [&count]( HistoryLogData::Ptr ptr )->bool { ++count; return true; } );
+    parser.readAll();
+    return count;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(writer_rotation)
+{
+  filesystem::TmpDir tmp;
+  ZConfig::instance().setHistoryLogRotate( ByteCount( 1 ), 0, 2 );
+  HistoryLog( tmp.path() ).stampCommand();
+  Pathname logfile( tmp.path() / ZConfig::instance().historyLogFile() );
+  BOOST_CHECK( HistoryLog::rotatedLogs( logfile ).empty() );
+
+  // a process which opened the log before it is rotated
+  std::ofstream other( logfile.c_str(), std::ios::out|std::ios::app );
+
+  HistoryLog().stampCommand();
+  std::map<Date,Pathname> rotated( HistoryLog::rotatedLogs( logfile ) );
+  BOOST_REQUIRE_EQUAL( rotated.size(), 1 );
+  Pathname first( rotated.begin()->second );
+  BOOST_CHECK_EQUAL( first.basename().size(), std::string( "history-YYYYMMDDhhmmss" ).size() );
+
+  // still appends to the rotated log, which is not yet compressed
+  other << Date::now().form( HISTORY_LOG_DATE_FORMAT ) << "|command|root@host|'other'|" << endl;
+  other.close();
+  BOOST_CHECK_EQUAL( countAll( logfile ), 3 );
+
+  // compressed on the next rotation
+  ::sleep( 1 );
+  HistoryLog().stampCommand();
+  rotated = HistoryLog::rotatedLogs( logfile );
+  BOOST_REQUIRE_EQUAL( rotated.size(), 2 );
+  BOOST_CHECK_EQUAL( rotated.begin()->second, first.extend( ".gz" ) );
+  BOOST_CHECK( ! PathInfo( first ).isExist() );
+  BOOST_CHECK_EQUAL( rotated.rbegin()->second.extension(), "" );
+  BOOST_CHECK_EQUAL( countAll( logfile ), 4 );
+
+  // keep 2
+  ::sleep( 1 );
+  HistoryLog().stampCommand();
+  rotated = HistoryLog::rotatedLogs( logfile );
+  BOOST_REQUIRE_EQUAL( rotated.size(), 2 );
+  BOOST_CHECK( ! PathInfo( first.extend( ".gz" ) ).isExist() );
+  BOOST_CHECK_EQUAL( rotated.begin()->second.extension(), ".gz" );
+  BOOST_CHECK_EQUAL( countAll( logfile ), 3 );
+
+  ZConfig::instance().setHistoryLogRotate( ByteCount(), 0, 0 );
+}
@@ -0,0 +1,91 @@
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/repo/ConfigDirSnapshot.h"
+
+using std::endl;
+using namespace zypp;
+using namespace zypp::repo;
+using namespace boost::unit_test;
+
+static void writeFile( const Pathname & file_r, const std::string & content_r )
+{
+  std::ofstream out( file_r.c_str() );
+  out << content_r;
+}
+
+static std::string content( const ConfigDirSnapshot & snapshot_r, const std::string & name_r )
+{
+  for ( const auto & file : snapshot_r.files() )
+  {
+    if ( file.first.basename() == name_r )
+      return file.second;
+  }
+  return "(missing)";
+}
+
+BOOST_AUTO_TEST_CASE(configdirsnapshot)
+{
+  filesystem::TmpDir tmp;
+  Pathname dir( tmp.path() / "repos.d" );
+  Pathname snapshot( tmp.path() / "repos.d.snapshot" );
+  filesystem::assert_dir( dir );
+  writeFile( dir / "a.repo", "[a]\nenabled=1\n" );
+  writeFile( dir / "b.repo", "[b]\nenabled=1\n" );
+  writeFile( dir / "empty.repo", "" );
+  filesystem::assert_dir( dir / "subdir" );
+
+  {
+    // files just written are not snapshot
+    ConfigDirSnapshot s( dir, snapshot );
+    BOOST_CHECK( ! s.fromSnapshot() );
+    BOOST_CHECK_EQUAL( s.files().size(), 3 );
+    BOOST_CHECK_EQUAL( content( s, "a.repo" ), "[a]\nenabled=1\n" );
+    BOOST_CHECK( ! PathInfo( snapshot ).isExist() );
+  }
+
+  ::sleep( 3 );
+  {
+    ConfigDirSnapshot s( dir, snapshot );
+    BOOST_CHECK( ! s.fromSnapshot() );
+    BOOST_CHECK( PathInfo( snapshot ).isFile() );
+    BOOST_CHECK_EQUAL( PathInfo( snapshot ).perm() & 0777, 0600 );
+  }
+  {
+    ConfigDirSnapshot s( dir, snapshot );
+    BOOST_CHECK( s.fromSnapshot() );
+    BOOST_CHECK_EQUAL( s.files().size(), 3 );
+    BOOST_CHECK_EQUAL( content( s, "a.repo" ), "[a]\nenabled=1\n" );
+    BOOST_CHECK_EQUAL( content( s, "b.repo" ), "[b]\nenabled=1\n" );
+    BOOST_CHECK_EQUAL( content( s, "empty.repo" ), "" );
+    BOOST_CHECK_EQUAL( s.files()[0].first.dirname(), dir );
+  }
+
+  // a modified file (same size) invalidates the snapshot
+  writeFile( dir / "b.repo", "[b]\nenabled=0\n" );
+  {
+    ConfigDirSnapshot s( dir, snapshot );
+    BOOST_CHECK( ! s.fromSnapshot() );
+    BOOST_CHECK_EQUAL( content( s, "b.repo" ), "[b]\nenabled=0\n" );
+  }
+
+  // as does a removed file
+  filesystem::unlink( dir / "a.repo" );
+  {
+    ConfigDirSnapshot s( dir, snapshot );
+    BOOST_CHECK( ! s.fromSnapshot() );
+    BOOST_CHECK_EQUAL( s.files().size(), 2 );
+    BOOST_CHECK_EQUAL( content( s, "a.repo" ), "(missing)" );
+  }
+
+  // no snapshot
+  {
+    ConfigDirSnapshot s( dir, Pathname() );
+    BOOST_CHECK( ! s.fromSnapshot() );
+    BOOST_CHECK_EQUAL( s.files().size(), 2 );
+  }
+}
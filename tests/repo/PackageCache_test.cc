@@ -0,0 +1,132 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sys/time.h>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/repo/PackageCache.h"
+#include "zypp/ContentStore.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::repo;
+
+namespace
+{
+  /** Create a package of \a size_r bytes last modified \a age_r seconds ago. */
+  Pathname mkPackage( const Pathname & file_r, unsigned size_r, Date::ValueType age_r )
+  {
+    filesystem::assert_dir( file_r.dirname() );
+    std::ofstream( file_r.c_str() ) << std::string( size_r, 'x' );
+    Date::ValueType mtime = Date::now() - age_r;
+    struct timeval times[2] = { { mtime, 0 }, { mtime, 0 } };
+    ::utimes( file_r.c_str(), times );
+    return file_r;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(statistics)
+{
+  filesystem::TmpDir tmp;
+  Pathname root( tmp.path() / "packages" );
+  {
+    PackageCache cache( root );
+    BOOST_CHECK_EQUAL( cache.statistics().hitRate(), 0.0 );
+
+    cache.miss( mkPackage( root / "repo/x86_64/a-1-1.x86_64.rpm", 1000, 0 ) );
+    cache.hit( mkPackage( root / "repo/x86_64/c-1-1.x86_64.rpm", 2000, 0 ) );
+    cache.hit( root / "repo/x86_64/c-1-1.x86_64.rpm" );	// same session: no extra hit
+    cache.hit( root / "repo/x86_64/a-1-1.x86_64.rpm" );	// just downloaded: no hit
+    cache.miss( mkPackage( root / "other/b-1-1.noarch.rpm", 500, 0 ), false );	// not kept
+
+    BOOST_CHECK_EQUAL( cache.statistics().hits, 1 );
+    BOOST_CHECK_EQUAL( cache.statistics().misses, 2 );
+    BOOST_CHECK_EQUAL( cache.statistics().hitRate(), 1.0/3 );
+    BOOST_CHECK_EQUAL( cache.statistics().bytesSaved, ByteCount( 2000 ) );
+    BOOST_CHECK_EQUAL( cache.statistics().bytesDownloaded, ByteCount( 1500 ) );
+    BOOST_CHECK_EQUAL( cache.entries().size(), 2 );
+    BOOST_CHECK_EQUAL( cache.size(), ByteCount( 3000 ) );
+    cache.save();
+  }
+  BOOST_CHECK( PathInfo( tmp.path() / "packages.usage" ).isFile() );
+
+  PackageCache cache( root );
+  BOOST_CHECK_EQUAL( cache.statistics().hits, 1 );
+  BOOST_CHECK_EQUAL( cache.statistics().bytesDownloaded, ByteCount( 1500 ) );
+  BOOST_CHECK_EQUAL( cache.entries().size(), 2 );
+  BOOST_CHECK_EQUAL( cache.entries().begin()->first, "repo/x86_64/a-1-1.x86_64.rpm" );
+  BOOST_CHECK_EQUAL( cache.entries().begin()->second.uses, 2 );
+}
+
+BOOST_AUTO_TEST_CASE(evict_lru)
+{
+  filesystem::TmpDir tmp;
+  Pathname root( tmp.path() / "packages" );
+  // found by sync, used when written
+  mkPackage( root / "repo/old.rpm", 1000, 3 * Date::day );
+  mkPackage( root / "repo/older.rpm", 1000, 4 * Date::day );
+  mkPackage( root / "repo/new.rpm", 1000, 1 * Date::day );
+  mkPackage( root / "repo/not-a-package", 1000, 5 * Date::day );
+
+  PackageCache cache( root );
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 0 ), 0 );		// unlimited
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 10000 ), 0 );
+  BOOST_CHECK_EQUAL( cache.size(), ByteCount( 3000 ) );
+
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 1500 ), 2 );
+  BOOST_CHECK( ! PathInfo( root / "repo/older.rpm" ).isExist() );
+  BOOST_CHECK( ! PathInfo( root / "repo/old.rpm" ).isExist() );
+  BOOST_CHECK( PathInfo( root / "repo/new.rpm" ).isExist() );
+  BOOST_CHECK( PathInfo( root / "repo/not-a-package" ).isExist() );
+
+  // what's used in this session is kept, even if the limit is exceeded
+  cache.hit( root / "repo/new.rpm" );
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 1 ), 0 );
+  BOOST_CHECK( PathInfo( root / "repo/new.rpm" ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(evict_lfu)
+{
+  filesystem::TmpDir tmp;
+  Pathname root( tmp.path() / "packages" );
+  mkPackage( root / "repo/popular.rpm", 1000, 3 * Date::day );
+  mkPackage( root / "repo/rare.rpm", 1000, 1 * Date::day );
+  {
+    std::ofstream usage( ( tmp.path() / "packages.usage" ).c_str() );
+    usage << "@hits 4" << endl;
+    usage << Date::ValueType(Date::now() - 3 * Date::day) << " 5 1000 repo/popular.rpm" << endl;
+    usage << Date::ValueType(Date::now() - 1 * Date::day) << " 1 1000 repo/rare.rpm" << endl;
+  }
+
+  BOOST_CHECK_EQUAL( PackageCache::policyFromString( "LFU" ), PackageCache::LFU );
+  BOOST_CHECK_EQUAL( PackageCache::policyFromString( "bogus", PackageCache::LFU ), PackageCache::LFU );
+
+  PackageCache cache( root );
+  BOOST_CHECK_EQUAL( cache.statistics().hits, 4 );
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 1000, PackageCache::LFU ), 1 );
+  BOOST_CHECK( PathInfo( root / "repo/popular.rpm" ).isExist() );
+  BOOST_CHECK( ! PathInfo( root / "repo/rare.rpm" ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(evict_from_store)
+{
+  filesystem::TmpDir tmp;
+  Pathname root( tmp.path() / "packages" );
+  ContentStore store( tmp.path() / "store" );
+  // sha1 of "xxxx"
+  CheckSum sum( "sha1", "4ad583af22c2e7d40c1c916b2920299155a46464" );
+  BOOST_REQUIRE( store.add( mkPackage( root / "repo/stored.rpm", 4, 2 * Date::day ), sum ) );
+  filesystem::assert_dir( root / "other" );
+  BOOST_REQUIRE( store.provide( sum, root / "other/stored.rpm" ) );
+
+  PackageCache cache( root );
+  // still linked from the other repo
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 4, PackageCache::LRU, store ), 1 );
+  BOOST_CHECK( PathInfo( store.path( sum ) ).isFile() );
+  // unlinked store entry is removed as well
+  BOOST_CHECK_EQUAL( cache.enforceLimit( 1, PackageCache::LRU, store ), 1 );
+  BOOST_CHECK( ! PathInfo( store.path( sum ) ).isExist() );
+}
@@ -232,5 +232,14 @@ BOOST_AUTO_TEST_CASE(uncached)
   BOOST_CHECK_EQUAL( replacer1("${releasever}"),	"13.2" );
   ::setenv( "ZYPP_REPO_RELEASEVER", "13.3", 1 );
   BOOST_CHECK_EQUAL( replacer1("${releasever}"),	"13.3" );
+
+  repo::RepoVariablesUrlReplacer replacer2;
+  ::setenv( "ZYPP_REPO_RELEASEVER", "13.2", 1 );
+  BOOST_CHECK_EQUAL( replacer2(Url("http://site.org/$releasever/?arch=$arch")).asCompleteString(), "http://site.org/13.2/?arch=i686" );
+  BOOST_CHECK_EQUAL( replacer2(Url("http://site.org/$releasever/?arch=$arch")).asCompleteString(), "http://site.org/13.2/?arch=i686" );
+  ::setenv( "ZYPP_REPO_RELEASEVER", "13.3", 1 );
+  BOOST_CHECK_EQUAL( replacer2(Url("http://site.org/$releasever/?arch=$arch")).asCompleteString(), "http://site.org/13.3/?arch=i686" );
+  BOOST_CHECK_EQUAL( replacer2(Url("http://site.org/$arch/")).asCompleteString(), "http://site.org/i686/" );
+  BOOST_CHECK_EQUAL( replacer2(Url("http://site.org/noarch/")).asCompleteString(), "http://site.org/noarch/" );
 }
 // vim: set ts=2 sts=2 sw=2 ai et:
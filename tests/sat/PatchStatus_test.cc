@@ -0,0 +1,54 @@
+#include "TestSetup.h"
+#include <zypp/sat/PatchStatus.h>
+
+#define BOOST_TEST_MODULE PatchStatus
+
+static sat::Solvable patch( const std::string & name_r )
+{
+  for_( it, sat::Pool::instance().solvablesBegin(), sat::Pool::instance().solvablesEnd() )
+  {
+    if ( it->isKind( ResKind::patch ) && it->name() == name_r )
+      return *it;
+  }
+  return sat::Solvable::noSolvable;
+}
+
+BOOST_AUTO_TEST_CASE(PatchStatus)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadHelix( TESTS_SRC_DIR"/data/TCPatchStatus/update.xml", "update" );
+  test.loadTargetHelix( TESTS_SRC_DIR"/data/TCPatchStatus/system-1.xml" );
+
+  sat::Solvable pA( patch( "pA" ) );
+  sat::Solvable pB( patch( "pB" ) );
+  sat::Solvable pX( patch( "pX" ) );
+  sat::Solvable pAC( patch( "pAC" ) );
+  BOOST_REQUIRE( pA && pB && pX && pAC );
+
+  sat::PatchStatus status;
+  BOOST_CHECK_EQUAL( status.status( pA ), sat::PatchStatus::BROKEN );
+  BOOST_CHECK_EQUAL( status.status( pB ), sat::PatchStatus::BROKEN );
+  BOOST_CHECK_EQUAL( status.status( pX ), sat::PatchStatus::NONRELEVANT );
+  BOOST_CHECK_EQUAL( status.status( pAC ), sat::PatchStatus::BROKEN );
+  BOOST_CHECK_EQUAL( status.needed().size(), 3 );
+  BOOST_CHECK_EQUAL( status.size(), 4 );
+  BOOST_CHECK_EQUAL( status.evaluations(), 4 );
+  BOOST_CHECK_EQUAL( status.update(), 0 );	// pool unchanged
+
+  // pkgA was updated: re-evaluate just the patches referring to it
+  test.satpool().systemRepo().eraseFromPool();
+  test.loadTargetHelix( TESTS_SRC_DIR"/data/TCPatchStatus/system-2.xml" );
+  BOOST_CHECK_EQUAL( status.update(), 2 );
+  BOOST_CHECK_EQUAL( status.evaluations(), 6 );
+  BOOST_CHECK_EQUAL( status.status( pA ), sat::PatchStatus::SATISFIED );
+  BOOST_CHECK_EQUAL( status.status( pB ), sat::PatchStatus::BROKEN );
+  BOOST_CHECK_EQUAL( status.status( pX ), sat::PatchStatus::NONRELEVANT );
+  BOOST_CHECK_EQUAL( status.status( pAC ), sat::PatchStatus::BROKEN );
+  BOOST_CHECK_EQUAL( status.needed().size(), 2 );
+
+  // The ResStatus of the patches reflects it
+  status.apply();
+  BOOST_CHECK( PoolItem( pA ).isSatisfied() );
+  BOOST_CHECK( PoolItem( pB ).isNeeded() );
+  BOOST_CHECK( ! PoolItem( pX ).isRelevant() );
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// Boost.Test
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/CheckSumCache.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  void writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    ofstream str( file_r.c_str() );
+    str << content_r;
+  }
+
+  // deliberately not the real checksum, so we see the cache was used
+  const CheckSum fakeSha1( "sha1", "0123456789012345678901234567890123456789" );
+}
+
+BOOST_AUTO_TEST_CASE(remember_lookup)
+{
+  CheckSumCache::clear();
+  filesystem::TmpDir root;
+  Pathname file( root.path()/"file" );
+
+  CheckSumCache::remember( file, fakeSha1 );	// not existing
+  BOOST_CHECK( CheckSumCache::lookup( file, "sha1" ).empty() );
+
+  writeFile( file, "content" );
+  std::string real( filesystem::checksum( file, "sha1" ) );
+  BOOST_CHECK_EQUAL( real, "040f06fd774092478d450774f5ba30c5da78acc8" );
+
+  CheckSumCache::remember( file, fakeSha1 );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( file, "sha1" ), fakeSha1 );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( file, "SHA1" ), fakeSha1 );
+  BOOST_CHECK( CheckSumCache::lookup( file, "sha256" ).empty() );
+  BOOST_CHECK_EQUAL( filesystem::checksum( file, "sha1" ), fakeSha1.checksum() );
+  BOOST_CHECK( filesystem::is_checksum( file, fakeSha1 ) );
+
+  // survives rename and hardlinks
+  Pathname renamed( root.path()/"renamed" );
+  filesystem::rename( file, renamed );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( renamed, "sha1" ), fakeSha1 );
+  filesystem::hardlink( renamed, file );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( file, "sha1" ), fakeSha1 );
+
+  // copies take over the checksum
+  Pathname copy( root.path()/"copy" );
+  filesystem::copy( renamed, copy );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( copy, "sha1" ), fakeSha1 );
+
+  // modification invalidates
+  writeFile( file, "modified content" );
+  BOOST_CHECK( CheckSumCache::lookup( file, "sha1" ).empty() );
+  BOOST_CHECK( CheckSumCache::lookup( renamed, "sha1" ).empty() );
+  BOOST_CHECK_EQUAL( CheckSumCache::lookup( copy, "sha1" ), fakeSha1 );
+
+  CheckSumCache::clear();
+  BOOST_CHECK( CheckSumCache::lookup( copy, "sha1" ).empty() );
+  BOOST_CHECK_EQUAL( filesystem::checksum( copy, "sha1" ), real );
+}
+
+BOOST_AUTO_TEST_CASE(wanted_type)
+{
+  BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "" );
+  {
+    CheckSumCache::ScopedWantedType outer( "SHA256" );
+    BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "sha256" );
+    {
+      CheckSumCache::ScopedWantedType inner( "" );
+      BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "" );
+    }
+    {
+      CheckSumCache::ScopedWantedType inner( "sha" );	// ambiguous
+      BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "" );
+    }
+    BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "sha256" );
+  }
+  BOOST_CHECK_EQUAL( CheckSumCache::wantedType(), "" );
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// Boost.Test
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/ContentStore.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+
+namespace
+{
+  void writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    ofstream str( file_r.c_str() );
+    str << content_r;
+  }
+
+  // sha1 of "hello\n"
+  const CheckSum helloSha1( "sha1", "f572d396fae9206628714fb2ce00f72e94f2258f" );
+}
+
+BOOST_AUTO_TEST_CASE(disabled)
+{
+  ContentStore store( (Pathname()) );
+  BOOST_CHECK( ! store.enabled() );
+  BOOST_CHECK( store.path( helloSha1 ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE(add_provide_clean)
+{
+  filesystem::TmpDir tmp;
+  ContentStore store( tmp.path() / "store" );
+  BOOST_CHECK_EQUAL( store.path( helloSha1 ), tmp.path() / "store/sha1/f5/f572d396fae9206628714fb2ce00f72e94f2258f" );
+
+  Pathname repo1( tmp.path() / "repo1" );
+  Pathname repo2( tmp.path() / "repo2" );
+  filesystem::assert_dir( repo1 );
+  filesystem::assert_dir( repo2 );
+
+  // nothing to provide yet
+  BOOST_CHECK( ! store.provide( helloSha1, repo2 / "hello" ) );
+
+  // a file not matching the checksum is not added
+  writeFile( repo1 / "bad", "bye\n" );
+  BOOST_CHECK( ! store.add( repo1 / "bad", helloSha1 ) );
+  BOOST_CHECK( ! PathInfo( store.path( helloSha1 ) ).isExist() );
+
+  writeFile( repo1 / "hello", "hello\n" );
+  BOOST_CHECK( store.add( repo1 / "hello", helloSha1 ) );
+  BOOST_CHECK_EQUAL( PathInfo( store.path( helloSha1 ) ).nlink(), 2 );
+
+  BOOST_CHECK( store.provide( helloSha1, repo2 / "hello" ) );
+  BOOST_CHECK_EQUAL( PathInfo( repo2 / "hello" ).ino(), PathInfo( repo1 / "hello" ).ino() );
+
+  // still in use
+  BOOST_CHECK_EQUAL( store.clean(), 0 );
+  filesystem::unlink( repo1 / "hello" );
+  filesystem::unlink( repo2 / "hello" );
+  BOOST_CHECK_EQUAL( store.clean(), 1 );
+  BOOST_CHECK( ! PathInfo( store.path( helloSha1 ) ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(broken_entry)
+{
+  filesystem::TmpDir tmp;
+  ContentStore store( tmp.path() / "store" );
+  Pathname entry( store.path( helloSha1 ) );
+  filesystem::assert_dir( entry.dirname() );
+  writeFile( entry, "corrupt\n" );
+
+  BOOST_CHECK( ! store.provide( helloSha1, tmp.path() / "hello" ) );
+  BOOST_CHECK( ! PathInfo( entry ).isExist() );
+  BOOST_CHECK( ! PathInfo( tmp.path() / "hello" ).isExist() );
+}
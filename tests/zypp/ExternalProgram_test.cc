@@ -0,0 +1,95 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/TmpPath.h"
+
+using boost::unit_test::test_case;
+
+using namespace std;
+using namespace zypp;
+
+static std::string output( ExternalProgram & prog_r, int & exit_r )
+{
+  std::ostringstream str;
+  prog_r >> str;
+  exit_r = prog_r.close();
+  return str.str();
+}
+
+static std::string output( const ExternalProgram::Arguments & argv_r,
+                           const ExternalProgram::Environment & env_r = ExternalProgram::Environment(),
+                           ExternalProgram::Stderr_Disposition stderr_r = ExternalProgram::Normal_Stderr,
+                           bool default_locale_r = false )
+{
+  ExternalProgram prog( argv_r, env_r, stderr_r, false, -1, default_locale_r );
+  int exit;
+  std::string ret( output( prog, exit ) );
+  BOOST_CHECK_EQUAL( exit, 0 );
+  return ret;
+}
+
+BOOST_AUTO_TEST_CASE(output_and_exit)
+{
+  BOOST_CHECK_EQUAL( output( { "echo", "hello" } ), "hello\n" );
+  BOOST_CHECK_EQUAL( output( { "/bin/sh", "-c", "echo out; echo err >&2" }, {}, ExternalProgram::Stderr_To_Stdout ), "out\nerr\n" );
+  BOOST_CHECK_EQUAL( output( { "/bin/sh", "-c", "echo out; echo err >&2" }, {}, ExternalProgram::Discard_Stderr ), "out\n" );
+
+  {
+    ExternalProgram prog( ExternalProgram::Arguments( { "/bin/sh", "-c", "exit 3" } ) );
+    int exit;
+    output( prog, exit );
+    BOOST_CHECK_EQUAL( exit, 3 );
+  }
+  {
+    ExternalProgram prog( ExternalProgram::Arguments( { "/no/such/program" } ) );
+    int exit;
+    BOOST_CHECK_EQUAL( output( prog, exit ), "" );
+    BOOST_CHECK_EQUAL( exit, 129 );
+    BOOST_CHECK( ! prog.execError().empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(environment)
+{
+  ::setenv( "ZYPP_TEST_KEEP", "keep", 1 );
+  ::setenv( "ZYPP_TEST_SET", "old", 1 );
+  ExternalProgram::Environment env;
+  env["ZYPP_TEST_SET"] = "new";
+  BOOST_CHECK_EQUAL( output( { "/bin/sh", "-c", "echo $ZYPP_TEST_KEEP $ZYPP_TEST_SET $LC_ALL" }, env, ExternalProgram::Normal_Stderr, true ),
+                     "keep new C\n" );
+}
+
+BOOST_AUTO_TEST_CASE(redirect_and_chdir)
+{
+  filesystem::TmpDir tmp;
+  BOOST_CHECK_EQUAL( output( { "#" + tmp.path().asString(), "pwd" } ), tmp.path().asString() + "\n" );
+  {
+    // as if the forked child failed to chdir
+    ExternalProgram prog( ExternalProgram::Arguments( { "#/nonexistent", "pwd" } ) );
+    int exit;
+    BOOST_CHECK_EQUAL( output( prog, exit ), "" );
+    BOOST_CHECK_EQUAL( exit, 128 );
+  }
+
+  Pathname file( tmp.path() / "file" );
+  output( { ">" + file.asString(), "echo", "redirected" } );
+  BOOST_CHECK_EQUAL( output( { "<" + file.asString(), "cat" } ), "redirected\n" );
+}
+
+BOOST_AUTO_TEST_CASE(close_fds)
+{
+  // a descriptor without FD_CLOEXEC must not leak into the child
+  int fd = ::open( "/dev/null", O_RDONLY );
+  BOOST_REQUIRE( fd > 2 );
+  std::string test( "test -e /proc/self/fd/" + str::numstring( fd ) + " && echo leaked || echo closed" );
+  BOOST_CHECK_EQUAL( output( { "/bin/sh", "-c", test } ), "closed\n" );
+  ::close( fd );
+}
@@ -1,7 +1,9 @@
+#include <fstream>
 #include "TestSetup.h"
 
 #include "zypp/MediaSetAccess.h"
 #include "zypp/Fetcher.h"
+#include "zypp/Digest.h"
 
 #include "WebServer.h"
 
@@ -369,6 +371,60 @@ BOOST_AUTO_TEST_CASE(enqueuedir_http)
   web.stop();
 }
 
+BOOST_AUTO_TEST_CASE(enqueue_metalink_seeded_from_cache)
+{
+  filesystem::TmpDir tmp;
+  Pathname docroot( tmp.path() / "remote-site" );
+  Pathname cache( tmp.path() / "packages" );
+  filesystem::assert_dir( docroot / "x86_64" );
+  filesystem::assert_dir( cache / "repo/x86_64" );
+
+  std::string content;
+  for ( unsigned i = 0; i < 16; ++i )
+    content += std::string( 4096, 'a' + i );
+  {
+    // an older version of the package in the cache
+    std::ofstream seed( ( cache / "repo/x86_64/foo-1.0-1.x86_64.rpm" ).c_str() );
+    seed << content;
+  }
+  {
+    // the server answers with a metalink whose only mirror does not exist,
+    // so the download must be assembled from the cached blocks
+    std::ofstream meta( ( docroot / "x86_64/foo-2.0-1.x86_64.rpm" ).c_str() );
+    meta << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl
+         << "<metalink xmlns=\"urn:ietf:params:xml:ns:metalink\">" << endl
+         << "  <file name=\"foo-2.0-1.x86_64.rpm\">" << endl
+         << "    <size>" << content.size() << "</size>" << endl
+         << "    <hash type=\"sha-256\">" << Digest::digest( Digest::sha256(), content ) << "</hash>" << endl
+         << "    <pieces length=\"4096\" type=\"sha-1\">" << endl;
+    for ( unsigned i = 0; i < 16; ++i )
+      meta << "      <hash>" << Digest::digest( Digest::sha1(), content.substr( i * 4096, 4096 ) ) << "</hash>" << endl;
+    meta << "    </pieces>" << endl
+         << "    <url>http://localhost:10003/nosuchmirror/foo-2.0-1.x86_64.rpm</url>" << endl
+         << "  </file>" << endl
+         << "</metalink>" << endl;
+  }
+
+  WebServer web( docroot, 10003 );
+  web.start();
+  {
+    MediaSetAccess media( web.url(), "/" );
+    Fetcher fetcher;
+    filesystem::TmpDir dest;
+    fetcher.addCachePath( cache / "repo" );
+    fetcher.enqueue( OnMediaLocation( "/x86_64/foo-2.0-1.x86_64.rpm" ) );
+    fetcher.start( dest.path(), media );
+
+    std::ifstream in( ( dest.path() / "x86_64/foo-2.0-1.x86_64.rpm" ).c_str() );
+    std::ostringstream got;
+    got << in.rdbuf();
+    BOOST_CHECK( got.str() == content );
+    // the cache paths are only passed on for the Fetcher's downloads
+    BOOST_CHECK( media.cachePaths().empty() );
+  }
+  web.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
 // vim: set ts=2 sts=2 sw=2 ai et:
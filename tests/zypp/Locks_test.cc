@@ -8,6 +8,7 @@
 #include "zypp/PoolQueryUtil.tcc"
 #include "zypp/TmpPath.h"
 #include "zypp/Locks.h"
+#include "zypp/pool/LockSet.h"
 #include "TestSetup.h"
 
 #define BOOST_TEST_MODULE Locks
@@ -26,6 +27,18 @@ bool isLocked( const sat::Solvable & solvable )
   return false;
 }
 
+bool sameResult( const PoolQueryResult & lhs, const PoolQueryResult & rhs )
+{
+  if ( lhs.size() != rhs.size() )
+    return false;
+  for_( it, lhs.begin(), lhs.end() )
+  {
+    if ( ! rhs.contains( *it ) )
+      return false;
+  }
+  return true;
+}
+
 BOOST_AUTO_TEST_CASE(pool_query_init)
 {
   TestSetup test( Arch_x86_64 );
@@ -113,3 +126,78 @@ BOOST_AUTO_TEST_CASE( locks_empty )
   locks.removeEmpty();
   BOOST_CHECK( locks.size() == 0 );
 }
+
+BOOST_AUTO_TEST_CASE( locks_lockset )
+{
+  cout << "****lock set matches the queries****"  << endl;
+  std::vector<PoolQuery> queries;
+  {
+    PoolQuery q;	// exact name
+    q.addAttribute( sat::SolvAttr::name, "zypper" );
+    q.setMatchExact();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// glob without wildcard, case insensitive
+    q.addAttribute( sat::SolvAttr::name, "ZYPPER" );
+    q.setMatchGlob();
+    q.setCaseSensitive( false );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// glob, restricted to installed packages
+    q.addAttribute( sat::SolvAttr::name, "lib*" );
+    q.setMatchGlob();
+    q.addKind( ResKind::package );
+    q.setInstalledOnly();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// glob with edition
+    q.addAttribute( sat::SolvAttr::name, "z*" );
+    q.setMatchGlob();
+    q.setEdition( Edition( "1.0" ), Rel::GE );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// regex and repo
+    q.addAttribute( sat::SolvAttr::name, "^[kK].*-devel$" );
+    q.setMatchRegex();
+    q.addRepo( "opensuse" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// substring
+    q.addAttribute( sat::SolvAttr::name, "office" );
+    q.setMatchSubstring();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// not a name lock
+    q.addString( "zypper" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// broken regex
+    q.addAttribute( sat::SolvAttr::name, "[" );
+    q.setMatchRegex();
+    queries.push_back( q );
+  }
+
+  pool::LockSet lockset( queries.begin(), queries.end() );
+  BOOST_CHECK_EQUAL( lockset.size(), queries.size() );
+  std::vector<PoolQueryResult> results( lockset.results() );
+  BOOST_REQUIRE_EQUAL( results.size(), queries.size() );
+
+  PoolQueryResult all;
+  for ( unsigned i = 0; i < queries.size(); ++i )
+  {
+    PoolQueryResult expected( queries[i] );
+    BOOST_CHECK_EQUAL( results[i].size(), expected.size() );
+    BOOST_CHECK( sameResult( results[i], expected ) );
+    all += expected;
+  }
+  BOOST_CHECK( ! results[0].empty() );
+  BOOST_CHECK( sameResult( results[0], results[1] ) );
+  BOOST_CHECK( sameResult( lockset.result(), all ) );
+}
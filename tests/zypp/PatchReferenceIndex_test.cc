@@ -0,0 +1,42 @@
+#include "TestSetup.h"
+#include "zypp/Patch.h"
+#include "zypp/PatchReferenceIndex.h"
+
+#define BOOST_TEST_MODULE PatchReferenceIndex
+
+BOOST_AUTO_TEST_CASE(pool_init)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( TESTS_SRC_DIR "/data/11.0-update" );
+}
+
+BOOST_AUTO_TEST_CASE(find_references)
+{
+  const PatchReferenceIndex & index( PatchReferenceIndex::instance() );
+  BOOST_CHECK( index.size() > 0 );
+
+  unsigned refs = 0;
+  for_( it, sat::Pool::instance().solvablesBegin(), sat::Pool::instance().solvablesEnd() )
+  {
+    if ( ! it->isKind( ResKind::patch ) )
+      continue;
+    Patch::constPtr patch( make<Patch>( *it ) );
+    for_( ref, patch->referencesBegin(), patch->referencesEnd() )
+    {
+      BOOST_CHECK( index.find( ref.id() ).contains( *it ) );
+      BOOST_CHECK( index.find( ref.id(), ref.type() ).contains( *it ) );
+      BOOST_CHECK( index.find( str::toUpper( ref.id() ), str::toUpper( ref.type() ) ).contains( *it ) );
+      BOOST_CHECK( index.findPrefix( ref.id().substr( 0, 3 ) ).contains( *it ) );
+      ++refs;
+    }
+  }
+  BOOST_CHECK( refs > 0 );
+
+  // e.g. <reference id="391770" type="bugzilla"/>
+  BOOST_CHECK( index.contains( "391770" ) );
+  BOOST_CHECK( index.contains( "391770", "bugzilla" ) );
+  BOOST_CHECK( ! index.contains( "391770", "cve" ) );
+  BOOST_CHECK( ! index.contains( "39177" ) );
+  BOOST_CHECK( ! index.findPrefix( "39177" ).empty() );
+  BOOST_CHECK( index.findPrefix( "no-such-issue" ).empty() );
+}
@@ -210,3 +210,111 @@ BOOST_AUTO_TEST_CASE(test_exchange)
   BOOST_CHECK( PathInfo(a).isFile() );
   BOOST_CHECK( PathInfo(b).isDir() );
 }
+
+namespace
+{
+  void writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    ofstream str( file_r.c_str() );
+    str << content_r;
+  }
+
+  std::string readFile( const Pathname & file_r )
+  {
+    ifstream str( file_r.c_str() );
+    return std::string( std::istreambuf_iterator<char>( str ), std::istreambuf_iterator<char>() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_copy)
+{
+  TmpDir root;
+  Pathname src( root/"src" );
+  writeFile( src, std::string( 100000, 'x' ) + "end" );
+  ::chmod( src.c_str(), 0640 );
+
+  BOOST_CHECK_EQUAL( filesystem::copy( root/"nonexisting", root/"dest" ), EINVAL );
+  BOOST_CHECK_EQUAL( filesystem::copy( src, root ), EISDIR );
+
+  Pathname dest( root/"dest" );
+  BOOST_CHECK_EQUAL( filesystem::copy( src, dest ), 0 );
+  BOOST_CHECK_EQUAL( readFile( dest ), readFile( src ) );
+  BOOST_CHECK_EQUAL( PathInfo( dest ).perm() & 0700, 0600 );
+
+  // --remove-destination: a hardlink to dest stays untouched
+  BOOST_CHECK_EQUAL( filesystem::hardlink( dest, root/"link" ), 0 );
+  writeFile( src, "new" );
+  BOOST_CHECK_EQUAL( filesystem::copy( src, dest ), 0 );
+  BOOST_CHECK_EQUAL( readFile( dest ), "new" );
+  BOOST_CHECK_EQUAL( readFile( root/"link" ).size(), 100003 );
+
+  // copy_file2dir
+  Pathname dir( root/"dir" );
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src, root/"nodir" ), ENOTDIR );
+  filesystem::assert_dir( dir );
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src, dir ), 0 );
+  BOOST_CHECK_EQUAL( readFile( dir/"src" ), "new" );
+  writeFile( src, "" );
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src, dir ), 0 );
+  BOOST_CHECK_EQUAL( readFile( dir/"src" ), "" );
+
+  // a file is not copied onto itself (or a hardlink of it)
+  writeFile( src, "self" );
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src, src.dirname() ), EINVAL );
+  BOOST_CHECK_EQUAL( filesystem::copy( src, src ), EINVAL );
+  BOOST_CHECK_EQUAL( filesystem::hardlink( src, root/"srclink" ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::copy( src, root/"srclink" ), EINVAL );
+  BOOST_CHECK_EQUAL( readFile( src ), "self" );
+}
+
+BOOST_AUTO_TEST_CASE(test_copy_dir)
+{
+  TmpDir root;
+  Pathname src( root/"src" );
+  filesystem::assert_dir( src/"sub/deeper" );
+  writeFile( src/"file", "file" );
+  writeFile( src/"sub/deeper/file", "deeper" );
+  filesystem::hardlink( src/"file", src/"sub/hardlink" );
+  filesystem::symlink( "deeper/file", src/"sub/symlink" );
+  filesystem::symlink( "/nonexisting", src/"dangling" );
+
+  Pathname dest( root/"dest" );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dest ), ENOTDIR );
+  filesystem::assert_dir( dest );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src/"file", dest ), ENOTDIR );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dest ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dest ), EEXIST );
+
+  Pathname copy( dest/"src" );
+  BOOST_CHECK_EQUAL( readFile( copy/"file" ), "file" );
+  BOOST_CHECK_EQUAL( readFile( copy/"sub/deeper/file" ), "deeper" );
+  BOOST_CHECK( PathInfo( copy/"sub/symlink", PathInfo::LSTAT ).isLink() );
+  BOOST_CHECK_EQUAL( filesystem::readlink( copy/"sub/symlink" ), Pathname( "deeper/file" ) );
+  BOOST_CHECK( PathInfo( copy/"dangling", PathInfo::LSTAT ).isLink() );
+  BOOST_CHECK_EQUAL( PathInfo( copy/"file" ).ino(), PathInfo( copy/"sub/hardlink" ).ino() );
+  BOOST_CHECK_NE( PathInfo( copy/"file" ).ino(), PathInfo( src/"file" ).ino() );
+
+  // a directory can't be copied into itself
+  BOOST_CHECK_NE( filesystem::copy_dir( src, src/"sub" ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE(test_copy_dir_content)
+{
+  TmpDir root;
+  Pathname src( root/"src" );
+  filesystem::assert_dir( src/"sub" );
+  writeFile( src/"file", "file" );
+  writeFile( src/"sub/file", "sub" );
+
+  Pathname dest( root/"dest" );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, dest ), ENOTDIR );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, src ), EEXIST );
+  filesystem::assert_dir( dest/"sub" );
+  writeFile( dest/"file", "old" );
+  writeFile( dest/"sub/keep", "keep" );
+
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, dest ), 0 );
+  BOOST_CHECK_EQUAL( readFile( dest/"file" ), "file" );
+  BOOST_CHECK_EQUAL( readFile( dest/"sub/file" ), "sub" );
+  BOOST_CHECK_EQUAL( readFile( dest/"sub/keep" ), "keep" );
+}
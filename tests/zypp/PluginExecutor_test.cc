@@ -0,0 +1,61 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/Date.h"
+#include "zypp/PluginExecutor.h"
+
+using std::endl;
+using namespace zypp;
+using namespace boost::unit_test;
+
+/** A plugin answering each frame with \a answer_r after 1 second. */
+static void writePlugin( const Pathname & file_r, const std::string & answer_r = "ACK" )
+{
+  {
+    std::ofstream out( file_r.c_str() );
+    out << "#!/bin/bash" << endl
+        << "while read -r -d '' frame; do" << endl
+        << "  case \"$frame\" in" << endl
+        << "    _DISCONNECT*) printf 'ACK\\n\\n\\0'; exit 0;;" << endl
+        << "  esac" << endl
+        << "  sleep 1" << endl
+        << "  printf '" << answer_r << "\\n\\n\\0'" << endl
+        << "done" << endl;
+  }
+  filesystem::chmod( file_r, 0755 );
+}
+
+BOOST_AUTO_TEST_CASE(parallel)
+{
+  filesystem::TmpDir tmp;
+  writePlugin( tmp.path() / "plugin1" );
+  writePlugin( tmp.path() / "plugin2" );
+  writePlugin( tmp.path() / "plugin3" );
+
+  PluginExecutor plugins;
+  Date start( Date::now() );
+  plugins.load( tmp.path() );
+  BOOST_CHECK_EQUAL( plugins.size(), 3 );
+  plugins.send( PluginFrame( "COMMITBEGIN" ) );
+  BOOST_CHECK_EQUAL( plugins.size(), 3 );
+  // one after the other would take 6 seconds
+  BOOST_CHECK( Date::now() - start < 5 );
+}
+
+BOOST_AUTO_TEST_CASE(failing)
+{
+  filesystem::TmpDir tmp;
+  writePlugin( tmp.path() / "plugin1" );
+  writePlugin( tmp.path() / "plugin2", "ERROR" );
+  writePlugin( tmp.path() / "plugin3" );
+
+  PluginExecutor plugins;
+  plugins.load( tmp.path() );
+  BOOST_CHECK_EQUAL( plugins.size(), 2 );
+  plugins.send( PluginFrame( "COMMITBEGIN" ) );
+  BOOST_CHECK_EQUAL( plugins.size(), 2 );
+}
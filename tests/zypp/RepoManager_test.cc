@@ -105,6 +105,26 @@ BOOST_AUTO_TEST_CASE(pluginservices_test)
   }
 }
 
+BOOST_AUTO_TEST_CASE(pluginservices_concurrent_test)
+{
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) ) ;
+
+  filesystem::assert_dir( opts.knownReposPath );
+  opts.pluginsPath = DATADIR + "/plugin-service-lib-3";
+
+  RepoManager manager(opts);
+  BOOST_REQUIRE_EQUAL(3, manager.serviceSize());
+
+  // the plugins run concurrently; a failing one must not affect the others
+  manager.refreshServices();
+  BOOST_CHECK_EQUAL((unsigned) 2, manager.repoSize());
+  BOOST_CHECK( manager.hasRepo( "service1:repo" ) );
+  BOOST_CHECK( ! manager.hasRepo( "service2:repo" ) );
+  BOOST_CHECK( manager.hasRepo( "service3:repo" ) );
+  BOOST_CHECK_EQUAL( manager.getRepo( "service3:repo" ).service(), "service3" );
+}
+
 // regression test for services bug
 // if you modify a service that you just
 // added and saved, the service was not associated with its
@@ -75,6 +75,42 @@ BOOST_AUTO_TEST_CASE(candiadatenoarch)
   BOOST_CHECK_EQUAL( s->updateCandidateObj(), s->candidateObj() );
 }
 
+BOOST_AUTO_TEST_CASE(candiadate_vendorchange)
+{
+  // cached candidates must follow the solvers vendor change policy
+  ResPoolProxy poolProxy( test.poolProxy() );
+  ui::Selectable::Ptr s( poolProxy.lookup( ResKind::package, "candidate" ) );
+  bool allowVendorChange = test.resolver().allowVendorChange();
+
+  test.resolver().setAllowVendorChange( true );
+  BOOST_CHECK_EQUAL( s->candidateObj()->repoInfo().alias(), "RepoHIGH" );
+  BOOST_CHECK_EQUAL( s->updateCandidateObj(), s->candidateObj() );
+
+  test.resolver().setAllowVendorChange( false );
+  BOOST_CHECK_EQUAL( s->candidateObj()->repoInfo().alias(), "RepoMID" );
+  BOOST_CHECK_EQUAL( s->updateCandidateObj(), PoolItem() );
+
+  test.resolver().setAllowVendorChange( allowVendorChange );
+}
+
+BOOST_AUTO_TEST_CASE(updatecandidates)
+{
+  ResPoolProxy poolProxy( test.poolProxy() );
+  std::vector<ui::Selectable::Ptr> updates( poolProxy.updateCandidates<Package>() );
+
+  unsigned expected = 0;
+  for ( const ui::Selectable::Ptr & s : poolProxy.byKind<Package>() )
+  {
+    if ( s->hasInstalledObj() && s->updateCandidateObj() )
+    {
+      ++expected;
+      BOOST_CHECK( std::find( updates.begin(), updates.end(), s ) != updates.end() );
+    }
+  }
+  BOOST_CHECK_EQUAL( updates.size(), expected );
+  BOOST_CHECK( std::find( updates.begin(), updates.end(), poolProxy.lookup( ResKind::package, "candidatenoarch" ) ) != updates.end() );
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Measure.h"
+#include "zypp/base/String.h"
+
+using std::cout;
+using std::endl;
+
+using namespace zypp;
+using namespace zypp::debug;
+
+BOOST_AUTO_TEST_CASE(measure_counter)
+{
+  // must be set before the first counter is created
+  ::setenv( "ZYPP_PROFILING", "1", 1 );
+  BOOST_REQUIRE( MeasureCounter::enabled() );
+
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    MeasureCounter counter( "test::loop" );
+  }
+  {
+    MeasureCounter counter( "test::stopped" );
+    counter.stop();
+    counter.stop();	// no double counting
+  }
+
+  std::ostringstream str;
+  MeasureCounter::dumpJSONOn( str );
+  cout << str.str() << endl;
+  std::string json( str.str() );
+
+  BOOST_CHECK( json.find( "\"test::loop\": {" ) != std::string::npos );
+  BOOST_CHECK( json.find( "\"count\": 3" ) != std::string::npos );
+  BOOST_CHECK( json.find( "\"test::stopped\": {" ) != std::string::npos );
+  BOOST_CHECK( json.find( "\"count\": 1" ) != std::string::npos );
+  BOOST_CHECK( json.find( "\"histogram_us\": [" ) != std::string::npos );
+
+  MeasureCounter::reset();
+  str.str( "" );
+  MeasureCounter::dumpJSONOn( str );
+  BOOST_CHECK_EQUAL( str.str(), "{}" );
+}
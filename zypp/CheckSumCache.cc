@@ -0,0 +1,169 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/CheckSumCache.cc
+ *
+*/
+#include <sys/stat.h>
+#include <iostream>
+#include <map>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+
+#include "zypp/CheckSumCache.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Limit the number of remembered files. */
+    const unsigned maxEntries = 512;
+
+    /** Identify a files content: inode plus size and mtime. */
+    struct FileId
+    {
+      FileId()
+      : dev( 0 ), ino( 0 ), size( 0 ), mtime( 0 ), mtimeNsec( 0 )
+      {}
+
+      explicit FileId( const Pathname & file_r )
+      : FileId()
+      {
+	struct stat st;
+	if ( ::stat( file_r.c_str(), &st ) == 0 && S_ISREG( st.st_mode ) )
+	{
+	  dev = st.st_dev;
+	  ino = st.st_ino;
+	  size = st.st_size;
+	  mtime = st.st_mtim.tv_sec;
+	  mtimeNsec = st.st_mtim.tv_nsec;
+	}
+      }
+
+      explicit operator bool() const
+      { return ino; }
+
+      std::pair<dev_t,ino_t> key() const
+      { return std::make_pair( dev, ino ); }
+
+      bool sameContent( const FileId & rhs ) const
+      { return size == rhs.size && mtime == rhs.mtime && mtimeNsec == rhs.mtimeNsec; }
+
+      dev_t dev;
+      ino_t ino;
+      off_t size;
+      time_t mtime;
+      long mtimeNsec;
+    };
+
+    struct Entry
+    {
+      FileId id;
+      std::map<std::string,CheckSum> sums;	// by type
+    };
+
+    typedef std::map<std::pair<dev_t,ino_t>,Entry> Cache;
+
+    Cache & cache()
+    {
+      static Cache _cache;
+      return _cache;
+    }
+
+    std::string & wanted()
+    {
+      static std::string _wanted;
+      return _wanted;
+    }
+
+    /** The valid entry for \a id_r (creating it if \a create_r), or \c nullptr. */
+    Entry * entryFor( const FileId & id_r, bool create_r )
+    {
+      if ( ! id_r )
+	return nullptr;
+
+      Cache & c( cache() );
+      auto it = c.find( id_r.key() );
+      if ( it != c.end() && ! it->second.id.sameContent( id_r ) )
+      {
+	c.erase( it );	// modified or inode reused
+	it = c.end();
+      }
+      if ( it == c.end() )
+      {
+	if ( ! create_r )
+	  return nullptr;
+	if ( c.size() >= maxEntries )
+	  c.erase( c.begin() );
+	it = c.insert( std::make_pair( id_r.key(), Entry() ) ).first;
+	it->second.id = id_r;
+      }
+      return &it->second;
+    }
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  void CheckSumCache::remember( const Pathname & file_r, const CheckSum & checksum_r )
+  {
+    if ( checksum_r.empty() )
+      return;
+    Entry * entry = entryFor( FileId( file_r ), true );
+    if ( entry )
+    {
+      DBG << "Remember " << checksum_r << " for " << file_r << endl;
+      entry->sums[str::toLower( checksum_r.type() )] = checksum_r;
+    }
+  }
+
+  CheckSum CheckSumCache::lookup( const Pathname & file_r, const std::string & type_r )
+  {
+    Entry * entry = entryFor( FileId( file_r ), false );
+    if ( entry )
+    {
+      auto it = entry->sums.find( str::toLower( type_r ) );
+      if ( it != entry->sums.end() )
+	return it->second;
+    }
+    return CheckSum();
+  }
+
+  void CheckSumCache::copied( const Pathname & src_r, const Pathname & dest_r )
+  {
+    Entry * src = entryFor( FileId( src_r ), false );
+    if ( ! src )
+      return;
+    std::map<std::string,CheckSum> sums( src->sums );	// entryFor may invalidate src
+    Entry * dest = entryFor( FileId( dest_r ), true );
+    if ( dest )
+      dest->sums = sums;
+  }
+
+  void CheckSumCache::clear()
+  { cache().clear(); }
+
+  const std::string & CheckSumCache::wantedType()
+  { return wanted(); }
+
+  CheckSumCache::ScopedWantedType::ScopedWantedType( const std::string & type_r )
+  : _prev( wanted() )
+  {
+    wanted() = str::toLower( type_r );
+    if ( wanted() == CheckSum::shaType() )
+      wanted().clear();	// ambiguous: the real type is guessed from the checksums length
+  }
+
+  CheckSumCache::ScopedWantedType::~ScopedWantedType()
+  { wanted() = _prev; }
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/CheckSumCache.h
+ *
+*/
+#ifndef ZYPP_CHECKSUMCACHE_H
+#define ZYPP_CHECKSUMCACHE_H
+
+#include <string>
+
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class CheckSumCache
+  /// \brief Remember checksums computed while a file was written.
+  ///
+  /// The media backends feed the downloaded data into a \ref Digest
+  /// while writing it to disk and \ref remember the result. \ref filesystem::checksum
+  /// and thus the \ref ChecksumFileChecker look here before reading the
+  /// whole file again.
+  ///
+  /// Entries are keyed by device and inode and validated against the
+  /// files size and mtime, so they survive renames and hardlinks, but are
+  /// dropped as soon as the file is modified. At most a few hundred files
+  /// are remembered.
+  ///
+  /// The checksum type to compute during a download is announced by
+  /// \ref MediaSetAccess using a \ref ScopedWantedType, as it knows the
+  /// \ref OnMediaLocation it is providing.
+  ///////////////////////////////////////////////////////////////////
+  class CheckSumCache
+  {
+  public:
+    /** Remember \a checksum_r as checksum of the current content of \a file_r. */
+    static void remember( const Pathname & file_r, const CheckSum & checksum_r );
+
+    /** The remembered checksum of type \a type_r for \a file_r or an empty \ref CheckSum. */
+    static CheckSum lookup( const Pathname & file_r, const std::string & type_r );
+
+    /** Remember that \a dest_r was just copied from \a src_r (takes over \a src_r's checksums). */
+    static void copied( const Pathname & src_r, const Pathname & dest_r );
+
+    /** Forget everything. */
+    static void clear();
+
+  public:
+    /** The checksum type downloads in the current scope should compute (or empty). */
+    static const std::string & wantedType();
+
+    /** Announce the checksum type downloads in the current scope should compute. */
+    struct ScopedWantedType
+    {
+      ScopedWantedType( const std::string & type_r );
+      ~ScopedWantedType();
+    private:
+      std::string _prev;
+    };
+  };
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_CHECKSUMCACHE_H
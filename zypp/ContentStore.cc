@@ -0,0 +1,149 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/ContentStore.cc
+ *
+*/
+#include <unistd.h>
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Date.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/ContentStore.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Leftover temp files older than this are removed by \ref ContentStore::clean. */
+    const Date::ValueType maxTmpAge = Date::day;
+
+    /** Temp files are hidden, so they are never taken for an entry. */
+    inline bool isTmpName( const std::string & name_r )
+    { return ! name_r.empty() && name_r[0] == '.'; }
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  ContentStore::ContentStore( const Pathname & root_r )
+  : _root( root_r )
+  {}
+
+  ContentStore & ContentStore::instance()
+  {
+    static ContentStore _instance( ZConfig::instance().download_use_content_store()
+                                   ? ZConfig::instance().contentStorePath() : Pathname() );
+    return _instance;
+  }
+
+  Pathname ContentStore::path( const CheckSum & checksum_r ) const
+  {
+    if ( ! enabled() || checksum_r.empty() )
+      return Pathname();
+    const std::string & sum( str::toLower( checksum_r.checksum() ) );
+    if ( sum.size() < 3 || sum.find( '/' ) != std::string::npos )
+      return Pathname();
+    return _root / str::toLower( checksum_r.type() ) / sum.substr( 0, 2 ) / sum;
+  }
+
+  bool ContentStore::provide( const CheckSum & checksum_r, const Pathname & dest_r ) const
+  {
+    Pathname file( path( checksum_r ) );
+    if ( file.empty() || ! PathInfo( file ).isFile() )
+      return false;
+
+    if ( ! filesystem::is_checksum( file, checksum_r ) )
+    {
+      WAR << "Remove broken entry " << file << endl;
+      filesystem::unlink( file );
+      return false;
+    }
+    if ( filesystem::hardlinkCopy( file, dest_r ) != 0 )
+      return false;
+
+    MIL << "Provided " << dest_r << " from " << file << endl;
+    return true;
+  }
+
+  bool ContentStore::add( const Pathname & file_r, const CheckSum & checksum_r ) const
+  {
+    Pathname file( path( checksum_r ) );
+    if ( file.empty() )
+      return false;
+    if ( PathInfo( file ).isFile() )
+      return true;	// e.g. added by a concurrent process
+
+    if ( ! PathInfo( file_r ).isFile() || ! filesystem::is_checksum( file_r, checksum_r ) )
+      return false;
+    if ( filesystem::assert_dir( file.dirname() ) != 0 )
+      return false;	// e.g. not root
+
+    // other processes must never see an incomplete entry
+    Pathname tmp( file.dirname() / str::form( ".%s.new.%d", file.basename().c_str(), ::getpid() ) );
+    if ( filesystem::hardlinkCopy( file_r, tmp ) != 0 || filesystem::rename( tmp, file ) != 0 )
+    {
+      filesystem::unlink( tmp );
+      return false;
+    }
+
+    DBG << "Added " << file_r << " as " << file << endl;
+    return true;
+  }
+
+  unsigned ContentStore::clean() const
+  {
+    if ( ! enabled() )
+      return 0;
+
+    unsigned ret = 0;
+    Date::ValueType expired = Date::now() - maxTmpAge;
+    std::list<std::string> types;
+    filesystem::readdir( types, _root, false );
+    for_( type, types.begin(), types.end() )
+    {
+      std::list<std::string> subdirs;
+      filesystem::readdir( subdirs, _root / *type, false );
+      for_( subdir, subdirs.begin(), subdirs.end() )
+      {
+        Pathname dir( _root / *type / *subdir );
+        std::list<std::string> entries;
+        filesystem::readdir( entries, dir, false );
+        for_( entry, entries.begin(), entries.end() )
+        {
+          PathInfo pi( dir / *entry, PathInfo::LSTAT );
+          if ( ! pi.isFile() )
+            continue;
+          if ( isTmpName( *entry ) ? pi.mtime() < expired : pi.nlink() == 1 )
+          {
+            if ( filesystem::unlink( pi.path() ) == 0 )
+              ++ret;
+          }
+        }
+        ::rmdir( dir.c_str() );	// if empty now
+      }
+    }
+    MIL << "Removed " << ret << " unused entries from " << *this << endl;
+    return ret;
+  }
+
+  std::ostream & operator<<( std::ostream & str, const ContentStore & obj )
+  {
+    if ( ! obj.enabled() )
+      return str << "ContentStore(disabled)";
+    return str << "ContentStore(" << obj.root() << ")";
+  }
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/ContentStore.h
+ *
+*/
+#ifndef ZYPP_CONTENTSTORE_H
+#define ZYPP_CONTENTSTORE_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class ContentStore
+  /// \brief Content addressed store of downloaded files.
+  ///
+  /// Files are kept below the store's root by their checksum
+  /// (<tt>root/sha256/ab/abcdef...</tt>). The per repo caches just
+  /// hardlink them (or reflink/copy them, if on a different filesystem),
+  /// so a package or metadata file mirrored by several repos, or needed by
+  /// several roots on the same host, is downloaded and stored once.
+  ///
+  /// All operations are best effort and safe to be used by concurrent
+  /// processes: Entries are created by an atomic rename, and a file which
+  /// does not match its checksum is never provided.
+  ///
+  /// \ref instance is the store at \ref ZConfig::contentStorePath,
+  /// unless disabled by \ref ZConfig::download_use_content_store.
+  ///////////////////////////////////////////////////////////////////
+  class ContentStore : private base::NonCopyable
+  {
+  public:
+    /** Ctor using the store below \a root_r. An empty \a root_r disables the store. */
+    explicit ContentStore( const Pathname & root_r );
+
+    /** The store as configured in zypp.conf. */
+    static ContentStore & instance();
+
+  public:
+    /** Whether the store is in use. */
+    bool enabled() const
+    { return ! _root.empty(); }
+
+    /** The stores root directory (empty if disabled). */
+    const Pathname & root() const
+    { return _root; }
+
+    /** Where a file with \a checksum_r is stored (empty if disabled or no checksum). */
+    Pathname path( const CheckSum & checksum_r ) const;
+
+    /** Provide the stored file matching \a checksum_r as \a dest_r.
+     * \a dest_r is replaced, its directory must exist.
+     * \return Whether \a dest_r was provided.
+     */
+    bool provide( const CheckSum & checksum_r, const Pathname & dest_r ) const;
+
+    /** Add \a file_r to the store, if it matches \a checksum_r.
+     * \return Whether a matching file is in the store now.
+     */
+    bool add( const Pathname & file_r, const CheckSum & checksum_r ) const;
+
+    /** Remove all entries which are not hardlinked from anywhere else.
+     * \return The number of removed entries.
+     */
+    unsigned clean() const;
+
+  private:
+    Pathname _root;
+  };
+
+  /** \relates ContentStore Stream output */
+  std::ostream & operator<<( std::ostream & str, const ContentStore & obj );
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_CONTENTSTORE_H
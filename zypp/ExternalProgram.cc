@@ -18,20 +18,122 @@
 #include <fcntl.h>
 #include <pty.h> // openpty
 #include <stdlib.h> // setenv
+#include <spawn.h>
 
 #include <cstring> // strsignal
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/ExternalProgram.h"
+#include "zypp/PathInfo.h"
 
 using namespace std;
 
+#if defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2,34)
+// posix_spawn_file_actions_addclosefrom_np, posix_spawn_file_actions_addchdir_np, close_range
+#define ZYPP_HAVE_SPAWN_CLOSEFROM 1
+#endif
+#endif
+
 namespace zypp {
 
+    namespace
+    {
+      /** Close all filedescriptors above stderr (in the forked child). */
+      inline void closeFdsAboveStderr()
+      {
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+	if ( ::close_range( 3, ~0U, 0 ) == 0 )
+	  return;	// else ENOSYS: kernel < 5.9
+#endif
+	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
+	  ::close( i );
+	}
+      }
+
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+      /** The parents environment with \a environment_r and LC_ALL applied (like \c setenv in the child). */
+      std::vector<std::string> childEnvironment( const ExternalProgram::Environment & environment_r, bool default_locale_r )
+      {
+	ExternalProgram::Environment overwrite( environment_r );
+	if ( default_locale_r )
+	  overwrite["LC_ALL"] = "C";
+
+	std::vector<std::string> ret;
+	for ( char ** env = environ; env && *env; ++env )
+	{
+	  const char * sep = ::strchr( *env, '=' );
+	  if ( sep && overwrite.count( std::string( *env, sep - *env ) ) )
+	    continue;
+	  ret.push_back( *env );
+	}
+	for_( it, overwrite.begin(), overwrite.end() )
+	  ret.push_back( it->first + "=" + it->second );
+	return ret;
+      }
+
+      /** Start \a argv_r via posix_spawnp (vfork semantics, no page table copy).
+       * Performs the same setup the forked child does for a pipe without chroot.
+       * \returns \c 0 or the errno value.
+       */
+      int spawnProgram( pid_t & pid_r, const char *const * argv_r,
+			int stdin_r, int stdout_r,
+			const char * redirectStdin_r, const char * redirectStdout_r, const char * chdirTo_r,
+			ExternalProgram::Stderr_Disposition stderr_disp_r, int stderr_fd_r,
+			const ExternalProgram::Environment & environment_r, bool default_locale_r )
+      {
+	posix_spawn_file_actions_t actions;
+	int ret = ::posix_spawn_file_actions_init( &actions );
+	if ( ret != 0 )
+	  return ret;
+
+	::posix_spawn_file_actions_adddup2( &actions, stdin_r, 0 );
+	::posix_spawn_file_actions_adddup2( &actions, stdout_r, 1 );
+
+	if ( redirectStdin_r )
+	  ::posix_spawn_file_actions_addopen( &actions, 0, redirectStdin_r, O_RDONLY, 0 );
+	if ( redirectStdout_r )
+	  ::posix_spawn_file_actions_addopen( &actions, 1, redirectStdout_r, O_WRONLY|O_CREAT|O_APPEND, 0600 );
+
+	if ( stderr_disp_r == ExternalProgram::Discard_Stderr )
+	  ::posix_spawn_file_actions_addopen( &actions, 2, "/dev/null", O_WRONLY, 0 );
+	else if ( stderr_disp_r == ExternalProgram::Stderr_To_Stdout )
+	  ::posix_spawn_file_actions_adddup2( &actions, 1, 2 );
+	else if ( stderr_disp_r == ExternalProgram::Stderr_To_FileDesc )
+	  ::posix_spawn_file_actions_adddup2( &actions, stderr_fd_r, 2 );
+
+	if ( chdirTo_r )
+	  ::posix_spawn_file_actions_addchdir_np( &actions, chdirTo_r );
+
+	// close all filedesctiptors above stderr
+	::posix_spawn_file_actions_addclosefrom_np( &actions, 3 );
+
+	if ( environment_r.empty() && ! default_locale_r )
+	{
+	  ret = ::posix_spawnp( &pid_r, argv_r[0], &actions, nullptr, const_cast<char *const *>(argv_r), environ );
+	}
+	else
+	{
+	  std::vector<std::string> env( childEnvironment( environment_r, default_locale_r ) );
+	  std::vector<char *> envp;
+	  envp.reserve( env.size() + 1 );
+	  for_( it, env.begin(), env.end() )
+	    envp.push_back( const_cast<char *>( it->c_str() ) );
+	  envp.push_back( nullptr );
+	  ret = ::posix_spawnp( &pid_r, argv_r[0], &actions, nullptr, const_cast<char *const *>(argv_r), &envp[0] );
+	}
+
+	::posix_spawn_file_actions_destroy( &actions );
+	return ret;
+      }
+#endif // ZYPP_HAVE_SPAWN_CLOSEFROM
+    } // namespace
+
     ExternalProgram::ExternalProgram()
       : use_pty (false)
       , pid( -1 )
@@ -273,8 +375,50 @@ namespace zypp {
     	}
       }
 
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+      // Without pty and chroot there is nothing the child must do between fork
+      // and exec, that posix_spawn can't do. It avoids copying our page tables.
+      // posix_spawnp searches the parents PATH, so fork if it is overwritten.
+      if ( ! use_pty && ! root && to_external[0] > 2 && from_external[1] > 2 && ! environment.count( "PATH" ) )
+      {
+	int err = 0;
+	if ( chdirTo )
+	{
+	  // posix_spawnp would report a failing chdir as exec error
+	  PathInfo pi( chdirTo );
+	  if ( ! pi.isDir() )
+	  {
+	    err = pi.isExist() ? ENOTDIR : pi.error();
+	    _execError = str::form( _("Can't chdir to '%s' (%s)."), chdirTo, strerror(err) );
+	    _exitStatus = 128;
+	  }
+	}
+	if ( err == 0 )
+	{
+	  err = spawnProgram( pid, argv, to_external[0], from_external[1],
+			      redirectStdin, redirectStdout, chdirTo,
+			      stderr_disp, stderr_fd, environment, default_locale );
+	  if ( err != 0 )
+	  {
+	    _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(err) );
+	    _exitStatus = 129;
+	  }
+	}
+	if ( err != 0 )
+	{
+	  pid = -1;
+	  ERR << _execError << endl;
+	  ::close(to_external[0]);
+	  ::close(to_external[1]);
+	  ::close(from_external[0]);
+	  ::close(from_external[1]);
+	  return;
+	}
+      }
+#endif // ZYPP_HAVE_SPAWN_CLOSEFROM
+
       // Create module process
-      if ((pid = fork()) == 0)
+      if ( pid == -1 && (pid = fork()) == 0 )
       {
         //////////////////////////////////////////////////////////////////////
         // Don't write to the logfile after fork!
@@ -364,9 +508,7 @@ namespace zypp {
 	}
 
     	// close all filedesctiptors above stderr
-    	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
-    	  ::close( i );
-    	}
+    	closeFdsAboveStderr();
 
     	execvp(argv[0], const_cast<char *const *>(argv));
         // don't want to get here
@@ -29,7 +29,9 @@ namespace zypp {
      * An object of this class encapsulates the execution of
      * an external program. It starts the program using fork
      * and some exec.. call, gives you access to the program's
-     * stdio and closes the program after use.
+     * stdio and closes the program after use. If neither a pty
+     * nor a chroot is needed, \c posix_spawn is used instead of
+     * fork, which is cheaper for a process with a large address space.
      *
      * \code
      *
@@ -23,6 +23,7 @@
 #include "zypp/Fetcher.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/CheckSum.h"
+#include "zypp/ContentStore.h"
 #include "zypp/base/UserRequestException.h"
 #include "zypp/parser/susetags/ContentFileReader.h"
 #include "zypp/parser/susetags/RepoIndex.h"
@@ -216,6 +217,12 @@ namespace zypp
        */
       void provideToDest( MediaSetAccess &media, const OnMediaLocation &resource, const Pathname &dest_dir , const Pathname &deltafile);
 
+      /**
+       * Let the media download the files we are going to
+       * provide concurrently, if it is able to.
+       */
+      void precache( MediaSetAccess &media, const Pathname &dest_dir );
+
   private:
     friend Impl * rwcowClone<Impl>( const Impl * rhs );
     /** clone for RWCOW_pointer */
@@ -379,6 +386,17 @@ namespace zypp
         }
       }
     } // iterate over caches
+
+    // finally look in the content store shared by all repos
+    if ( ! resource.checksum().empty() && ContentStore::instance().enabled() )
+    {
+      if ( assert_dir( dest_full_path.dirname() ) == 0
+           && ContentStore::instance().provide( resource.checksum(), dest_full_path ) )
+      {
+        MIL << "file " << resource.filename() << " found in " << ContentStore::instance() << endl;
+        return true;
+      }
+    }
     return false;
   }
 
@@ -547,9 +565,13 @@ namespace zypp
       MIL << "Not found in cache, downloading" << endl;
 
       // try to get the file from the net
+      // (the caches may hold older versions to download the changes only)
+      std::vector<Pathname> cachePaths( media.cachePaths() );
+      media.setCachePaths( std::vector<Pathname>( _caches.begin(), _caches.end() ) );
       try
       {
         Pathname tmp_file = media.provideFile(resource, resource.optional() ? MediaSetAccess::PROVIDE_NON_INTERACTIVE : MediaSetAccess::PROVIDE_DEFAULT, deltafile );
+        media.setCachePaths( cachePaths );
 
         Pathname dest_full_path = dest_dir + resource.filename();
 
@@ -570,6 +592,7 @@ namespace zypp
       }
       catch (Exception & excpt_r)
       {
+        media.setCachePaths( cachePaths );
         if ( resource.optional() )
         {
 	    ZYPP_CAUGHT(excpt_r);
@@ -744,6 +767,38 @@ namespace zypp
       MIL << "done reading indexes" << endl;
   }
 
+  /** Hand the files which are not yet in \a dest_dir or a cache to
+   * \ref MediaSetAccess::precacheFiles, if there is more than one.
+   * Files with a deltafile are left to provideToDest. Checksums are
+   * verified by the jobs checkers as usual.
+   */
+  void Fetcher::Impl::precache( MediaSetAccess &media, const Pathname &dest_dir )
+  {
+    std::vector<OnMediaLocation> resources;
+    for_( it_res, _resources.begin(), _resources.end() )
+    {
+      if ( ( (*it_res)->flags & FetcherJob::Directory ) || ! (*it_res)->deltafile.empty() )
+        continue;
+
+      const Pathname & filename( (*it_res)->location.filename() );
+      bool cached = PathInfo( dest_dir + filename ).isExist();
+      for_( it_cache, _caches.begin(), _caches.end() )
+      {
+        if ( cached )
+          break;
+        cached = PathInfo( *it_cache + filename ).isExist();
+      }
+      if ( ! cached )
+        resources.push_back( (*it_res)->location );
+    }
+
+    if ( resources.size() > 1 )
+    {
+      MIL << "Precaching " << resources.size() << " files" << endl;
+      media.precacheFiles( resources );
+    }
+  }
+
   // start processing all fetcher jobs.
   // it processes any user pointed index first
   void Fetcher::Impl::start( const Pathname &dest_dir,
@@ -755,6 +810,8 @@ namespace zypp
 
     downloadAndReadIndexList(media, dest_dir);
 
+    precache(media, dest_dir);
+
     for ( list<FetcherJob_Ptr>::const_iterator it_res = _resources.begin(); it_res != _resources.end(); ++it_res )
     {
 
@@ -836,6 +893,10 @@ namespace zypp
       // validate job, this throws if not valid
       validate((*it_res)->location, dest_dir, (*it_res)->checkers);
 
+      // share it with other repos and roots
+      if ( ! (*it_res)->location.checksum().empty() )
+        ContentStore::instance().add( dest_dir + (*it_res)->location.filename(), (*it_res)->location.checksum() );
+
       if ( ! progress.incr() )
         ZYPP_THROW(AbortRequestException());
     } // for each job
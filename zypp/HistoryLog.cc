@@ -12,11 +12,14 @@
 #include <iostream>
 #include <fstream>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
 
 #include "zypp/ZConfig.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/IOStream.h"
+#include "zypp/base/GzStream.h"
 
 #include "zypp/PathInfo.h"
 #include "zypp/Date.h"
@@ -108,11 +111,196 @@ namespace zypp
     Pathname		_fname;
     Pathname		_fnameLastFail;
 
+    std::string		_lastIndexedDay;	///< day of the last record noted in the index
+
+    /** The day (\c %Y-%m-%d) a log record was written (empty for comments and junk). */
+    inline string recordDay( const string & line_r )
+    {
+      if ( line_r.size() < 10 || line_r[0] == '#' || line_r[4] != '-' || line_r[7] != '-' )
+	return string();
+      return line_r.substr( 0, 10 );
+    }
+
+    /** Remember the last day noted in the index.
+     * If there is no index yet but the log already contains records, we start
+     * with the day of the last record in the log. A day already present in the
+     * log must not be indexed, because its first record is not known.
+     */
+    inline void openIndex()
+    {
+      _lastIndexedDay.clear();
+      Pathname indexfile( _fname.extend( HISTORY_LOG_INDEX_SUFFIX ) );
+      Pathname scanfile( indexfile );
+
+      PathInfo pi( indexfile );
+      if ( ! pi.isFile() )
+      {
+	pi( _fname );
+	if ( ! pi.isFile() || ! pi.size() )
+	  return;
+	scanfile = _fname;
+      }
+
+      // the last line is all we need
+      std::ifstream in( scanfile.c_str() );
+      if ( pi.size() > 4096 )
+	in.seekg( pi.size() - 4096 );
+      for( iostr::EachLine line( in ); line; line.next() )
+      {
+	string day( recordDay( *line ) );
+	if ( ! day.empty() )
+	  _lastIndexedDay = day;
+      }
+    }
+
+    /** Note the current log offset in the index, if \a timestamp_r starts a new day. */
+    inline void indexRecord( const string & timestamp_r )
+    {
+      string day( recordDay( timestamp_r ) );
+      if ( day.empty() || day <= _lastIndexedDay || ! _log.is_open() )
+	return;
+
+      _log.flush();
+      PathInfo pi( _fname );
+      if ( ! pi.isFile() )
+	return;
+
+      std::ofstream index( _fname.extend( HISTORY_LOG_INDEX_SUFFIX ).c_str(), std::ios::out|std::ios::app );
+      index << day << _sep << pi.size() << endl;
+      if ( index )
+	_lastIndexedDay = day;
+      else
+	WAR << "Could not update history log index for '" << _fname << "'" << endl;
+    }
+
+    /** Exclusive lock serializing the rotation of the log (\c <log>.lock).
+     * \ingroup g_RAII
+     */
+    struct HistoryLock : private base::NonCopyable
+    {
+      HistoryLock()
+      : _fd( ::open( _fname.extend( ".lock" ).c_str(), O_RDWR|O_CREAT|O_CLOEXEC, 0600 ) )
+      {
+	if ( _fd == -1 || ::flock( _fd, LOCK_EX ) != 0 )
+	  WAR << "Could not lock '" << _fname.extend( ".lock" ) << "'" << endl;
+      }
+
+      ~HistoryLock()
+      {
+	if ( _fd != -1 )
+	  ::close( _fd );	// releases the lock
+      }
+
+    private:
+      int _fd;
+    };
+
+    /** Whether the log exceeds the limits configured in \ref ZConfig. */
+    inline bool rotationDue()
+    {
+      const ZConfig & zconfig( ZConfig::instance() );
+      if ( ! ( zconfig.historyLogRotateSize() || zconfig.historyLogRotateDays() ) )
+	return false;
+
+      PathInfo pi( _fname );
+      if ( ! pi.isFile() || ! pi.size() )
+	return false;
+
+      bool rotate = ( zconfig.historyLogRotateSize() && ByteCount( pi.size() ) >= zconfig.historyLogRotateSize() );
+      if ( ! rotate && zconfig.historyLogRotateDays() )
+      {
+	// age of the first record
+	std::ifstream in( _fname.c_str() );
+	for( iostr::EachLine line( in ); line; line.next() )
+	{
+	  string day( recordDay( *line ) );
+	  if ( day.empty() )
+	    continue;
+	  rotate = ( Date( day, "%Y-%m-%d" ) + zconfig.historyLogRotateDays() * Date::day <= Date::now() );
+	  break;
+	}
+      }
+      return rotate;
+    }
+
+    /** Rename the log to \c history-<YYYYMMDDhhmmss> and remove the day index.
+     * Nothing appended meanwhile is lost, as the file is moved, not copied.
+     * Returns the rotated file or an empty path.
+     */
+    inline Pathname rotateLog()
+    {
+      if ( ! rotationDue() )	// also rechecked with the lock held
+	return Pathname();
+
+      Pathname rotated( _fname.extend( Date::now().form( "-%Y%m%d%H%M%S" ) ) );
+      if ( PathInfo( rotated ).isExist() || PathInfo( rotated.extend( ".gz" ) ).isExist() )
+	return Pathname();	// rotated within the same second
+      if ( filesystem::rename( _fname, rotated ) != 0 )
+      {
+	ERR << "Could not rotate logfile '" << _fname << "' to '" << rotated << "'" << endl;
+	return Pathname();
+      }
+      filesystem::unlink( _fname.extend( HISTORY_LOG_INDEX_SUFFIX ) );
+      MIL << "Rotated logfile '" << _fname << "' to '" << rotated << "'" << endl;
+      return rotated;
+    }
+
+    /** Compress the rotated logs into \c history-<YYYYMMDDhhmmss>.gz, except
+     * for the \a latest_r one. Processes which opened the log before it was
+     * rotated may still append to it, so it's compressed on the next rotation.
+     * Rotated logs exceeding the number to keep are deleted.
+     */
+    inline void compressRotatedLogs( const Pathname & latest_r )
+    {
+      std::map<Date,Pathname> logs( HistoryLog::rotatedLogs( _fname ) );
+      for ( auto & log : logs )
+      {
+	const Pathname & rotated( log.second );
+	if ( rotated == latest_r || rotated.extension() == ".gz" )
+	  continue;
+
+	Pathname compressed( rotated.extend( ".gz" ) );
+	{
+	  std::ifstream in( rotated.c_str() );
+	  ofgzstream out( compressed.c_str() );
+	  out << in.rdbuf();
+	  out.close();
+	  if ( ! in || ! out )
+	  {
+	    ERR << "Could not compress rotated logfile '" << rotated << "'" << endl;
+	    filesystem::unlink( compressed );	// keep it uncompressed
+	    continue;
+	  }
+	}
+	filesystem::unlink( rotated );
+	log.second = compressed;
+      }
+
+      const ZConfig & zconfig( ZConfig::instance() );
+      if ( zconfig.historyLogRotateKeep() )
+      {
+	for ( auto it = logs.begin(); logs.size() > zconfig.historyLogRotateKeep(); it = logs.erase( it ) )
+	{
+	  MIL << "Remove rotated logfile '" << it->second << "'" << endl;
+	  filesystem::unlink( it->second );
+	}
+      }
+    }
+
     inline void openLog()
     {
       if ( _fname.empty() )
         _fname = ZConfig::instance().historyLogFile();
 
+      // Rotation: rename the log, reopen it, then compress the formerly rotated files.
+      scoped_ptr<HistoryLock> lock;
+      Pathname rotated;
+      if ( rotationDue() )
+      {
+	lock.reset( new HistoryLock );
+	rotated = rotateLog();
+      }
+
       _log.clear();
       _log.open( _fname.asString().c_str(), std::ios::out|std::ios::app );
       if( !_log && _fnameLastFail != _fname )
@@ -120,6 +308,10 @@ namespace zypp
         ERR << "Could not open logfile '" << _fname << "'" << endl;
 	_fnameLastFail = _fname;
       }
+      openIndex();
+
+      if ( ! rotated.empty() )
+	compressRotatedLogs( rotated );
     }
 
     inline void closeLog()
@@ -141,6 +333,14 @@ namespace zypp
       if ( !_refcnt )
         closeLog();
     }
+
+    /** Timestamp starting a new log record (maintains the day index). */
+    inline string recordTimestamp()
+    {
+      string ret( timestamp() );
+      indexRecord( ret );
+      return ret;
+    }
   } // namespace
 
   ///////////////////////////////////////////////////////////////////
@@ -183,6 +383,30 @@ namespace zypp
     return _fname;
   }
 
+  std::map<Date,Pathname> HistoryLog::rotatedLogs( const Pathname & logfile_r )
+  {
+    std::map<Date,Pathname> ret;
+    std::list<string> names;
+    if ( filesystem::readdir( names, logfile_r.dirname(), false ) != 0 )
+      return ret;
+
+    // <basename>-YYYYMMDDhhmmss[.gz]
+    const string prefix( logfile_r.basename() + "-" );
+    for ( const string & name : names )
+    {
+      if ( ! str::hasPrefix( name, prefix ) )
+	continue;
+      string stamp( name.substr( prefix.size(), 14 ) );
+      if ( stamp.size() != 14 || stamp.find_first_not_of( "0123456789" ) != string::npos )
+	continue;
+      string suffix( name.substr( prefix.size() + 14 ) );
+      if ( ! ( suffix.empty() || suffix == ".gz" ) )
+	continue;
+      ret[Date( stamp, "%Y%m%d%H%M%S" )] = logfile_r.dirname() / name;
+    }
+    return ret;
+  }
+
   /////////////////////////////////////////////////////////////////////////
 
   void HistoryLog::comment( const string & comment, bool timestamp_r )
@@ -220,7 +444,7 @@ namespace zypp
   void HistoryLog::stampCommand()
   {
     _log
-      << timestamp()							// 1 timestamp
+      << recordTimestamp()						// 1 timestamp
       << _sep << HistoryActionID::STAMP_COMMAND.asString(true)		// 2 action
       << _sep << userAtHostname()					// 3 requested by
       << _sep << cmdline()						// 4 command
@@ -236,7 +460,7 @@ namespace zypp
       return;
 
     _log
-      << timestamp()							// 1 timestamp
+      << recordTimestamp()						// 1 timestamp
       << _sep << HistoryActionID::INSTALL.asString(true)		// 2 action
       << _sep << p->name()						// 3 name
       << _sep << p->edition()						// 4 evr
@@ -265,7 +489,7 @@ namespace zypp
       return;
 
     _log
-      << timestamp()							// 1 timestamp
+      << recordTimestamp()						// 1 timestamp
       << _sep << HistoryActionID::REMOVE.asString(true)			// 2 action
       << _sep << p->name()						// 3 name
       << _sep << p->edition()						// 4 evr
@@ -289,7 +513,7 @@ namespace zypp
   void HistoryLog::addRepository(const RepoInfo & repo)
   {
     _log
-      << timestamp()							// 1 timestamp
+      << recordTimestamp()						// 1 timestamp
       << _sep << HistoryActionID::REPO_ADD.asString(true)		// 2 action
       << _sep << str::escape(repo.alias(), _sep)			// 3 alias
       << _sep << *repo.baseUrlsBegin()					// 4 primary URL
@@ -301,7 +525,7 @@ namespace zypp
   void HistoryLog::removeRepository(const RepoInfo & repo)
   {
     _log
-      << timestamp()							// 1 timestamp
+      << recordTimestamp()						// 1 timestamp
       << _sep << HistoryActionID::REPO_REMOVE.asString(true)		// 2 action
       << _sep << str::escape(repo.alias(), _sep)			// 3 alias
       << _sep << str::escape(ZConfig::instance().userData(), _sep)	// 4 userdata
@@ -315,7 +539,7 @@ namespace zypp
     if (oldrepo.alias() != newrepo.alias())
     {
       _log
-        << timestamp()							// 1 timestamp
+        << recordTimestamp()						// 1 timestamp
         << _sep << HistoryActionID::REPO_CHANGE_ALIAS.asString(true)	// 2 action
         << _sep << str::escape(oldrepo.alias(), _sep)			// 3 old alias
         << _sep << str::escape(newrepo.alias(), _sep)			// 4 new alias
@@ -325,7 +549,7 @@ namespace zypp
     if (*oldrepo.baseUrlsBegin() != *newrepo.baseUrlsBegin())
     {
       _log
-        << timestamp()							// 1 timestamp
+        << recordTimestamp()						// 1 timestamp
         << _sep << HistoryActionID::REPO_CHANGE_URL.asString(true)	// 2 action
         << _sep << str::escape(oldrepo.alias(), _sep)			// 3 old url
         << _sep << *newrepo.baseUrlsBegin()				// 4 new url
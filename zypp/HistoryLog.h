@@ -13,8 +13,10 @@
 #define ZYPP_TARGET_COMMITLOG_H
 
 #include <iosfwd>
+#include <map>
 
 #include "zypp/Pathname.h"
+#include "zypp/Date.h"
 
 namespace zypp
 {
@@ -48,6 +50,16 @@ namespace zypp
   /// The default location of the file is determined by
   /// \ref zypp::ZConfig::historyLogPath (default: \c /var/log/zypp/history).
   ///
+  /// Along with the log a day index is maintained (\c history.idx), noting
+  /// the offset of each days first record. It allows \ref parser::HistoryLogReader
+  /// to seek to a date rather than reading the whole file.
+  ///
+  /// If configured in \ref ZConfig, the log is rotated when it is opened and
+  /// exceeds the size or age limits. The old log is renamed to
+  /// \c history-<YYYYMMDDhhmmss> (the rotation date) and compressed into
+  /// \c history-<YYYYMMDDhhmmss>.gz on the next rotation. \ref rotatedLogs
+  /// lists the rotated logs, \ref parser::HistoryLogReader is able to read them.
+  ///
   /// \todo The implementation as pseudo signleton is questionable.
   /// Use shared_ptr instead of handcrafted ref/unref. Manage multiple
   /// logs at different locations.
@@ -80,6 +92,13 @@ namespace zypp
      */
     static const Pathname & fname();
 
+    /**
+     * The rotated logs of \a logfile_r ordered by rotation date.
+     *
+     * A rotated log contains the records logged before its rotation date.
+     */
+    static std::map<Date,Pathname> rotatedLogs( const Pathname & logfile_r );
+
     /**
      * Log a comment (even multiline).
      *
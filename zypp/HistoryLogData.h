@@ -24,6 +24,12 @@
 
 #define HISTORY_LOG_DATE_FORMAT "%Y-%m-%d %H:%M:%S"
 
+/** Suffix of the day index file maintained next to the history log.
+ * Each line holds a day (\c %Y-%m-%d) and the byte offset of the first
+ * record of that day in the log (separated by \c '|').
+ */
+#define HISTORY_LOG_INDEX_SUFFIX ".idx"
+
 ///////////////////////////////////////////////////////////////////
 namespace zypp
 {
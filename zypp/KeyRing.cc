@@ -25,6 +25,7 @@
 #include "zypp/base/Regex.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/WatchFile.h"
+#include "zypp/base/Measure.h"
 #include "zypp/PathInfo.h"
 #include "zypp/KeyRing.h"
 #include "zypp/ExternalProgram.h"
@@ -627,6 +628,7 @@ namespace zypp
 
   bool KeyRing::Impl::verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring )
   {
+    debug::MeasureCounter counter( "KeyRing::verify" );
     const char* argv[] =
     {
       GPG_BINARY,
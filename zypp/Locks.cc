@@ -8,6 +8,8 @@
 \---------------------------------------------------------------------*/
 
 #include <set>
+#include <map>
+#include <vector>
 #include <fstream>
 #include <boost/function.hpp>
 #include <boost/function_output_iterator.hpp>
@@ -23,6 +25,7 @@
 #include "zypp/sat/SolvAttr.h"
 #include "zypp/sat/Solvable.h"
 #include "zypp/PathInfo.h"
+#include "zypp/pool/LockSet.h"
 
 #undef ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "locks"
@@ -129,7 +132,13 @@ void Locks::read( const Pathname& file )
 void Locks::apply() const
 { 
   DBG << "apply locks" << endl;
-  for_each(begin(), end(), ApplyLock());
+  PoolQueryResult locked( pool::LockSet( begin(), end() ).result() );
+  for_( it, locked.begin(), locked.end() )
+  {
+    PoolItem item( *it );
+    item.status().setLock(true,ResStatus::USER);
+    DBG << "lock "<< item.name();
+  }
 }
 
 
@@ -308,35 +317,41 @@ void Locks::removeEmpty()
 
 class LocksRemovePredicate
 {
+public:
+  /** The results of the locks, evaluated at once by \ref pool::LockSet. */
+  typedef std::map<const PoolQuery*, PoolQueryResult> Results;
+
 private:
-  std::set<sat::Solvable>& solvs;
+  const PoolQueryResult& solvs;
   const PoolQuery& query;
+  const Results& results;
   callback::SendReport<SavingLocksReport>& report;
   bool aborted_;
 
   //1 for subset of set, 2 only intersect, 0 for not intersect
-  int contains(const PoolQuery& q, std::set<sat::Solvable>& s)
+  int contains(const PoolQuery& q, const PoolQueryResult& s)
   {
+    Results::const_iterator res( results.find( &q ) );
+    if ( res == results.end() || res->second.empty() )
+      return 0;
     bool intersect = false;
-    for_( it,q.begin(),q.end() )
+    bool subset = true;
+    for_( it, res->second.begin(), res->second.end() )
     {
-      if ( s.find(*it)!=s.end() )
-      {
+      if ( s.contains(*it) )
         intersect = true;
-      }
       else
-      {
-        if (intersect)
-          return 2;
-      }
+        subset = false;
     }
-    return intersect ? 1 : 0;
+    if ( ! intersect )
+      return 0;
+    return subset ? 1 : 2;
   }
 
 public:
-  LocksRemovePredicate(std::set<sat::Solvable>& s, const PoolQuery& q,
+  LocksRemovePredicate(const PoolQueryResult& s, const PoolQuery& q, const Results& res,
       callback::SendReport<SavingLocksReport>& r)
-      : solvs(s), query(q),report(r),aborted_(false) {}
+      : solvs(s), query(q), results(res), report(r), aborted_(false) {}
 
   bool operator()(const PoolQuery& q)
   {
@@ -387,10 +402,21 @@ bool Locks::Impl::mergeList(callback::SendReport<SavingLocksReport>& report)
 {
   MIL << "merging list old: " << locks.size()
     << " to add: " << toAdd.size() << "to remove: " << toRemove.size() << endl;
-  for_(it,toRemove.begin(),toRemove.end())
+  if ( ! toRemove.empty() && ! locks.empty() )
   {
-    std::set<sat::Solvable> s(it->begin(),it->end());
-    locks.remove_if(LocksRemovePredicate(s,*it, report));
+    // evaluate all locks and all queries to remove in a single pool pass
+    pool::LockSet lockset( locks.begin(), locks.end() );
+    for_( it, toRemove.begin(), toRemove.end() )
+      lockset.add( *it );
+    std::vector<PoolQueryResult> evaluated( lockset.results() );
+
+    LocksRemovePredicate::Results results;
+    std::vector<PoolQueryResult>::const_iterator res( evaluated.begin() );
+    for_( it, locks.begin(), locks.end() )
+      results[&*it] = *res++;	// list elements are not moved by remove_if
+
+    for_( it, toRemove.begin(), toRemove.end() )
+      locks.remove_if(LocksRemovePredicate(*res++, *it, results, report));
   }
 
   if (!report->progress())
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Regex.h"
@@ -16,6 +17,7 @@
 #include "zypp/ZYppCallbacks.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/PathInfo.h"
+#include "zypp/CheckSumCache.h"
 //#include "zypp/source/MediaSetAccessReportReceivers.h"
 
 using namespace std;
@@ -71,6 +73,31 @@ IMPL_PTR_TYPE(MediaSetAccess);
     }
   }
 
+  void MediaSetAccess::precacheFiles( const std::vector<OnMediaLocation> & resources )
+  {
+    std::map<unsigned, std::vector<Pathname> > files;
+    for_( it, resources.begin(), resources.end() )
+      files[it->medianr()].push_back( it->filename() );
+
+    media::MediaManager media_mgr;
+    for_( it, files.begin(), files.end() )
+    {
+      try
+      {
+        media::MediaAccessId media = getMediaAccessId( it->first );
+        if ( ! media_mgr.isAttached(media) )
+          media_mgr.attach(media);
+        media_mgr.precacheFiles( media, it->second );
+      }
+      catch ( const Exception & excpt_r )
+      {
+        // provideFile will tell
+        ZYPP_CAUGHT( excpt_r );
+        MIL << "Can't precache files from media number " << it->first << endl;
+      }
+    }
+  }
+
   void MediaSetAccess::releaseFile( const OnMediaLocation & on_media_file )
   {
     releaseFile( on_media_file.filename(), on_media_file.medianr() );
@@ -186,6 +213,8 @@ IMPL_PTR_TYPE(MediaSetAccess);
   {
     Pathname file(resource.filename());
     unsigned media_nr(resource.medianr());
+    // let the media backend compute the checksum we'll verify while downloading
+    CheckSumCache::ScopedWantedType wantedChecksum( resource.checksum().type() );
 
     callback::SendReport<media::MediaChangeReport> report;
     media::MediaManager media_mgr;
@@ -206,16 +235,21 @@ IMPL_PTR_TYPE(MediaSetAccess);
         if ( ! media_mgr.isAttached(media) )
           media_mgr.attach(media);
 	media_mgr.setDeltafile(media, deltafile);
+	media_mgr.setCachePaths(media, _cachePaths);
 	deltafileset = true;
         op(media, file);
 	media_mgr.setDeltafile(media, Pathname());
+	media_mgr.setCachePaths(media, std::vector<Pathname>());
         break;
       }
       catch ( media::MediaException & excp )
       {
         ZYPP_CAUGHT(excp);
 	if (deltafileset)
+	{
 	  media_mgr.setDeltafile(media, Pathname());
+	  media_mgr.setCachePaths(media, std::vector<Pathname>());
+	}
         media::MediaChangeReport::Action user = media::MediaChangeReport::ABORT;
         unsigned int devindex = 0;
         vector<string> devices;
@@ -108,6 +108,20 @@ namespace zypp
       void setLabel( const std::string & label_r )
       { _label = label_r; }
 
+      /**
+       * Local cache directories possibly holding older versions of the
+       * files to provide (e.g. the package caches, see \ref Fetcher::addCachePath).
+       * Download backends may reuse unchanged parts of them.
+       */
+      const std::vector<Pathname> & cachePaths() const
+      { return _cachePaths; }
+
+      /**
+       * Set the local cache directories passed to the media handler.
+       */
+      void setCachePaths( const std::vector<Pathname> & cachePaths_r )
+      { _cachePaths = cachePaths_r; }
+
       enum ProvideFileOption
       {
         /**
@@ -169,6 +183,20 @@ namespace zypp
        */
       Pathname provideFile(const Pathname & file, unsigned media_nr = 1, ProvideFileOptions options = PROVIDE_DEFAULT );
 
+      /**
+       * Hint that \a resources are going to be provided next.
+       *
+       * Media able to transfer several files at once (e.g. http) download
+       * them concurrently in advance, so the following \ref provideFile
+       * calls find them already in place. This is best effort only and
+       * never interacts with the user. Whatever could not be fetched is
+       * downloaded (and any error reported) by \ref provideFile as usual.
+       *
+       * \note No checksums are verified here, it's up to the caller to
+       * check the provided files.
+       */
+      void precacheFiles( const std::vector<OnMediaLocation> & resources );
+
       /**
        * Release file from media.
        * This signal that file is not needed anymore.
@@ -290,6 +318,9 @@ namespace zypp
 
       std::string _label;
 
+      /** Local caches passed to the media handler */
+      std::vector<Pathname> _cachePaths;
+
       typedef std::map<media::MediaNr, media::MediaAccessId> MediaMap;
       typedef std::map<media::MediaNr, media::MediaVerifierRef > VerifierMap;
 
@@ -0,0 +1,173 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PatchReferenceIndex.cc
+ *
+*/
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/SerialNumber.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/IdString.h"
+#include "zypp/ResKind.h"
+
+#include "zypp/PatchReferenceIndex.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class PatchReferenceIndex::Impl
+  /// \brief PatchReferenceIndex implementation.
+  ///
+  /// The ids are kept sorted (for prefix search) along with a hash
+  /// for the exact lookup.
+  ///////////////////////////////////////////////////////////////////
+  class PatchReferenceIndex::Impl
+  {
+  public:
+    /** A reference to an issue. */
+    struct Ref
+    {
+      Ref( IdString type_r, sat::Solvable patch_r )
+      : type( type_r ), patch( patch_r )
+      {}
+      IdString type;
+      sat::Solvable patch;
+    };
+    typedef std::vector<Ref> Refs;
+
+  public:
+    sat::SolvableSet find( const std::string & id_r, const std::string & type_r ) const
+    {
+      check();
+      sat::SolvableSet ret;
+      std::unordered_map<std::string,unsigned>::const_iterator it( _byId.find( str::toLower( id_r ) ) );
+      if ( it != _byId.end() )
+	collect( _refs[it->second], typeId( type_r ), ret );
+      return ret;
+    }
+
+    sat::SolvableSet findPrefix( const std::string & prefix_r, const std::string & type_r ) const
+    {
+      check();
+      sat::SolvableSet ret;
+      std::string prefix( str::toLower( prefix_r ) );
+      IdString type( typeId( type_r ) );
+      for ( std::vector<std::string>::const_iterator it = std::lower_bound( _ids.begin(), _ids.end(), prefix );
+	    it != _ids.end() && it->compare( 0, prefix.size(), prefix ) == 0; ++it )
+	collect( _refs[it - _ids.begin()], type, ret );
+      return ret;
+    }
+
+    unsigned size() const
+    {
+      check();
+      return _ids.size();
+    }
+
+  private:
+    static IdString typeId( const std::string & type_r )
+    { return type_r.empty() ? IdString() : IdString( str::toLower( type_r ) ); }
+
+    static void collect( const Refs & refs_r, IdString type_r, sat::SolvableSet & result_r )
+    {
+      for_( it, refs_r.begin(), refs_r.end() )
+      {
+	if ( type_r.empty() || it->type == type_r )
+	  result_r.insert( it->patch );
+      }
+    }
+
+    /** (Re)build the index if the pool has changed. */
+    void check() const
+    {
+      if ( ! _watcher.remember( sat::Pool::instance().serial() ) )
+	return;
+
+      std::map<std::string,Refs> index;
+      sat::LookupAttr references( sat::SolvAttr::updateReference );
+      for_( it, references.begin(), references.end() )
+      {
+	sat::Solvable patch( it.inSolvable() );
+	if ( ! patch.isKind( ResKind::patch ) )
+	  continue;
+	std::string id( str::toLower( it.subFind( sat::SolvAttr::updateReferenceId ).asString() ) );
+	if ( id.empty() )
+	  continue;
+	IdString type( typeId( it.subFind( sat::SolvAttr::updateReferenceType ).asString() ) );
+	index[id].push_back( Ref( type, patch ) );
+      }
+
+      _ids.clear();
+      _refs.clear();
+      _byId.clear();
+      _ids.reserve( index.size() );
+      _refs.reserve( index.size() );
+      for_( it, index.begin(), index.end() )
+      {
+	_byId[it->first] = _ids.size();
+	_ids.push_back( it->first );
+	_refs.push_back( Refs() );
+	_refs.back().swap( it->second );
+      }
+      MIL << "Indexed " << _ids.size() << " patch references" << endl;
+    }
+
+  private:
+    mutable SerialNumberWatcher _watcher;
+    /** Sorted ids... */
+    mutable std::vector<std::string> _ids;
+    /** ...and the references to each one. */
+    mutable std::vector<Refs> _refs;
+    /** Position of an id in \ref _ids. */
+    mutable std::unordered_map<std::string,unsigned> _byId;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	CLASS NAME : PatchReferenceIndex
+  //
+  ///////////////////////////////////////////////////////////////////
+
+  const PatchReferenceIndex & PatchReferenceIndex::instance()
+  {
+    static PatchReferenceIndex _instance;
+    return _instance;
+  }
+
+  PatchReferenceIndex::PatchReferenceIndex()
+  : _pimpl( new Impl )
+  {}
+
+  PatchReferenceIndex::~PatchReferenceIndex()
+  {}
+
+  sat::SolvableSet PatchReferenceIndex::find( const std::string & id_r, const std::string & type_r ) const
+  { return _pimpl->find( id_r, type_r ); }
+
+  sat::SolvableSet PatchReferenceIndex::findPrefix( const std::string & prefix_r, const std::string & type_r ) const
+  { return _pimpl->findPrefix( prefix_r, type_r ); }
+
+  unsigned PatchReferenceIndex::size() const
+  { return _pimpl->size(); }
+
+  std::ostream & operator<<( std::ostream & str, const PatchReferenceIndex & obj )
+  { return str << "PatchReferenceIndex(" << obj.size() << " issues)"; }
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
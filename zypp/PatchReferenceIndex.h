@@ -0,0 +1,82 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PatchReferenceIndex.h
+ *
+*/
+#ifndef ZYPP_PATCHREFERENCEINDEX_H
+#define ZYPP_PATCHREFERENCEINDEX_H
+
+#include <iosfwd>
+#include <string>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/SolvableSet.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class PatchReferenceIndex
+  /// \brief Index of the issues (bugzilla, CVE, ...) referenced by the patches.
+  ///
+  /// Maps the id of an issue to the patches referring to it (see
+  /// \ref Patch::ReferenceIterator), optionally restricted to a
+  /// reference type (e.g. \c "bugzilla" or \c "cve"). Ids are compared
+  /// case insensitive.
+  ///
+  /// The index is built on first use and rebuilt on demand, if the pool
+  /// content has changed meanwhile.
+  ///
+  /// \code
+  ///   const PatchReferenceIndex & index( PatchReferenceIndex::instance() );
+  ///   for ( const sat::Solvable & patch : index.find( "CVE-2014-0160" ) )
+  ///     ...
+  ///   index.findPrefix( "CVE-2014-", "cve" );	// all issues from 2014
+  /// \endcode
+  ///////////////////////////////////////////////////////////////////
+  class PatchReferenceIndex : private base::NonCopyable
+  {
+    friend std::ostream & operator<<( std::ostream & str, const PatchReferenceIndex & obj );
+
+  public:
+    /** The index of the pool. */
+    static const PatchReferenceIndex & instance();
+
+  public:
+    /** Patches referring to issue \a id_r (of type \a type_r, if not empty). */
+    sat::SolvableSet find( const std::string & id_r, const std::string & type_r = std::string() ) const;
+
+    /** Patches referring to an issue whose id starts with \a prefix_r (of type \a type_r, if not empty). */
+    sat::SolvableSet findPrefix( const std::string & prefix_r, const std::string & type_r = std::string() ) const;
+
+    /** Whether some patch refers to issue \a id_r (of type \a type_r, if not empty). */
+    bool contains( const std::string & id_r, const std::string & type_r = std::string() ) const
+    { return ! find( id_r, type_r ).empty(); }
+
+    /** The number of distinct issue ids. */
+    unsigned size() const;
+
+  public:
+    class Impl;              ///< Implementation class.
+  private:
+    /** Ctor */
+    PatchReferenceIndex();
+    /** Dtor */
+    ~PatchReferenceIndex();
+
+    RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+  };
+
+  /** \relates PatchReferenceIndex Stream output */
+  std::ostream & operator<<( std::ostream & str, const PatchReferenceIndex & obj );
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_PATCHREFERENCEINDEX_H
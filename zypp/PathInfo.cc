@@ -13,6 +13,10 @@
 #include <sys/types.h> // for ::minor, ::major macros
 #include <utime.h>     // for ::utime
 #include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>  // for FICLONE
 
 #include <iostream>
 #include <fstream>
@@ -25,9 +29,9 @@
 #include "zypp/base/Errno.h"
 
 #include "zypp/AutoDispose.h"
-#include "zypp/ExternalProgram.h"
 #include "zypp/PathInfo.h"
 #include "zypp/Digest.h"
+#include "zypp/CheckSumCache.h"
 #include "zypp/TmpPath.h"
 
 using std::endl;
@@ -298,6 +302,277 @@ namespace zypp
       }
     } // namespace
 
+    ///////////////////////////////////////////////////////////////////
+    // In-process replacement for the '/bin/cp' calls we used to fork.
+    ///////////////////////////////////////////////////////////////////
+    namespace {
+      /** Close an fd, returning errno or 0. */
+      inline int closeFd( int fd_r )
+      { return ::close( fd_r ) == -1 ? errno : 0; }
+
+      /** Whether to give up an in-kernel copy method and try the next one. */
+      inline bool copyMethodUnsupported( int errno_r )
+      { return errno_r == ENOSYS || errno_r == EXDEV || errno_r == EINVAL || errno_r == EOPNOTSUPP; }
+
+      /** Copy the data of fd \a from_r to fd \a to_r, starting at the current offsets.
+       * Try to reflink (FICLONE) first, then copy_file_range(2) and sendfile(2),
+       * finally fall back to read/write.
+       * \return 0 on success, errno on failure.
+       */
+      int copyFileData( int from_r, int to_r )
+      {
+#ifdef FICLONE
+	if ( ::ioctl( to_r, FICLONE, from_r ) == 0 )
+	  return 0;
+#endif
+#ifdef __NR_copy_file_range
+	bool tryCopyFileRange = true;
+#else
+	bool tryCopyFileRange = false;
+#endif
+	bool trySendfile = true;
+	static const size_t chunk = 16 * 1024 * 1024;
+
+	while ( true )
+	{
+	  ssize_t res = 0;
+	  if ( tryCopyFileRange )
+	  {
+#ifdef __NR_copy_file_range
+	    res = ::syscall( __NR_copy_file_range, from_r, NULL, to_r, NULL, chunk, 0 );
+#endif
+	    if ( res == -1 && copyMethodUnsupported( errno ) )
+	    {
+	      tryCopyFileRange = false;
+	      continue;
+	    }
+	  }
+	  else if ( trySendfile )
+	  {
+	    res = ::sendfile( to_r, from_r, NULL, chunk );
+	    if ( res == -1 && copyMethodUnsupported( errno ) )
+	    {
+	      trySendfile = false;
+	      continue;
+	    }
+	  }
+	  else
+	  {
+	    char buf[64 * 1024];
+	    res = ::read( from_r, buf, sizeof(buf) );
+	    for ( ssize_t done = 0; res > 0 && done < res; )
+	    {
+	      ssize_t written = ::write( to_r, buf + done, res - done );
+	      if ( written == -1 )
+	      {
+		if ( errno == EINTR )
+		  continue;
+		return errno;
+	      }
+	      done += written;
+	    }
+	  }
+
+	  if ( res == 0 )
+	    break;	// EOF
+	  if ( res == -1 )
+	  {
+	    if ( errno == EINTR )
+	      continue;
+	    return errno;
+	  }
+	}
+	return 0;
+      }
+
+      /** Like 'cp [--remove-destination] file dest' on a regular file \a file_r.
+       * New files are created with the source files permissions (less umask),
+       * existing ones are overwritten, unless \a removeDestination_r.
+       * \return 0 on success, errno on failure (\c EINVAL if both are the same file).
+       */
+      int copyFile( const Pathname & file_r, const Pathname & dest_r, bool removeDestination_r = false )
+      {
+	int from = ::open( file_r.c_str(), O_RDONLY | O_CLOEXEC );
+	if ( from == -1 )
+	  return errno;
+
+	struct stat st;
+	if ( ::fstat( from, &st ) == -1 )
+	{
+	  int ret = errno;
+	  closeFd( from );
+	  return ret;
+	}
+
+	// Like cp refuse to copy a file onto itself (or a hardlink of it),
+	// as opening the destination would truncate the source.
+	struct stat dst;
+	if ( ::stat( dest_r.c_str(), &dst ) == 0 && dst.st_dev == st.st_dev && dst.st_ino == st.st_ino )
+	{
+	  closeFd( from );
+	  return EINVAL;
+	}
+
+	if ( removeDestination_r && ::unlink( dest_r.c_str() ) == -1 && errno != ENOENT )
+	{
+	  int ret = errno;
+	  closeFd( from );
+	  return ret;
+	}
+
+	int to = ::open( dest_r.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777 );
+	if ( to == -1 )
+	{
+	  int ret = errno;
+	  closeFd( from );
+	  return ret;
+	}
+
+	int ret = copyFileData( from, to );
+	closeFd( from );
+	int cret = closeFd( to );
+	return ret ? ret : cret;
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class CopyTree
+      /// \brief Like 'cp -dR src dest' for a single directory entry.
+      ///
+      /// Directories are copied recursively, symlinks are not followed
+      /// but recreated, hardlinks within the tree are preserved and special
+      /// files are recreated. Existing directories are merged and existing
+      /// files overwritten. Like cp we continue after an error, but return
+      /// the first errno encountered.
+      ///////////////////////////////////////////////////////////////////
+      class CopyTree
+      {
+      public:
+	/** Copy \a src_r to \a dest_r. */
+	int operator()( const Pathname & src_r, const Pathname & dest_r )
+	{
+	  copyEntry( src_r, dest_r );
+	  return _error;
+	}
+
+	/** Copy the content of directory \a src_r into the existing directory \a dest_r. */
+	int content( const Pathname & src_r, const Pathname & dest_r )
+	{
+	  rememberDestRoot( dest_r );
+	  copyEntries( src_r, dest_r );
+	  return _error;
+	}
+
+      private:
+	int remember( int errno_r, const Pathname & path_r )
+	{
+	  if ( errno_r )
+	  {
+	    WAR << "copy " << path_r << ": " << str::strerror( errno_r ) << endl;
+	    if ( ! _error )
+	      _error = errno_r;
+	  }
+	  return errno_r;
+	}
+
+	int copyEntry( const Pathname & src_r, const Pathname & dest_r )
+	{
+	  struct stat st;
+	  if ( ::lstat( src_r.c_str(), &st ) == -1 )
+	    return remember( errno, src_r );
+
+	  if ( S_ISDIR( st.st_mode ) )
+	    return copyDir( src_r, dest_r, st );
+
+	  if ( st.st_nlink > 1 )
+	  {
+	    std::pair<dev_t,ino_t> id( st.st_dev, st.st_ino );
+	    auto it = _links.find( id );
+	    if ( it != _links.end() )
+	    {
+	      if ( ::unlink( dest_r.c_str() ) == -1 && errno != ENOENT )
+		return remember( errno, dest_r );
+	      return remember( ::link( it->second.c_str(), dest_r.c_str() ) == -1 ? errno : 0, dest_r );
+	    }
+	    _links[id] = dest_r;
+	  }
+
+	  if ( S_ISREG( st.st_mode ) )
+	    return remember( copyFile( src_r, dest_r ), dest_r );
+
+	  // symlinks and special files replace an existing destination
+	  if ( ::unlink( dest_r.c_str() ) == -1 && errno != ENOENT )
+	    return remember( errno, dest_r );
+
+	  if ( S_ISLNK( st.st_mode ) )
+	  {
+	    Pathname target;
+	    int ret = readlink( src_r, target );
+	    if ( ret )
+	      return remember( ret, src_r );
+	    return remember( ::symlink( target.c_str(), dest_r.c_str() ) == -1 ? errno : 0, dest_r );
+	  }
+
+	  return remember( ::mknod( dest_r.c_str(), st.st_mode, st.st_rdev ) == -1 ? errno : 0, dest_r );
+	}
+
+	int copyDir( const Pathname & src_r, const Pathname & dest_r, const struct stat & st_r )
+	{
+	  if ( _destRoot.first == st_r.st_dev && _destRoot.second == st_r.st_ino )
+	  {
+	    // cp: cannot copy a directory into itself
+	    return remember( EINVAL, src_r );
+	  }
+
+	  bool created = true;
+	  if ( ::mkdir( dest_r.c_str(), ( st_r.st_mode & 07777 ) | S_IRWXU ) == -1 )
+	  {
+	    int ret = errno;
+	    if ( ret != EEXIST || ! PathInfo( dest_r ).isDir() )
+	      return remember( ret, dest_r );
+	    created = false;
+	  }
+
+	  if ( ! _destRoot.first && ! _destRoot.second )
+	    rememberDestRoot( dest_r );
+
+	  int ret = copyEntries( src_r, dest_r );
+
+	  // we needed write access to fill the directory
+	  if ( created && ( st_r.st_mode & S_IRWXU ) != S_IRWXU )
+	    remember( ::chmod( dest_r.c_str(), st_r.st_mode & 07777 ) == -1 ? errno : 0, dest_r );
+	  return ret;
+	}
+
+	int copyEntries( const Pathname & src_r, const Pathname & dest_r )
+	{
+	  DIR * dir = ::opendir( src_r.c_str() );
+	  if ( ! dir )
+	    return remember( errno, src_r );
+	  for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
+	  {
+	    if ( entry->d_name[0] == '.' && ( entry->d_name[1] == '\0' || ( entry->d_name[1] == '.' && entry->d_name[2] == '\0' ) ) )
+	      continue; // omitt . and ..
+	    copyEntry( src_r / entry->d_name, dest_r / entry->d_name );
+	  }
+	  ::closedir( dir );
+	  return 0;
+	}
+
+	/** Remember the topmost target directory, so we don't copy it into itself. */
+	void rememberDestRoot( const Pathname & dest_r )
+	{
+	  struct stat st;
+	  if ( ::stat( dest_r.c_str(), &st ) == 0 )
+	    _destRoot = std::make_pair( st.st_dev, st.st_ino );
+	}
+
+      private:
+	std::map<std::pair<dev_t,ino_t>,Pathname> _links;
+	std::pair<dev_t,ino_t> _destRoot = { 0, 0 };
+	int _error = 0;
+      };
+    } // namespace
+
     ///////////////////////////////////////////////////////////////////
     //
     //	METHOD NAME : PathInfo::mkdir
@@ -472,20 +747,7 @@ namespace zypp
       }
 
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        srcpath.asString().c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( CopyTree()( srcpath, destpath / srcpath.basename() ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -511,22 +773,7 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-      std::string src( srcpath.asString());
-      src += "/.";
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        src.c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( CopyTree().content( srcpath, destpath ) );
     }
 
     ///////////////////////////////////////////////////////////////////////
@@ -756,20 +1003,10 @@ namespace zypp
         return logResult( EISDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--remove-destination",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      int ret = copyFile( file, dest, /*removeDestination*/true );
+      if ( ret == 0 )
+        CheckSumCache::copied( file, dest );
+      return logResult( ret );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -924,19 +1161,10 @@ namespace zypp
         return logResult( ENOTDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      int ret = copyFile( file, dest / file.basename() );
+      if ( ret == 0 )
+        CheckSumCache::copied( file, dest / file.basename() );
+      return logResult( ret );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -976,11 +1204,15 @@ namespace zypp
       if ( ! PathInfo( file ).isFile() ) {
         return string();
       }
+      CheckSum known( CheckSumCache::lookup( file, algorithm ) );
+      if ( ! known.empty() ) {
+        return known.checksum();	// computed while downloading
+      }
       std::ifstream istr( file.asString().c_str() );
       if ( ! istr ) {
         return string();
       }
-      return Digest::digest( algorithm, istr );
+      return Digest::digest( algorithm, istr, 64 * 1024 );
     }
 
     bool is_checksum( const Pathname & file, const CheckSum &checksum )
@@ -51,6 +51,7 @@ namespace zypp
     {
       PathInfo pi( path_r );
       DBG << "+++++++++++++++ load " << pi << endl;
+      std::list<PathInfo> plugins;
       if ( pi.isDir() )
       {
 	std::list<Pathname> entries;
@@ -63,13 +64,13 @@ namespace zypp
 	{
 	  PathInfo pii( *it );
 	  if ( pii.isFile() && pii.userMayRX() )
-	    doLoad( pii );
+	    plugins.push_back( pii );
 	}
       }
       else if ( pi.isFile() )
       {
 	if ( pi.userMayRX() )
-	  doLoad( pi );
+	  plugins.push_back( pi );
 	else
 	  WAR << "Plugin file is not executable: " << pi << endl;
       }
@@ -77,20 +78,14 @@ namespace zypp
       {
 	WAR << "Plugin path is neither dir nor file: " << pi << endl;
       }
+      doLoad( plugins );
       DBG << "--------------- load " << pi << endl;
     }
 
     void send( const PluginFrame & frame_r )
     {
       DBG << "+++++++++++++++ send " << frame_r << endl;
-      for ( auto it = _scripts.begin(); it != _scripts.end(); )
-      {
-	doSend( *it, frame_r );
-	if ( it->isOpen() )
-	  ++it;
-	else
-	  it = _scripts.erase( it );
-      }
+      doSend( _scripts, frame_r );
       DBG << "--------------- send " << frame_r << endl;
     }
 
@@ -98,34 +93,72 @@ namespace zypp
     { return _scripts; }
 
   private:
-    /** Launch a plugin sending PLUGINSTART message. */
-    void doLoad( const PathInfo & pi_r )
+    /** Launch all plugins, then send them the PLUGINBEGIN message. */
+    void doLoad( const std::list<PathInfo> & plugins_r )
     {
-      MIL << "Load plugin: " << pi_r << endl;
-      try {
-	PluginScript plugin( pi_r.path() );
-	plugin.open();
+      std::list<PluginScript> started;
+      for_( it, plugins_r.begin(), plugins_r.end() )
+      {
+	MIL << "Load plugin: " << *it << endl;
+	try {
+	  PluginScript plugin( it->path() );
+	  plugin.open();
+	  started.push_back( plugin );
+	}
+	catch( const zypp::Exception & e )
+	{
+	  WAR << "Failed to load plugin " << *it << endl;
+	}
+      }
+      if ( started.empty() )
+	return;
+
+      PluginFrame frame( "PLUGINBEGIN" );
+      if ( ZConfig::instance().hasUserData() )
+	frame.setHeader( "userdata", ZConfig::instance().userData() );
 
-	PluginFrame frame( "PLUGINBEGIN" );
-	if ( ZConfig::instance().hasUserData() )
-	  frame.setHeader( "userdata", ZConfig::instance().userData() );
+      doSend( started, frame );	// removes failed plugins
+      _scripts.splice( _scripts.end(), started );
+    }
 
-	doSend( plugin, frame );	// closes on error
-	if ( plugin.isOpen() )
-	  _scripts.push_back( plugin );
+    /** Send \a frame_r to all \a scripts_r before collecting their responses.
+     * So the plugins process the frame in parallel rather than one after the
+     * other. Failing scripts are closed and removed from \a scripts_r.
+     */
+    void doSend( std::list<PluginScript> & scripts_r, const PluginFrame & frame_r )
+    {
+      for_( it, scripts_r.begin(), scripts_r.end() )
+      {
+	try {
+	  it->send( frame_r );
+	}
+	catch( const zypp::Exception & e )
+	{
+	  ZYPP_CAUGHT(e);
+	  WAR << e.asUserHistory() << endl;
+	  WAR << "Failed to send to " << *it << endl;
+	  it->close();
+	}
       }
-      catch( const zypp::Exception & e )
+
+      for ( auto it = scripts_r.begin(); it != scripts_r.end(); )
       {
-	WAR << "Failed to load plugin " << pi_r << endl;
+	if ( it->isOpen() )
+	  doReceive( *it, frame_r );	// closes on error
+
+	if ( it->isOpen() )
+	  ++it;
+	else
+	  it = scripts_r.erase( it );
       }
     }
 
-    PluginFrame doSend( PluginScript & script_r, const PluginFrame & frame_r )
+    /** Receive and check the response to \a frame_r. */
+    PluginFrame doReceive( PluginScript & script_r, const PluginFrame & frame_r )
     {
       PluginFrame ret;
 
       try {
-	script_r.send( frame_r );
 	ret = script_r.receive();
       }
       catch( const zypp::Exception & e )
@@ -26,6 +26,8 @@ namespace zypp
   /// Sent PluginFrames are distributed to all open PluginScripts and
   /// need to be receipted by sending back either \c ACK or \c _ENOMETHOD
   /// command.
+  /// A frame is written to all PluginScripts before their responses
+  /// are collected, so the plugins process it (and start up) in parallel.
   ///
   /// All PluginScripts receive an initial \c PLUGINBEGIN frame, containing
   /// a \c userdata header if \ref ZConfig::userData are defined.
@@ -16,6 +16,7 @@
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Algorithm.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Measure.h"
 #include "zypp/repo/RepoException.h"
 #include "zypp/RelCompare.h"
 
@@ -1520,6 +1521,7 @@ attremptycheckend:
          * \throw MatchException Any of the exceptions thrown by \ref PoolQuery::Impl::compile.
          */
 	PoolQueryMatcher( const shared_ptr<const PoolQuery::Impl> & query_r )
+	: _counter( "PoolQuery::execute" )
 	{
 	  query_r->compile();
 
@@ -1682,6 +1684,8 @@ attremptycheckend:
         int _status_flags;
         /** StrMatcher per attribtue. */
         AttrMatchList _attrMatchList;
+        /** Time spent from begin() until the last iterator is gone. */
+        debug::MeasureCounter _counter;
     };
     ///////////////////////////////////////////////////////////////////
 
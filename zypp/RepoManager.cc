@@ -24,8 +24,10 @@
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/Function.h"
 #include "zypp/base/Regex.h"
+#include "zypp/base/Measure.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
+#include "zypp/ContentStore.h"
 
 #include "zypp/ServiceInfo.h"
 #include "zypp/repo/RepoException.h"
@@ -33,6 +35,7 @@
 
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/CredentialManager.h"
+#include "zypp/media/ConditionalRequest.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/ManagedFile.h"
@@ -40,6 +43,7 @@
 #include "zypp/parser/RepoFileReader.h"
 #include "zypp/parser/ServiceFileReader.h"
 #include "zypp/repo/ServiceRepos.h"
+#include "zypp/repo/ConfigDirSnapshot.h"
 #include "zypp/repo/yum/Downloader.h"
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/repo/PluginServices.h"
@@ -277,6 +281,20 @@ namespace zypp
       return std::move(collector.repos);
     }
 
+    /**
+     * Reads RepoInfo's from the \a content_r of a repo \a file.
+     */
+    std::list<RepoInfo> repositories_in_file( const Pathname & file, const std::string & content_r )
+    {
+      MIL << "repo file: " << file << " (snapshot)" << endl;
+      RepoCollector collector;
+      std::istringstream str( content_r );
+      parser::RepoFileReader parser( InputStream( str, file.asString() ), bind( &RepoCollector::collect, &collector, _1 ) );
+      for ( RepoInfo & repo : collector.repos )
+	repo.setFilepath( file );
+      return std::move(collector.repos);
+    }
+
     ////////////////////////////////////////////////////////////////////////////
 
     /**
@@ -286,16 +304,30 @@ namespace zypp
      * RepoInfo's contained in that file.
      *
      * \param dir pathname of the directory to read.
+     * \param snapshot_r if not empty, root reads the files via this \ref repo::ConfigDirSnapshot.
      */
-    std::list<RepoInfo> repositories_in_dir( const Pathname &dir )
+    std::list<RepoInfo> repositories_in_dir( const Pathname &dir, const Pathname & snapshot_r = Pathname() )
     {
       MIL << "directory " << dir << endl;
       std::list<RepoInfo> repos;
       bool nonroot( geteuid() != 0 );
+      str::regex allowedRepoExt("^\\.repo(_[0-9]+)?$");
       if ( nonroot && ! PathInfo(dir).userMayRX() )
       {
 	JobReport::warning( str::FormatNAC(_("Cannot read repo directory '%1%': Permission denied")) % dir );
       }
+      else if ( ! ( nonroot || snapshot_r.empty() ) )
+      {
+	repo::ConfigDirSnapshot snapshot( dir, snapshot_r );
+	for ( const auto & file : snapshot.files() )
+	{
+	  if ( str::regex_match(file.first.extension(), allowedRepoExt) )
+	  {
+	    const std::list<RepoInfo> & tmp( repositories_in_file( file.first, file.second ) );
+	    repos.insert( repos.end(), tmp.begin(), tmp.end() );
+	  }
+	}
+      }
       else
       {
 	std::list<Pathname> entries;
@@ -305,7 +337,6 @@ namespace zypp
 	  ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
 	}
 
-	str::regex allowedRepoExt("^\\.repo(_[0-9]+)?$");
 	for ( std::list<Pathname>::const_iterator it = entries.begin(); it != entries.end(); ++it )
 	{
 	  if ( str::regex_match(it->extension(), allowedRepoExt) )
@@ -430,6 +461,74 @@ namespace zypp
     };
     ////////////////////////////////////////////////////////////////////////////
 
+    /**
+     * \short Collect the ServiceInfo's from a directory
+     *
+     * Goes trough every file in a directory and adds all
+     * ServiceInfo's contained in that file to \a services_r.
+     *
+     * \param dir pathname of the directory to read.
+     * \param services_r the set to add the services to.
+     * \param snapshot_r if not empty, root reads the files via this \ref repo::ConfigDirSnapshot.
+     */
+    void services_in_dir( const Pathname & dir, ServiceCollector::ServiceSet & services_r, const Pathname & snapshot_r = Pathname() )
+    {
+      MIL << "directory " << dir << endl;
+      if ( ! ( geteuid() != 0 || snapshot_r.empty() ) )
+      {
+	repo::ConfigDirSnapshot snapshot( dir, snapshot_r );
+	for ( const auto & file : snapshot.files() )
+	{
+	  std::istringstream str( file.second );
+	  parser::ServiceFileReader( InputStream( str, file.first.asString() ), ServiceCollector( services_r ) );
+	}
+      }
+      else
+      {
+	std::list<Pathname> entries;
+	if ( filesystem::readdir( entries, dir, false ) != 0 )
+	{
+	  // TranslatorExplanation '%s' is a pathname
+	  ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
+	}
+
+	//str::regex allowedServiceExt("^\\.service(_[0-9]+)?$");
+	for_(it, entries.begin(), entries.end() )
+	{
+	  parser::ServiceFileReader(*it, ServiceCollector(services_r));
+	}
+      }
+    }
+    ////////////////////////////////////////////////////////////////////////////
+
+    /** Whether \a service_r needs to be refreshed (i.e. its TTL has passed). */
+    bool serviceRefreshDue( const ServiceInfo & service_r, const RepoManager::RefreshServiceOptions & options_r )
+    {
+      if ( service_r.ttl() && !( options_r.testFlag( RepoManager::RefreshService_forceRefresh ) || options_r.testFlag( RepoManager::RefreshService_restoreStatus ) ) )
+      {
+	// Service defines a TTL; maybe we can re-use existing data without refresh.
+	Date lrf = service_r.lrf();
+	if ( lrf )
+	{
+	  Date now( Date::now() );
+	  if ( lrf <= now )
+	  {
+	    if ( (lrf+=service_r.ttl()) > now ) // lrf+= !
+	    {
+	      MIL << "Skip: '" << service_r.alias() << "' metadata valid until " << lrf << endl;
+	      return false;
+	    }
+	  }
+	  else
+	    WAR << "Force: '" << service_r.alias() << "' metadata last refresh in the future: " << lrf << endl;
+	}
+      }
+      return true;
+    }
+
+    /** The number of plugin service scripts \ref RepoManager::refreshServices runs concurrently. */
+    const unsigned maxConcurrentServicePlugins = 8;
+
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
@@ -464,6 +563,7 @@ namespace zypp
     knownServicesPath     = Pathname::assertprefix( root_r, ZConfig::instance().knownServicesPath() );
     pluginsPath           = Pathname::assertprefix( root_r, ZConfig::instance().pluginsPath() );
     probe                 = ZConfig::instance().repo_add_probe();
+    configSnapshot        = ZConfig::instance().repo_config_snapshot();
 
     rootDir = root_r;
   }
@@ -641,7 +741,8 @@ namespace zypp
 
     void refreshServices( const RefreshServiceOptions & options_r );
 
-    void refreshService( const std::string & alias, const RefreshServiceOptions & options_r );
+    void refreshService( const std::string & alias, const RefreshServiceOptions & options_r,
+			 const repo::ServiceRepos::PluginProcess & plugin_r = repo::ServiceRepos::PluginProcess() );
     void refreshService( const ServiceInfo & service, const RefreshServiceOptions & options_r )
     {  refreshService( service.alias(), options_r ); }
 
@@ -758,20 +859,10 @@ namespace zypp
   void RepoManager::Impl::init_knownServices()
   {
     Pathname dir = _options.knownServicesPath;
-    std::list<Pathname> entries;
     if (PathInfo(dir).isExist())
     {
-      if ( filesystem::readdir( entries, dir, false ) != 0 )
-      {
-        // TranslatorExplanation '%s' is a pathname
-        ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
-      }
-
-      //str::regex allowedServiceExt("^\\.service(_[0-9]+)?$");
-      for_(it, entries.begin(), entries.end() )
-      {
-        parser::ServiceFileReader(*it, ServiceCollector(_services));
-      }
+      Pathname snapshot( _options.configSnapshot ? _options.repoCachePath / "services.d.snapshot" : Pathname() );
+      services_in_dir( dir, _services, snapshot );
     }
 
     repo::PluginServices(_options.pluginsPath/"services", ServiceCollector(_services));
@@ -816,7 +907,8 @@ namespace zypp
     {
       std::list<std::string> repoEscAliases;
       std::list<RepoInfo> orphanedRepos;
-      for ( RepoInfo & repoInfo : repositories_in_dir(_options.knownReposPath) )
+      Pathname snapshot( _options.configSnapshot ? _options.repoCachePath / "repos.d.snapshot" : Pathname() );
+      for ( RepoInfo & repoInfo : repositories_in_dir(_options.knownReposPath, snapshot) )
       {
         // set the metadata path for the repo
         repoInfo.setMetadataPath( rawcache_path_for_repoinfo(_options, repoInfo) );
@@ -1012,6 +1104,8 @@ namespace zypp
 	repokind = probe( url, info.path() );
 
       // retrieve newstatus
+      // (asking the server for the master index only if it was modified)
+      media::ScopedConditionalRequest conditional( mediarootpath / ".validators", url );
       RepoStatus newstatus;
       switch ( repokind.toEnum() )
       {
@@ -1039,11 +1133,18 @@ namespace zypp
 	  break;
       }
 
+      if ( conditional.notModified() )
+      {
+	MIL << "server reports metadata not modified" << endl;
+	newstatus = oldstatus;
+      }
+
       // check status
       bool refresh = false;
       if ( oldstatus == newstatus )
       {
 	MIL << "repo has not changed" << endl;
+	conditional.save();	// validators are known to match the cached metadata
 	if ( policy == RefreshForced )
 	{
 	  MIL << "refresh set to forced" << endl;
@@ -1225,12 +1326,15 @@ namespace zypp
     progress.sendTo(progressfnc);
 
     filesystem::recursive_rmdir(packagescache_path_for_repoinfo(_options, info));
+    // drop whatever is no longer used by any repo
+    ContentStore::instance().clean();
     progress.toMax();
   }
 
 
   void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   {
+    debug::MeasureCounter counter( "RepoManager::buildCache" );
     assert_alias(info);
     Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
     Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
@@ -1999,46 +2103,49 @@ namespace zypp
   {
     // copy the set of services since refreshService
     // can eventually invalidate the iterator
-    ServiceSet services( serviceBegin(), serviceEnd() );
-    for_( it, services.begin(), services.end() )
+    std::vector<ServiceInfo> services;
+    for_( it, serviceBegin(), serviceEnd() )
     {
-      if ( !it->enabled() )
-        continue;
+      if ( it->enabled() && serviceRefreshDue( *it, options_r ) )
+        services.push_back( *it );
+    }
+
+    // The scripts of plugin services are started in advance (at most
+    // maxConcurrentServicePlugins at a time) and run concurrently. The
+    // services are refreshed one by one in their original order.
+    std::vector<repo::ServiceRepos::PluginProcess> plugins( services.size() );
+    unsigned next = 0;		// next service to start a plugin for
+    unsigned running = 0;	// plugins started but not yet refreshed
+    for ( unsigned i = 0; i < services.size(); ++i )
+    {
+      for ( ; next < services.size() && running < maxConcurrentServicePlugins; ++next )
+      {
+        plugins[next] = repo::ServiceRepos::startPlugin( services[next] );
+        if ( plugins[next] )
+          ++running;
+      }
+      if ( plugins[i] )
+        --running;
 
       try {
-	refreshService(*it, options_r);
+	refreshService( services[i].alias(), options_r, plugins[i] );
       }
       catch ( const repo::ServicePluginInformalException & e )
       { ;/* ignore ServicePluginInformalException */ }
+      plugins[i].reset();
     }
   }
 
-  void RepoManager::Impl::refreshService( const std::string & alias, const RefreshServiceOptions & options_r )
+  void RepoManager::Impl::refreshService( const std::string & alias, const RefreshServiceOptions & options_r,
+					  const repo::ServiceRepos::PluginProcess & plugin_r )
   {
     ServiceInfo service( getService( alias ) );
     assert_alias( service );
     assert_url( service );
     MIL << "Going to refresh service '" << service.alias() <<  "', url: " << service.url() << ", opts: " << options_r << endl;
 
-    if ( service.ttl() && !( options_r.testFlag( RefreshService_forceRefresh) || options_r.testFlag( RefreshService_restoreStatus ) ) )
-    {
-      // Service defines a TTL; maybe we can re-use existing data without refresh.
-      Date lrf = service.lrf();
-      if ( lrf )
-      {
-	Date now( Date::now() );
-	if ( lrf <= now )
-	{
-	  if ( (lrf+=service.ttl()) > now ) // lrf+= !
-	  {
-	    MIL << "Skip: '" << service.alias() << "' metadata valid until " << lrf << endl;
-	    return;
-	  }
-	}
-	else
-	  WAR << "Force: '" << service.alias() << "' metadata last refresh in the future: " << lrf << endl;
-      }
-    }
+    if ( ! serviceRefreshDue( service, options_r ) )
+      return;
 
     // NOTE: It might be necessary to modify and rewrite the service info.
     // Either when probing the type, or when adjusting the repositories
@@ -2075,7 +2182,7 @@ namespace zypp
     // and in zypper.
     std::pair<DefaultIntegral<bool,false>, repo::ServicePluginInformalException> uglyHack;
     try {
-      ServiceRepos( service, bind( &RepoCollector::collect, &collector, _1 ) );
+      ServiceRepos( service, bind( &RepoCollector::collect, &collector, _1 ), ProgressData::ReceiverFnc(), plugin_r );
     }
     catch ( const repo::ServicePluginInformalException & e )
     {
@@ -84,6 +84,11 @@ namespace zypp
     Pathname knownServicesPath;
     Pathname pluginsPath;
     bool probe;
+    /**
+     * Whether to read the files in \ref knownReposPath and \ref knownServicesPath
+     * via a snapshot file in \ref repoCachePath (see \ref repo::ConfigDirSnapshot).
+     */
+    bool configSnapshot;
     /**
      * Target distro ID to be used when refreshing repo index services.
      * Repositories not maching this ID will be skipped/removed.
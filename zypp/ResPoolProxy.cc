@@ -10,6 +10,9 @@
  *
 */
 #include <iostream>
+#include <map>
+#include <set>
+#include <vector>
 #include "zypp/base/LogTools.h"
 
 #include "zypp/base/Iterator.h"
@@ -86,7 +89,11 @@ namespace zypp
   //	CLASS NAME : ResPoolProxy::Impl
   //
   /** ResPoolProxy implementation.
-   * \todo Seedup as it is still using old index
+   *
+   * The Selectables are created on demand: \ref lookup creates just the
+   * one asked for, iterating a kind creates all Selectables of this kind.
+   * The pools ident index the Selectables are built from is shared, so it
+   * does not change if the pool does.
   */
   struct ResPoolProxy::Impl
   {
@@ -94,75 +101,145 @@ namespace zypp
     friend std::ostream & dumpOn( std::ostream & str, const Impl & obj );
 
     typedef std::unordered_map<sat::detail::IdType,ui::Selectable::Ptr> SelectableIndex;
+    typedef std::map<ResKind,std::vector<sat::detail::IdType> > IdentIndex;
     typedef ResPoolProxy::const_iterator const_iterator;
 
   public:
     Impl()
     :_pool( ResPool::instance() )
+    , _size( 0 )
     {}
 
     Impl( ResPool pool_r, const pool::PoolImpl & poolImpl_r )
     : _pool( pool_r )
+    , _id2item( poolImpl_r.id2itemPtr() )
+    , _size( 0 )
     {
-      const pool::PoolImpl::Id2ItemT & id2item( poolImpl_r.id2item() );
-      if ( ! id2item.empty() )
+      // remember the idents per kind (items with the same ident are adjacent)
+      pool::PoolImpl::Id2ItemT::const_iterator it = _id2item->begin();
+      while ( it != _id2item->end() )
       {
-        // set startpoint
-        pool::PoolImpl::Id2ItemT::const_iterator cbegin = id2item.begin();
-
-        for_( it, id2item.begin(), id2item.end() )
-        {
-          if ( it->first != cbegin->first )
-          {
-            // starting a new Selectable, create the previous one
-            ui::Selectable::Ptr p( makeSelectablePtr( cbegin, it ) );
-            _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
-            _selIndex[cbegin->first] = p;
-            // remember new startpoint
-            cbegin = it;
-          }
-        }
-        // create the final one
-        ui::Selectable::Ptr p( makeSelectablePtr( cbegin, id2item.end() ) );
-        _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
-        _selIndex[cbegin->first] = p;
+        sat::detail::IdType ident( it->first );
+        _identIndex[it->second.satSolvable().kind()].push_back( ident );
+        ++_size;
+        do {
+          ++it;
+        } while ( it != _id2item->end() && it->first == ident );
       }
     }
 
   public:
     ui::Selectable::Ptr lookup( const pool::ByIdent & ident_r ) const
-    {
-      SelectableIndex::const_iterator it( _selIndex.find( ident_r.get() ) );
-      if ( it != _selIndex.end() )
-        return it->second;
-      return ui::Selectable::Ptr();
-    }
+    { return selectable( ident_r.get() ); }
 
   public:
     bool empty() const
-    { return _selPool.empty(); }
+    { return _size == 0; }
 
     size_type size() const
-    { return _selPool.size(); }
+    { return _size; }
 
     const_iterator begin() const
-    { return make_map_value_begin( _selPool ); }
+    {
+      materialize();
+      return make_map_value_begin( _selPool );
+    }
 
     const_iterator end() const
-    { return make_map_value_end( _selPool ); }
+    {
+      materialize();
+      return make_map_value_end( _selPool );
+    }
 
   public:
     bool empty( const ResKind & kind_r ) const
-    { return( _selPool.count( kind_r ) == 0 );  }
+    { return( size( kind_r ) == 0 );  }
 
     size_type size( const ResKind & kind_r ) const
-    { return _selPool.count( kind_r ); }
+    {
+      IdentIndex::const_iterator it( _identIndex.find( kind_r ) );
+      return( it == _identIndex.end() ? 0 : it->second.size() );
+    }
 
     const_iterator byKindBegin( const ResKind & kind_r ) const
-    { return make_map_value_lower_bound( _selPool, kind_r ); }
+    {
+      materialize( kind_r );
+      return make_map_value_lower_bound( _selPool, kind_r );
+    }
 
     const_iterator byKindEnd( const ResKind & kind_r ) const
-    { return make_map_value_upper_bound( _selPool, kind_r ); }
+    {
+      materialize( kind_r );
+      return make_map_value_upper_bound( _selPool, kind_r );
+    }
+
+    std::vector<ui::Selectable::Ptr> updateCandidates( const ResKind & kind_r ) const
+    {
+      std::vector<ui::Selectable::Ptr> ret;
+      IdentIndex::const_iterator idents( _identIndex.find( kind_r ) );
+      if ( idents == _identIndex.end() )
+        return ret;
+      for_( it, idents->second.begin(), idents->second.end() )
+      {
+        // an update needs installed and available items
+        bool installed = false;
+        bool available = false;
+        std::pair<pool::PoolImpl::Id2ItemT::const_iterator,pool::PoolImpl::Id2ItemT::const_iterator> range( _id2item->equal_range( *it ) );
+        for_( item, range.first, range.second )
+        {
+          ( item->second.status().isInstalled() ? installed : available ) = true;
+        }
+        if ( ! ( installed && available ) )
+          continue;
+
+        ui::Selectable::Ptr sel( selectable( *it ) );
+        if ( sel->updateCandidateObj() )
+          ret.push_back( sel );
+      }
+      return ret;
+    }
+
+  private:
+    /** The Selectable for \a ident_r, created if not yet done. */
+    ui::Selectable::Ptr selectable( sat::detail::IdType ident_r ) const
+    {
+      SelectableIndex::const_iterator it( _selIndex.find( ident_r ) );
+      if ( it != _selIndex.end() )
+        return it->second;
+
+      ui::Selectable::Ptr ret;
+      if ( _id2item )
+      {
+        std::pair<pool::PoolImpl::Id2ItemT::const_iterator,pool::PoolImpl::Id2ItemT::const_iterator> range( _id2item->equal_range( ident_r ) );
+        if ( range.first != range.second )
+        {
+          ret = makeSelectablePtr( range.first, range.second );
+          _selIndex[ident_r] = ret;
+        }
+      }
+      return ret;
+    }
+
+    /** Create all Selectables of \a kind_r (for iteration). */
+    void materialize( const ResKind & kind_r ) const
+    {
+      if ( ! _materialized.insert( kind_r ).second )
+        return;
+      IdentIndex::const_iterator idents( _identIndex.find( kind_r ) );
+      if ( idents == _identIndex.end() )
+        return;
+      for_( it, idents->second.begin(), idents->second.end() )
+        _selPool.insert( SelectablePool::value_type( kind_r, selectable( *it ) ) );
+    }
+
+    /** Create all Selectables (for iteration). */
+    void materialize() const
+    {
+      if ( _selPool.size() == _size )
+        return;
+      for_( it, _identIndex.begin(), _identIndex.end() )
+        materialize( it->first );
+    }
 
   public:
     size_type knownRepositoriesSize() const
@@ -196,7 +273,14 @@ namespace zypp
 
   private:
     ResPool _pool;
+    shared_ptr<const pool::PoolImpl::Id2ItemT> _id2item;
+    IdentIndex _identIndex;
+    size_type _size;
+    /** The Selectables created for iteration... */
     mutable SelectablePool _selPool;
+    /** ...of these kinds. */
+    mutable std::set<ResKind> _materialized;
+    /** All Selectables created. */
     mutable SelectableIndex _selIndex;
 
   public:
@@ -299,6 +383,9 @@ namespace zypp
   ResPoolProxy::const_iterator ResPoolProxy::byKindEnd( const ResKind & kind_r ) const
   { return _pimpl->byKindEnd( kind_r ); }
 
+  std::vector<ui::Selectable::Ptr> ResPoolProxy::updateCandidates( const ResKind & kind_r ) const
+  { return _pimpl->updateCandidates( kind_r ); }
+
   ResPoolProxy::size_type ResPoolProxy::knownRepositoriesSize() const
   { return _pimpl->knownRepositoriesSize(); }
 
@@ -13,6 +13,7 @@
 #define ZYPP_RESPOOLPROXY_H
 
 #include <iosfwd>
+#include <vector>
 
 #include "zypp/base/PtrTypes.h"
 
@@ -157,6 +158,17 @@ namespace zypp
       bool hasInstalledObj() const
       { return hasInstalledObj( ResTraits<TRes>::kind ); }
 
+    /** The ui::Selectables of kind \a kind_r with an installed object and
+     * an \ref ui::Selectable::updateCandidateObj, i.e. the available updates.
+     * Only Selectables having installed and available objects are created
+     * and checked, so this is cheaper than iterating \ref byKind.
+    */
+    std::vector<ui::Selectable::Ptr> updateCandidates( const ResKind & kind_r ) const;
+
+    template<class TRes>
+      std::vector<ui::Selectable::Ptr> updateCandidates() const
+      { return updateCandidates( ResTraits<TRes>::kind ); }
+
   public:
     /** \name Save and restore state per kind of resolvable.
      * Simple version, no safety net. So don't restore or diff,
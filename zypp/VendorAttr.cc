@@ -25,6 +25,7 @@
 #include "zypp/base/LogTools.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/base/String.h"
+#include "zypp/base/SerialNumber.h"
 
 #include "zypp/PathInfo.h"
 #include "zypp/VendorAttr.h"
@@ -62,12 +63,14 @@ namespace zypp
     typedef std::unordered_map<IdString, VendorMatchEntry>	VendorMatch;
     int         _nextId = -1;
     VendorMatch _vendorMatch;
+    SerialNumber _vendorSerial;
 
     /** Reset match cache if global VendorMap was changed. */
     inline void vendorMatchIdReset()
     {
       _nextId = -1;
       _vendorMatch.clear();
+      _vendorSerial.setDirty();
     }
 
     /**
@@ -292,6 +295,9 @@ namespace zypp
   bool VendorAttr::equivalent( const PoolItem & lVendor, const PoolItem & rVendor ) const
   { return equivalent( lVendor.satSolvable().vendor(), rVendor.satSolvable().vendor() ); }
 
+  const SerialNumber & VendorAttr::serial() const
+  { return _vendorSerial; }
+
   //////////////////////////////////////////////////////////////////
 
   std::ostream & operator<<( std::ostream & str, const VendorAttr & /*obj*/ )
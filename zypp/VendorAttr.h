@@ -24,6 +24,7 @@ namespace zypp {
 //////////////////////////////////////////////////////////////////
 
   class PoolItem;
+  class SerialNumber;
   namespace sat
   {
     class Solvable;
@@ -78,6 +79,11 @@ class VendorAttr
     /** \overload using \ref PoolItem */
     bool equivalent( const PoolItem & lVendor, const PoolItem & rVendor ) const;
 
+    /** Serial number changing whenever the vendor equivalence is changed.
+     * Allows to cache results depending on \ref equivalent.
+     */
+    const SerialNumber & serial() const;
+
   private:
     VendorAttr();
     void _addVendorList( VendorList & ) const;
@@ -312,9 +312,13 @@ namespace zypp
         , updateMessagesNotify		( "single | /usr/lib/zypp/notify-message -p %p" )
         , repo_add_probe          	( false )
         , repo_refresh_delay      	( 10 )
+        , repo_config_snapshot		( false )
         , repoLabelIsAlias              ( false )
         , download_use_deltarpm   	( true )
         , download_use_deltarpm_always  ( false )
+        , download_use_content_store	( true )
+        , download_package_cache_limit	( 0 )
+        , download_package_cache_policy	( "lru" )
         , download_media_prefer_download( true )
         , download_max_concurrent_connections( 5 )
         , download_min_download_speed	( 0 )
@@ -335,6 +339,9 @@ namespace zypp
         , solver_upgradeTestcasesToKeep	( 2 )
         , solverUpgradeRemoveDroppedPackages( true )
         , apply_locks_file		( true )
+        , history_rotate_size		( 0 )
+        , history_rotate_days		( 0 )
+        , history_rotate_keep		( 0 )
         , pluginsPath			( "/usr/lib/zypp/plugins" )
       {
         MIL << "libzypp: " << VERSION << endl;
@@ -394,6 +401,10 @@ namespace zypp
                 {
                   cfg_packages_path = Pathname(value);
                 }
+                else if ( entry == "storedir" )
+                {
+                  cfg_store_path = Pathname(value);
+                }
                 else if ( entry == "configdir" )
                 {
                   cfg_config_path = Pathname(value);
@@ -410,6 +421,10 @@ namespace zypp
                 {
                   repo_add_probe = str::strToBool( value, repo_add_probe );
                 }
+                else if ( entry == "repo.config.snapshot" )
+                {
+                  repo_config_snapshot = str::strToBool( value, repo_config_snapshot );
+                }
                 else if ( entry == "repo.refresh.delay" )
                 {
                   str::strtonum(value, repo_refresh_delay);
@@ -433,6 +448,18 @@ namespace zypp
                 {
                   download_use_deltarpm_always = str::strToBool( value, download_use_deltarpm_always );
                 }
+                else if ( entry == "download.use_content_store" )
+                {
+                  download_use_content_store = str::strToBool( value, download_use_content_store );
+                }
+                else if ( entry == "download.package_cache_limit" )
+                {
+                  str::strtonum(value, download_package_cache_limit);
+                }
+                else if ( entry == "download.package_cache_policy" )
+                {
+                  download_package_cache_policy = str::toLower( value );
+                }
 		else if ( entry == "download.media_preference" )
                 {
 		  download_media_prefer_download.restoreToDefault( str::compareCI( value, "volatile" ) != 0 );
@@ -565,6 +592,18 @@ namespace zypp
                 {
                   history_log_path = Pathname(value);
                 }
+                else if ( entry == "history.rotate.size" )
+                {
+                  history_rotate_size = ByteCount( str::strtonum<ByteCount::SizeType>( value ), ByteCount::MiB );
+                }
+                else if ( entry == "history.rotate.days" )
+                {
+                  str::strtonum(value, history_rotate_days);
+                }
+                else if ( entry == "history.rotate.keep" )
+                {
+                  str::strtonum(value, history_rotate_keep);
+                }
                 else if ( entry == "credentials.global.dir" )
                 {
                   credentials_global_dir_path = Pathname(value);
@@ -612,6 +651,7 @@ namespace zypp
     Pathname cfg_metadata_path;
     Pathname cfg_solvfiles_path;
     Pathname cfg_packages_path;
+    Pathname cfg_store_path;
 
     Pathname cfg_config_path;
     Pathname cfg_known_repos_path;
@@ -628,11 +668,15 @@ namespace zypp
 
     bool	repo_add_probe;
     unsigned	repo_refresh_delay;
+    bool	repo_config_snapshot;
     LocaleSet	repoRefreshLocales;
     bool	repoLabelIsAlias;
 
     bool download_use_deltarpm;
     bool download_use_deltarpm_always;
+    bool download_use_content_store;
+    unsigned download_package_cache_limit;
+    std::string download_package_cache_policy;
     DefaultOption<bool> download_media_prefer_download;
 
     int download_max_concurrent_connections;
@@ -668,6 +712,9 @@ namespace zypp
     target::rpm::RpmInstFlags rpmInstallFlags;
 
     Pathname history_log_path;
+    ByteCount history_rotate_size;
+    unsigned history_rotate_days;
+    unsigned history_rotate_keep;
     Pathname credentials_global_dir_path;
     Pathname credentials_global_file_path;
 
@@ -906,6 +953,12 @@ namespace zypp
         ? (repoCachePath()/"packages") : _pimpl->cfg_packages_path );
   }
 
+  Pathname ZConfig::contentStorePath() const
+  {
+    return ( _pimpl->cfg_store_path.empty()
+        ? (repoCachePath()/"store") : _pimpl->cfg_store_path );
+  }
+
   ///////////////////////////////////////////////////////////////////
 
   Pathname ZConfig::configPath() const
@@ -946,6 +999,9 @@ namespace zypp
   unsigned ZConfig::repo_refresh_delay() const
   { return _pimpl->repo_refresh_delay; }
 
+  bool ZConfig::repo_config_snapshot() const
+  { return _pimpl->repo_config_snapshot; }
+
   LocaleSet ZConfig::repoRefreshLocales() const
   { return _pimpl->repoRefreshLocales.empty() ? Target::requestedLocales("") :_pimpl->repoRefreshLocales; }
 
@@ -961,6 +1017,15 @@ namespace zypp
   bool ZConfig::download_use_deltarpm_always() const
   { return download_use_deltarpm() && _pimpl->download_use_deltarpm_always; }
 
+  bool ZConfig::download_use_content_store() const
+  { return _pimpl->download_use_content_store; }
+
+  ByteCount ZConfig::download_package_cache_limit() const
+  { return ByteCount( _pimpl->download_package_cache_limit, ByteCount::MB ); }
+
+  const std::string & ZConfig::download_package_cache_policy() const
+  { return _pimpl->download_package_cache_policy; }
+
   bool ZConfig::download_media_prefer_download() const
   { return _pimpl->download_media_prefer_download; }
 
@@ -1082,6 +1147,22 @@ namespace zypp
         Pathname("/var/log/zypp/history") : _pimpl->history_log_path );
   }
 
+  ByteCount ZConfig::historyLogRotateSize() const
+  { return _pimpl->history_rotate_size; }
+
+  unsigned ZConfig::historyLogRotateDays() const
+  { return _pimpl->history_rotate_days; }
+
+  unsigned ZConfig::historyLogRotateKeep() const
+  { return _pimpl->history_rotate_keep; }
+
+  void ZConfig::setHistoryLogRotate( ByteCount size_r, unsigned days_r, unsigned keep_r )
+  {
+    _pimpl->history_rotate_size = size_r;
+    _pimpl->history_rotate_days = days_r;
+    _pimpl->history_rotate_keep = keep_r;
+  }
+
   Pathname ZConfig::credentialsGlobalDir() const
   {
     return ( _pimpl->credentials_global_dir_path.empty() ?
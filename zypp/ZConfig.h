@@ -21,6 +21,7 @@
 #include "zypp/base/PtrTypes.h"
 
 #include "zypp/Arch.h"
+#include "zypp/ByteCount.h"
 #include "zypp/Locale.h"
 #include "zypp/Pathname.h"
 #include "zypp/IdString.h"
@@ -152,6 +153,13 @@ namespace zypp
       */
       Pathname repoPackagesPath() const;
 
+      /**
+       * Path of the content addressed store shared by all repos and roots (repoCachePath()/store).
+       * \see \ref ContentStore
+        * \ingroup g_ZC_REPOCACHE
+      */
+      Pathname contentStorePath() const;
+
       /**
        * Path where the configfiles are kept (/etc/zypp).
        * \ingroup g_ZC_CONFIGFILES
@@ -182,6 +190,13 @@ namespace zypp
        */
       unsigned repo_refresh_delay() const;
 
+      /**
+       * Whether the content of the repo and service files is kept in a snapshot.
+       / config option
+       * repo.config.snapshot
+       */
+      bool repo_config_snapshot() const;
+
       /**
        * List of locales for which translated package descriptions should be downloaded.
        */
@@ -241,6 +256,22 @@ namespace zypp
        */
       bool download_use_deltarpm_always() const;
 
+      /** Whether to keep downloaded files in the \ref ContentStore and look there before downloading.
+       * Config option <tt>download.use_content_store (true)</tt>
+       */
+      bool download_use_content_store() const;
+
+      /** Size limit of the package cache (0 means unlimited).
+       * Config option <tt>download.package_cache_limit (0)</tt> in MB
+       * \see \ref repo::PackageCache
+       */
+      ByteCount download_package_cache_limit() const;
+
+      /** Which packages to evict first if the package cache is full, \c lru or \c lfu.
+       * Config option <tt>download.package_cache_policy (lru)</tt>
+       */
+      const std::string & download_package_cache_policy() const;
+
       /**
        * Hint which media to prefer when installing packages (download vs. CD).
        * \see class \ref media::MediaPriority
@@ -429,6 +460,30 @@ namespace zypp
        */
       Pathname historyLogFile() const;
 
+      /**
+       * Rotate the history log if it exceeds this size (0 = never).
+       * \see \ref HistoryLog
+       */
+      ByteCount historyLogRotateSize() const;
+
+      /**
+       * Rotate the history log if its first record is older than this number of days (0 = never).
+       * \see \ref HistoryLog
+       */
+      unsigned historyLogRotateDays() const;
+
+      /**
+       * Number of rotated history logs to keep (0 = keep all).
+       * \see \ref HistoryLog
+       */
+      unsigned historyLogRotateKeep() const;
+
+      /**
+       * Set \ref historyLogRotateSize, \ref historyLogRotateDays and
+       * \ref historyLogRotateKeep to specific values.
+       */
+      void setHistoryLogRotate( ByteCount size_r, unsigned days_r, unsigned keep_r );
+
       /**
        * Defaults to /etc/zypp/credentials.d
        */
@@ -14,11 +14,15 @@ extern "C"
 #include <sys/times.h>
 #include <unistd.h>
 }
+#include <cstdlib>
 #include <iostream>
+#include <fstream>
+#include <map>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/Measure.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Json.h"
 
 using std::endl;
 
@@ -236,6 +240,138 @@ namespace zypp
     void Measure::stop()
     { _pimpl.reset(); }
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef std::chrono::microseconds Usec;
+
+      /** The aggregated data of a \ref MeasureCounter. */
+      struct Counter
+      {
+	/** Histogram bucket \c i counts times less than <tt>2^i us</tt> (last one open). */
+	static const unsigned buckets = 32;
+
+	Counter()
+	: _count( 0 )
+	, _total( 0 )
+	, _max( 0 )
+	, _histogram( buckets, 0 )
+	{}
+
+	void add( Usec elapsed_r )
+	{
+	  ++_count;
+	  _total += elapsed_r;
+	  if ( elapsed_r > _max )
+	    _max = elapsed_r;
+
+	  unsigned bucket = 0;
+	  for ( Usec::rep limit = 1; bucket < buckets-1 && elapsed_r.count() >= limit; limit <<= 1 )
+	    ++bucket;
+	  ++_histogram[bucket];
+	}
+
+	json::Object asJSON() const
+	{
+	  json::Array histogram;
+	  for ( unsigned bucket = 0; bucket < buckets; ++bucket )
+	  {
+	    if ( _histogram[bucket] )
+	      histogram.add( json::Array{ (1ULL << bucket), _histogram[bucket] } );
+	  }
+	  return json::Object {
+	    { "count",		_count },
+	    { "total_us",	static_cast<unsigned long long>( _total.count() ) },
+	    { "max_us",		static_cast<unsigned long long>( _max.count() ) },
+	    { "histogram_us",	histogram }
+	  };
+	}
+
+	unsigned long long _count;
+	Usec _total;
+	Usec _max;
+	std::vector<unsigned long long> _histogram;
+      };
+
+      /** The process wide registry of counters, optionally dumped at exit. */
+      struct CounterRegistry
+      {
+	CounterRegistry()
+	{
+	  const char * env = ::getenv( "ZYPP_PROFILING" );
+	  _enabled = env;
+	  if ( env && *env == '/' )
+	    _dumpFile = env;
+	}
+
+	~CounterRegistry()
+	{
+	  if ( ! _dumpFile.empty() )
+	  {
+	    std::ofstream out( _dumpFile.c_str() );
+	    dumpJSONOn( out ) << endl;
+	  }
+	}
+
+	std::ostream & dumpJSONOn( std::ostream & str ) const
+	{
+	  json::Object ret;
+	  for ( const auto & counter : _counters )
+	    ret.add( counter.first, counter.second.asJSON() );
+	  return str << ret;
+	}
+
+	bool _enabled;
+	std::string _dumpFile;
+	std::map<std::string,Counter> _counters;
+      };
+
+      inline CounterRegistry & counterRegistry()
+      {
+	static CounterRegistry _registry;
+	return _registry;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : MeasureCounter
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    MeasureCounter::MeasureCounter( const char * ident_r )
+    : _ident( nullptr )
+    {
+      if ( enabled() )
+      {
+	_ident = ident_r;
+	_start = std::chrono::steady_clock::now();
+      }
+    }
+
+    MeasureCounter::~MeasureCounter()
+    { stop(); }
+
+    void MeasureCounter::stop()
+    {
+      if ( _ident )
+      {
+	Usec elapsed( std::chrono::duration_cast<Usec>( std::chrono::steady_clock::now() - _start ) );
+	counterRegistry()._counters[_ident].add( elapsed );
+	_ident = nullptr;
+      }
+    }
+
+    bool MeasureCounter::enabled()
+    { return counterRegistry()._enabled; }
+
+    std::ostream & MeasureCounter::dumpJSONOn( std::ostream & str )
+    { return counterRegistry().dumpJSONOn( str ); }
+
+    void MeasureCounter::reset()
+    { counterRegistry()._counters.clear(); }
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
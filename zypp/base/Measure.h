@@ -14,8 +14,10 @@
 
 #include <iosfwd>
 #include <string>
+#include <chrono>
 
 #include "zypp/base/PtrTypes.h"
+#include "zypp/base/NonCopyable.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -114,6 +116,70 @@ namespace zypp
     };
     ///////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class MeasureCounter
+    /// \brief Aggregate the time spent in named operations.
+    ///
+    /// Unlike \ref Measure, which logs each elapsed time, a MeasureCounter
+    /// adds the real time elapsed during its lifetime to a process wide
+    /// counter named \c ident_r. Per name the number of calls, the cumulated
+    /// and the maximal time, and a histogram (power of 2 microsecond buckets)
+    /// are maintained.
+    ///
+    /// Counting is enabled if the environment variable \c ZYPP_PROFILING is
+    /// set, otherwise a MeasureCounter does nothing. If \c ZYPP_PROFILING
+    /// contains an absolute path, the counters are written to this file
+    /// as JSON at exit. Use \ref dumpJSONOn to get them on demand.
+    ///
+    /// \code
+    /// void PoolImpl::prepare() const
+    /// {
+    ///   debug::MeasureCounter counter( "sat::Pool::prepare" );
+    ///   ...
+    /// }
+    ///
+    /// // {
+    /// // "sat::Pool::prepare": {
+    /// // "count": 12,
+    /// // "histogram_us": [[1, 9], [16384, 2], [131072, 1]],
+    /// // "max_us": 97134,
+    /// // "total_us": 110281
+    /// // }
+    /// // }
+    /// \endcode
+    ///
+    /// \note Like the rest of libzypp, counting is not thread safe.
+    ///////////////////////////////////////////////////////////////////
+    class MeasureCounter : private base::NonCopyable
+    {
+    public:
+      /** Ctor starts timing an operation to be counted as \a ident_r.
+       * \a ident_r must be a string literal (it is not copied).
+       */
+      explicit MeasureCounter( const char * ident_r );
+
+      /** Dtor adds the elapsed time to the counter. */
+      ~MeasureCounter();
+
+      /** Stop timing early (the dtor will not count it again). */
+      void stop();
+
+    public:
+      /** Whether counting is enabled (\c ZYPP_PROFILING is set). */
+      static bool enabled();
+
+      /** Write all counters as JSON object to \a str. */
+      static std::ostream & dumpJSONOn( std::ostream & str );
+
+      /** Clear all counters. */
+      static void reset();
+
+    private:
+      const char * _ident;
+      std::chrono::steady_clock::time_point _start;
+    };
+    ///////////////////////////////////////////////////////////////////
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
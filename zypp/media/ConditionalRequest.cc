@@ -0,0 +1,161 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/ConditionalRequest.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/media/ConditionalRequest.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      ScopedConditionalRequest * _current = nullptr;
+
+      /** The map key for \a filename_r */
+      inline std::string key( const Pathname & filename_r )
+      { return filename_r.absolutename().asString(); }
+
+      /** The url the validators belong to (no password or query). */
+      inline std::string urlKey( const Url & url_r )
+      { return url_r.asString( url_r.getViewOptions() - url::ViewOption::WITH_QUERY_STR ); }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    std::string CacheValidators::ifRange() const
+    {
+      // weak etags must not be used in If-Range (RFC 7233)
+      if ( ! etag.empty() && ! str::hasPrefix( etag, "W/" ) )
+	return etag;
+      return lastModified;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const CacheValidators & obj )
+    { return str << "{etag:" << obj.etag << ",last-modified:" << obj.lastModified << "}"; }
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	The file format:
+    //	  url <url>
+    //	  <filename>|<etag>|<last-modified>
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    ScopedConditionalRequest::ScopedConditionalRequest( const Pathname & file_r, const Url & url_r )
+    : _file( file_r )
+    , _url( url_r )
+    , _outer( _current )
+    {
+      _current = this;
+
+      if ( ! PathInfo( _file ).isFile() )
+	return;
+
+      InputStream in( _file );
+      iostr::EachLine line( in );
+      if ( ! line || *line != "url " + urlKey( _url ) )
+      {
+	MIL << "Ignore validators not received from " << urlKey( _url ) << endl;
+	return;
+      }
+      for ( line.next(); line; line.next() )
+      {
+	std::vector<std::string> words;
+	if ( str::splitFields( *line, std::back_inserter(words), "|" ) != 3 )
+	  continue;
+	CacheValidators & validators( _known[words[0]] );
+	validators.etag = words[1];
+	validators.lastModified = words[2];
+      }
+      DBG << "Loaded validators for " << _known.size() << " files from " << _file << endl;
+    }
+
+    ScopedConditionalRequest::~ScopedConditionalRequest()
+    { _current = _outer; }
+
+    ScopedConditionalRequest * ScopedConditionalRequest::current()
+    { return _current; }
+
+    bool ScopedConditionalRequest::notModified( const Pathname & filename_r ) const
+    { return _notModified.count( key( filename_r ) ); }
+
+    bool ScopedConditionalRequest::notModified() const
+    { return ! _replied.empty() && _notModified.size() == _replied.size(); }
+
+    CacheValidators ScopedConditionalRequest::request( const Pathname & filename_r ) const
+    {
+      auto it = _known.find( key( filename_r ) );
+      return it == _known.end() ? CacheValidators() : it->second;
+    }
+
+    void ScopedConditionalRequest::reply( const Pathname & filename_r, const CacheValidators & validators_r, bool notModified_r )
+    {
+      std::string k( key( filename_r ) );
+      _replied.insert( k );
+      CacheValidators & received( _received[k] );
+      received = validators_r;
+      if ( notModified_r )
+      {
+	_notModified.insert( k );
+	// a 304 need not repeat all validators
+	const CacheValidators & sent( request( filename_r ) );
+	if ( received.etag.empty() )
+	  received.etag = sent.etag;
+	if ( received.lastModified.empty() )
+	  received.lastModified = sent.lastModified;
+      }
+      else
+	_notModified.erase( k );
+
+      if ( received.empty() )
+	_received.erase( k );
+      DBG << k << (notModified_r ? " not modified " : " ") << validators_r << endl;
+    }
+
+    void ScopedConditionalRequest::save() const
+    {
+      if ( _received.empty() )
+      {
+	filesystem::unlink( _file );
+	return;
+      }
+
+      std::ofstream out( _file.c_str() );
+      out << "url " << urlKey( _url ) << endl;
+      for ( const auto & el : _received )
+      {
+	// values come from the wire; don't let them break the format
+	if ( el.second.etag.find_first_of( "|\n" ) != std::string::npos
+	  || el.second.lastModified.find_first_of( "|\n" ) != std::string::npos )
+	  continue;
+	out << el.first << "|" << el.second.etag << "|" << el.second.lastModified << endl;
+      }
+      if ( ! out )
+	WAR << "Can't write " << _file << endl;
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
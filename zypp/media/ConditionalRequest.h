@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/ConditionalRequest.h
+ *
+*/
+#ifndef ZYPP_MEDIA_CONDITIONALREQUEST_H
+#define ZYPP_MEDIA_CONDITIONALREQUEST_H
+
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class CacheValidators
+    /// \brief HTTP cache validators (\c ETag, \c Last-Modified) of a file.
+    ///////////////////////////////////////////////////////////////////
+    struct CacheValidators
+    {
+      std::string etag;
+      std::string lastModified;
+
+      bool empty() const
+      { return etag.empty() && lastModified.empty(); }
+
+      /** The validator to send as \c If-Range: a strong \c etag, else \c lastModified. */
+      std::string ifRange() const;
+    };
+
+    /** \relates CacheValidators Stream output */
+    std::ostream & operator<<( std::ostream & str, const CacheValidators & obj );
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class ScopedConditionalRequest
+    /// \brief Send conditional HTTP requests for downloads in the current scope.
+    ///
+    /// While an instance is in scope, \ref MediaCurl sends \c If-None-Match
+    /// and \c If-Modified-Since built from the validators known for the
+    /// requested file, and remembers the validators it receives. A
+    /// <tt>304 Not Modified</tt> reply transfers no data and leaves the
+    /// local file untouched (i.e. usually not created at all); the caller
+    /// learns about it via \ref notModified.
+    ///
+    /// Validators are loaded from and \ref save d to \a file_r. They are
+    /// only used if they were received from the same \a url_r.
+    ///
+    /// \code
+    ///   media::ScopedConditionalRequest conditional( cachedir/".validators", url );
+    ///   Pathname file( media.provideFile( "repodata/repomd.xml" ) );
+    ///   if ( conditional.notModified( "repodata/repomd.xml" ) )
+    ///     file = cachedir/"repodata/repomd.xml";	// use the cached copy
+    ///   ...
+    ///   conditional.save();	// if the cached copy was verified to be up to date
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class ScopedConditionalRequest : private base::NonCopyable
+    {
+    public:
+      /** Ctor loading the validators remembered in \a file_r for \a url_r. */
+      ScopedConditionalRequest( const Pathname & file_r, const Url & url_r );
+
+      /** Dtor */
+      ~ScopedConditionalRequest();
+
+      /** Whether the server replied <tt>304 Not Modified</tt> for \a filename_r. */
+      bool notModified( const Pathname & filename_r ) const;
+
+      /** Whether there were replies in this scope and all of them were <tt>304 Not Modified</tt>. */
+      bool notModified() const;
+
+      /** Write the validators received (or confirmed) in this scope to \a file_r. */
+      void save() const;
+
+    public:
+      /** The innermost instance in scope or \c nullptr. */
+      static ScopedConditionalRequest * current();
+
+      /** Validators to send for \a filename_r (relative to the media url). */
+      CacheValidators request( const Pathname & filename_r ) const;
+
+      /** Remember the reply for \a filename_r. */
+      void reply( const Pathname & filename_r, const CacheValidators & validators_r, bool notModified_r );
+
+    private:
+      Pathname _file;
+      Url _url;
+      std::map<std::string,CacheValidators> _known;
+      std::map<std::string,CacheValidators> _received;
+      std::set<std::string> _replied;
+      std::set<std::string> _notModified;
+      ScopedConditionalRequest * _outer;
+    };
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_CONDITIONALREQUEST_H
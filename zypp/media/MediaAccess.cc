@@ -356,6 +356,26 @@ MediaAccess::setDeltafile( const Pathname & filename ) const
   _handler->setDeltafile( filename );
 }
 
+void
+MediaAccess::setCachePaths( const std::vector<Pathname> & cachePaths ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("setCachePaths"));
+  }
+
+  _handler->setCachePaths( cachePaths );
+}
+
+void
+MediaAccess::precacheFiles( const std::vector<Pathname> & filenames ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("precacheFiles()"));
+  }
+
+  _handler->precacheFiles( filenames );
+}
+
 void
 MediaAccess::releaseFile( const Pathname & filename ) const
 {
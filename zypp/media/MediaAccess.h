@@ -16,6 +16,7 @@
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "zypp/base/ReferenceCounted.h"
 #include "zypp/base/NonCopyable.h"
@@ -279,6 +280,18 @@ namespace zypp {
 	 */
 	void setDeltafile( const Pathname & filename ) const;
 
+	/**
+	 * set the local cache directories to use in the next download
+	 * \see MediaHandler::setCachePaths
+	 */
+	void setCachePaths( const std::vector<Pathname> & cachePaths ) const;
+
+	/**
+	 * hint that \a filenames are going to be provided next
+	 * \see MediaHandler::precacheFiles
+	 */
+	void precacheFiles( const std::vector<Pathname> & filenames ) const;
+
     public:
 
 	/**
@@ -15,8 +15,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <expat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -145,6 +149,24 @@ MediaBlockList::updateRsum(unsigned int rs, const char* bytes, size_t len) const
   unsigned short s, m;
   s = (rs >> 16) & 65535;
   m = rs & 65535;
+#ifdef __SSE2__
+  // 16 bytes at once: s gets their sum, m additionally 16 * s plus the
+  // bytes weighted by the number of steps they stay in the sum
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wlo = _mm_set_epi16(9, 10, 11, 12, 13, 14, 15, 16);
+  const __m128i whi = _mm_set_epi16(1, 2, 3, 4, 5, 6, 7, 8);
+  for (; len >= 16; len -= 16, bytes += 16)
+    {
+      __m128i v = _mm_loadu_si128((const __m128i *)bytes);
+      __m128i sum = _mm_sad_epu8(v, zero);
+      __m128i w = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), wlo),
+				_mm_madd_epi16(_mm_unpackhi_epi8(v, zero), whi));
+      w = _mm_add_epi32(w, _mm_srli_si128(w, 8));
+      w = _mm_add_epi32(w, _mm_srli_si128(w, 4));
+      m += 16 * s + _mm_cvtsi128_si32(w);
+      s += _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+    }
+#endif
   for (; len > 0 ; len--)
     {
       unsigned short c = (unsigned char)*bytes++;
@@ -154,6 +176,54 @@ MediaBlockList::updateRsum(unsigned int rs, const char* bytes, size_t len) const
   return (s & 65535) << 16 | (m & 65535);
 }
 
+// roll the window sums a and b over n positions. in are the bytes entering
+// the window, out the ones leaving it (i.e. in - blksize). the (masked)
+// rsum of every position is stored in rs.
+static void
+rollRsums(const unsigned char *out, const unsigned char *in, size_t n, size_t blksize, unsigned short &a, unsigned short &b, unsigned int *rs, unsigned int rmask)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  // 8 positions at once: the sums are prefix sums over the byte
+  // differences, all modulo 65536 like the 16 bit lanes.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bs = _mm_set1_epi16((short)blksize);
+  const __m128i mask = _mm_set1_epi32(rmask);
+  __m128i av = _mm_set1_epi16(a);
+  __m128i bv = _mm_set1_epi16(b);
+  for (; i + 8 <= n; i += 8)
+    {
+      __m128i o = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(out + i)), zero);
+      __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(in + i)), zero);
+      __m128i d = _mm_sub_epi16(c, o);
+      d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+      d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+      d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+      av = _mm_add_epi16(av, d);
+      __m128i e = _mm_sub_epi16(av, _mm_mullo_epi16(o, bs));
+      e = _mm_add_epi16(e, _mm_slli_si128(e, 2));
+      e = _mm_add_epi16(e, _mm_slli_si128(e, 4));
+      e = _mm_add_epi16(e, _mm_slli_si128(e, 8));
+      bv = _mm_add_epi16(bv, e);
+      _mm_storeu_si128((__m128i *)(rs + i), _mm_and_si128(_mm_unpacklo_epi16(bv, av), mask));
+      _mm_storeu_si128((__m128i *)(rs + i + 4), _mm_and_si128(_mm_unpackhi_epi16(bv, av), mask));
+      // continue with the sums of the last position
+      av = _mm_shufflehi_epi16(av, 0xff);
+      av = _mm_unpackhi_epi64(av, av);
+      bv = _mm_shufflehi_epi16(bv, 0xff);
+      bv = _mm_unpackhi_epi64(bv, bv);
+    }
+  a = _mm_extract_epi16(av, 0);
+  b = _mm_extract_epi16(bv, 0);
+#endif
+  for (; i < n; i++)
+    {
+      a += in[i] - out[i];
+      b += a - out[i] * blksize;
+      rs[i] = ((unsigned int)a << 16 | b) & rmask;
+    }
+}
+
 bool
 MediaBlockList::verifyRsum(size_t blkno, unsigned int rs) const
 {
@@ -205,25 +275,6 @@ MediaBlockList::checkChecksum(size_t blkno, const unsigned char *buf, size_t buf
   return verifyDigest(blkno, dig);
 }
 
-// specialized version of checkChecksum that can deal with a "rotated" buffer
-bool
-MediaBlockList::checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const
-{
-  if (blkno >= blocks.size() || bufl < blocks[blkno].size)
-    return false;
-  if (start == bufl)
-    start = 0;
-  Digest dig;
-  if (!createDigest(dig))
-    return false;
-  size_t size = blocks[blkno].size;
-  size_t len = bufl - start > size ? size : bufl - start;
-  dig.update((const char *)buf + start, len);
-  if (size > len)
-    dig.update((const char *)buf, size - len);
-  return verifyDigest(blkno, dig);
-}
-
 // write block to the file. can also deal with "rotated" buffers
 void
 MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, vector<bool> &found) const
@@ -245,56 +296,75 @@ MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, siz
   found[blocks.size()] = true;
 }
 
-static size_t
-fetchnext(FILE *fp, unsigned char *bp, size_t blksize, size_t pushback, unsigned char *pushbackp)
-{
-  size_t l = blksize;
-  int c;
+namespace {
+  // the bytes scanRsums looks at: the ones given back first, then the file
+  class ScanInput
+  {
+  public:
+    ScanInput(FILE *fp)
+      : _fp(fp), _backp(0)
+    {}
 
-  if (pushback)
+    // read up to len bytes, less only at the end of the file
+    size_t read(unsigned char *bp, size_t len)
     {
-      if (pushbackp != bp)
-        memmove(bp, pushbackp, pushback);
-      bp += pushback;
-      l -= pushback;
+      size_t l = 0;
+      if (_backp < _back.size())
+	{
+	  l = std::min(len, _back.size() - _backp);
+	  memcpy(bp, &_back[_backp], l);
+	  _backp += l;
+	}
+      if (l < len)
+	l += fread(bp + l, 1, len - l, _fp);
+      return l;
     }
-  while (l)
+
+    // make bp the next bytes to read
+    void unread(const unsigned char *bp, size_t len)
     {
-      c = getc(fp);
-      if (c == EOF)
-        break;
-      *bp++ = c;
-      l--;
+      _back.erase(_back.begin(), _back.begin() + _backp);
+      _back.insert(_back.begin(), bp, bp + len);
+      _backp = 0;
     }
-  if (l)
-    memset(bp, 0, l);
-  return blksize - l;
-}
 
+  private:
+    FILE *_fp;
+    vector<unsigned char> _back;
+    size_t _backp;
+  };
+}
 
 void
 MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 {
-  FILE *fp;
+  reuseBlocks(wfp, vector<string>(1, filename));
+}
 
-  if (!chksumlen || (fp = fopen(filename.c_str(), "r")) == 0)
+void
+MediaBlockList::reuseBlocks(FILE *wfp, const vector<string> &filenames)
+{
+  if (!chksumlen || blocks.empty())
     return;
   size_t nblks = blocks.size();
   vector<bool> found;
   found.resize(nblks + 1);
+  size_t blksize = 0;
+  unsigned int hm = 0;
+  unsigned int *ht = 0;
   if (rsumlen && !rsums.empty())
     {
-      size_t blksize = blocks[0].size;
+      blksize = blocks[0].size;
       if (nblks == 1 && rsumpad && rsumpad > blksize)
 	blksize = rsumpad;
-      // create hash of checksums
-      unsigned int hm = rsums.size() * 2;
+      // create hash of checksums, shared by all files we scan
+      hm = rsums.size() * 2;
       while (hm & (hm - 1))
 	hm &= hm - 1;
       hm = hm * 2 - 1;
       if (hm < 16383)
 	hm = 16383;
-      unsigned int *ht = new unsigned int[hm + 1];
+      ht = new unsigned int[hm + 1];
       memset(ht, 0, (hm + 1) * sizeof(unsigned int));
       for (unsigned int i = 0; i < rsums.size(); i++)
 	{
@@ -307,67 +377,137 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	    h = (h + hh++) & hm;
 	  ht[h] = i + 1;
 	}
+    }
+  else if (chksumlen < 16)
+    return;
+
+  for (vector<string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+    {
+      FILE *fp = fopen(it->c_str(), "re");
+      if (!fp)
+	continue;
+      if (ht)
+	scanRsums(wfp, fp, ht, hm, blksize, found);
+      else
+	scanChecksums(wfp, fp, found);
+      fclose(fp);
+      if (std::find(found.begin(), found.begin() + nblks, false) == found.begin() + nblks)
+	break;	// nothing left to look for
+    }
+  delete[] ht;
+
+  if (!found[nblks])
+    return;
+  // now throw out all of the blocks we found
+  std::vector<MediaBlock> nblocks;
+  std::vector<unsigned char> nchksums;
+  std::vector<unsigned int> nrsums;
 
-      unsigned char *buf = new unsigned char[blksize];
-      unsigned char *buf2 = new unsigned char[blksize];
-      size_t pushback = 0;
-      unsigned char *pushbackp = 0;
-      int bshift = 0;
-      if ((blksize & (blksize - 1)) == 0)
-	for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
-	  ;
-      unsigned short a, b;
-      a = b = 0;
-      memset(buf, 0, blksize);
-      bool eof = 0;
-      bool init = 1;
-      int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
-      while (!eof)
+  for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
+    {
+      if (!found[blkno])
 	{
-	  for (size_t i = 0; i < blksize; i++)
+	  // still need it
+	  nblocks.push_back(blocks[blkno]);
+	  if (chksumlen && (blkno + 1) * chksumlen <= chksums.size())
 	    {
-	      int c;
-	      if (eof)
-		c = 0;
-	      else
-		{
-		   if (pushback)
-		    {
-		      c = *pushbackp++;
-		      pushback--;
-		    }
-		  else
-		    c = getc(fp);
-		  if (c == EOF)
-		    {
-		      eof = true;
-		      c = 0;
-		      if (!i || sql == 2)
-			break;
-		    }
-		}
-	      int oc = buf[i];
-	      buf[i] = c;
-	      a += c - oc;
-	      if (bshift)
-		b += a - (oc << bshift);
-	      else
-		b += a - oc * blksize;
-	      if (init)
-		{
-		  if (size_t(i) != blksize - 1)
-		    continue;
-		  init = 0;
-		}
-	      unsigned int r;
-	      if (rsumlen == 1)
-		r = ((unsigned int)b & 255);
-	      else if (rsumlen == 2)
-		r = ((unsigned int)b & 65535);
-	      else if (rsumlen == 3)
-		r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
-	      else
-		r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
+	      nchksums.resize(nblocks.size() * chksumlen);
+	      memcpy(&nchksums[(nblocks.size() - 1) * chksumlen], &chksums[blkno * chksumlen], chksumlen);
+	    }
+	  if (rsumlen && (blkno + 1) <= rsums.size())
+	    nrsums.push_back(rsums[blkno]);
+	}
+    }
+  blocks = nblocks;
+  chksums = nchksums;
+  rsums = nrsums;
+}
+
+// scan a file for blocks at any offset, using the rsum hash table ht
+void
+MediaBlockList::scanRsums(FILE *wfp, FILE *fp, const unsigned int *ht, unsigned int hm, size_t blksize, vector<bool> &found) const
+{
+  size_t nblks = blocks.size();
+  int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
+  unsigned int rmask = rsumlen >= 4 ? 0xffffffff : (1U << (8 * rsumlen)) - 1;
+
+  // quick reject of most positions without touching the hash table: a
+  // bitmap with (about) 32 bits per rsum, indexed by a hash of the rsum
+  int fbits = 16;
+  while (fbits < 28 && (size_t(1) << fbits) < 32 * rsums.size())
+    fbits++;
+  vector<unsigned char> filter((size_t(1) << fbits) / 8);
+  for (unsigned int h = 0; h <= hm; h++)
+    if (ht[h])
+      {
+	unsigned int f = (rsums[ht[h] - 1] * 0x9e3779b1U) >> (32 - fbits);
+	filter[f >> 3] |= 1 << (f & 7);
+      }
+
+  // buf holds the current window followed by the data to scan (plus
+  // room for the zero padding at the end of the file)
+  size_t chunk = std::max(size_t(1 << 18), 4 * blksize);
+  vector<unsigned char> bufv(blksize + chunk + blksize);
+  unsigned char *buf = &bufv[0];
+  unsigned char *data = buf + blksize;
+  vector<unsigned int> rs(chunk + blksize);
+  const size_t step = 16384;
+  vector<size_t> cand(step);
+  // the blocks following a match are verified in batches of up to maxbatch
+  size_t maxbatch = chunk / blksize * blksize;
+  vector<unsigned char> bufn(maxbatch + blksize);
+  unsigned char *buf2 = &bufn[0];
+
+  ScanInput in(fp);
+  unsigned short a = 0, b = 0;
+  size_t skip = blksize - 1;	// no complete window yet
+  size_t lap = 0;		// bytes scanned since the window was reset, modulo blksize
+  size_t have = 0;		// data left over from the last round
+  bool done = false;
+  while (!done)
+    {
+      size_t n = have + in.read(data + have, chunk - have);
+      size_t scan;
+      if (n == chunk)
+	scan = n - blksize;	// keep the next block to look ahead
+      else
+	{
+	  scan = n;
+	  // the last block is zero padded, unless two blocks must match
+	  if (sql == 1 && (lap + n) % blksize)
+	    {
+	      size_t pad = blksize - (lap + n) % blksize;
+	      memset(data + n, 0, pad);
+	      scan += pad;
+	    }
+	  done = true;
+	}
+      // the sums are computed in steps, a match makes the following ones useless
+      bool match = false;
+      for (size_t s0 = 0; s0 < scan && !match; s0 += step)
+	{
+	  size_t s1 = std::min(scan, s0 + step);
+	  rollRsums(buf + s0, data + s0, s1 - s0, blksize, a, b, &rs[s0], rmask);
+
+	  // collect the positions passing the filter (without a branch, as
+	  // there's no telling which ones do)
+	  size_t ncand = 0;
+	  size_t sk = std::min(skip, s1 - s0);
+	  skip -= sk;
+	  for (size_t p = s0 + sk; p < s1; p++)
+	    {
+	      unsigned int f = (rs[p] * 0x9e3779b1U) >> (32 - fbits);
+	      cand[ncand] = p;
+	      ncand += (filter[f >> 3] >> (f & 7)) & 1;
+	    }
+
+	  for (size_t c = 0; c < ncand && !match; c++)
+	    {
+	      size_t p = cand[c];
+	      unsigned int r = rs[p];
+	      const unsigned char *win = buf + p + 1;
+	      const unsigned char *next = data + p + 1;
+	      size_t nextl = p < n ? n - p - 1 : 0;
 	      unsigned int h = r & hm;
 	      unsigned int hh = 7;
 	      for (; ht[h]; h = (h + hh++) & hm)
@@ -377,112 +517,120 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 		    continue;
 		  if (found[blkno])
 		    continue;
+		  const unsigned char *win2 = next;
+		  size_t used = 0;
 		  if (sql == 2)
 		    {
-		      if (eof || blkno + 1 >= nblks)
+		      if (blkno + 1 >= nblks || !nextl)
 			continue;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			continue;
-		      if (!checkRsum(blkno + 1, buf2, blksize))
+		      used = std::min(blksize, nextl);
+		      if (used < blksize)
+			{
+			  memcpy(buf2, next, used);
+			  memset(buf2 + used, 0, blksize - used);
+			  win2 = buf2;
+			}
+		      if (!checkRsum(blkno + 1, win2, blksize))
 			continue;
 		    }
-		  if (!checkChecksumRotated(blkno, buf, blksize, i + 1))
+		  if (!checkChecksum(blkno, win, blksize))
 		    continue;
-		  if (sql == 2 && !checkChecksum(blkno + 1, buf2, blksize))
+		  if (sql == 2 && !checkChecksum(blkno + 1, win2, blksize))
 		    continue;
-		  writeBlock(blkno, wfp, buf, blksize, i + 1, found);
+		  writeBlock(blkno, wfp, win, blksize, 0, found);
 		  if (sql == 2)
 		    {
-		      writeBlock(blkno + 1, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
+		      writeBlock(blkno + 1, wfp, win2, blksize, 0, found);
 		      blkno++;
 		    }
-		  while (!eof)
+		  match = true;
+		  if (p >= n)
+		    break;		// matched the zero padding, nothing left
+		  in.unread(next + used, nextl - used);
+		  done = false;
+
+		  // the following blocks are likely to match as well. verify them
+		  // in growing batches, so a mismatch does not read too much ahead
+		  for (size_t batch = blksize; ; batch = std::min(batch * 2, maxbatch))
 		    {
-		      blkno++;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			break;
-		      if (!checkRsum(blkno, buf2, blksize))
+		      size_t l = in.read(buf2, batch);
+		      size_t off = 0;
+		      for (; off < l; off += blksize)
+			{
+			  blkno++;
+			  size_t bl = std::min(blksize, l - off);
+			  if (bl < blksize)
+			    memset(buf2 + off + bl, 0, blksize - bl);
+			  if (!checkRsum(blkno, buf2 + off, blksize))
+			    break;
+			  if (!checkChecksum(blkno, buf2 + off, blksize))
+			    break;
+			  writeBlock(blkno, wfp, buf2 + off, blksize, 0, found);
+			}
+		      if (off < l)
+			{
+			  in.unread(buf2 + off, l - off);
+			  break;
+			}
+		      if (l < batch)
 			break;
-		      if (!checkChecksum(blkno, buf2, blksize))
-			break;
-		      writeBlock(blkno, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
 		    }
-		  init = false;
-		  memset(buf, 0, blksize);
-	 	  a = b = 0;
-		  i = size_t(-1);	// start with 0 on next iteration
 		  break;
 		}
 	    }
 	}
-      delete[] buf2;
-      delete[] buf;
-      delete[] ht;
-    }
-  else if (chksumlen >= 16)
-    {
-      // dummy variant, just check the checksums
-      size_t bufl = 4096;
-      off_t off = 0;
-      unsigned char *buf = new unsigned char[bufl];
-      for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
+      if (match)
 	{
-	  if (off > blocks[blkno].off)
-	    continue;
-	  size_t blksize = blocks[blkno].size;
-	  if (blksize > bufl)
-	    {
-	      delete[] buf;
-	      bufl = blksize;
-              buf = new unsigned char[bufl];
-	    }
-	  size_t skip = blocks[blkno].off - off;
-	  while (skip)
-	    {
-	      size_t l = skip > bufl ? bufl : skip;
-	      if (fread(buf, l, 1, fp) != 1)
-		break;
-	      skip -= l;
-	      off += l;
-	    }
-	  if (fread(buf, blksize, 1, fp) != 1)
-	    break;
-	  if (checkChecksum(blkno, buf, blksize))
-	    writeBlock(blkno, wfp, buf, blksize, 0, found);
-	  off += blksize;
+	  // start over with an empty window after the blocks we found
+	  memset(buf, 0, blksize);
+	  a = b = 0;
+	  skip = 0;
+	  lap = 0;
+	  have = 0;
+	}
+      else
+	{
+	  lap = (lap + scan) % blksize;
+	  have = n - scan;
+	  memmove(buf, buf + scan, blksize + have);
 	}
     }
-  if (!found[nblks])
-    return;
-  // now throw out all of the blocks we found
-  std::vector<MediaBlock> nblocks;
-  std::vector<unsigned char> nchksums;
-  std::vector<unsigned int> nrsums;
+}
 
+// dummy variant, just check the checksums of the blocks at their offsets
+void
+MediaBlockList::scanChecksums(FILE *wfp, FILE *fp, vector<bool> &found) const
+{
+  size_t bufl = 4096;
+  off_t off = 0;
+  unsigned char *buf = new unsigned char[bufl];
   for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
     {
-      if (!found[blkno])
+      if (off > blocks[blkno].off)
+	continue;
+      size_t blksize = blocks[blkno].size;
+      if (blksize > bufl)
 	{
-	  // still need it
-	  nblocks.push_back(blocks[blkno]);
-	  if (chksumlen && (blkno + 1) * chksumlen <= chksums.size())
-	    {
-	      nchksums.resize(nblocks.size() * chksumlen);
-	      memcpy(&nchksums[(nblocks.size() - 1) * chksumlen], &chksums[blkno * chksumlen], chksumlen);
-	    }
-	  if (rsumlen && (blkno + 1) <= rsums.size())
-	    nrsums.push_back(rsums[blkno]);
+	  delete[] buf;
+	  bufl = blksize;
+	  buf = new unsigned char[bufl];
+	}
+      size_t skip = blocks[blkno].off - off;
+      while (skip)
+	{
+	  size_t l = skip > bufl ? bufl : skip;
+	  if (fread(buf, l, 1, fp) != 1)
+	    break;
+	  skip -= l;
+	  off += l;
 	}
+      if (fread(buf, blksize, 1, fp) != 1)
+	break;
+      if (checkChecksum(blkno, buf, blksize))
+	writeBlock(blkno, wfp, buf, blksize, 0, found);
+      off += blksize;
     }
-  blocks = nblocks;
-  chksums = nchksums;
-  rsums = nrsums;
+  delete[] buf;
 }
 
 std::string
@@ -14,6 +14,7 @@
 
 #include <sys/types.h>
 #include <vector>
+#include <string>
 
 #include "zypp/Digest.h"
 
@@ -114,6 +115,13 @@ public:
    **/
   void reuseBlocks(FILE *wfp, std::string filename);
 
+  /**
+   * scan several files for blocks from our blocklist, e.g. older versions
+   * of the file we are about to download. the rsum hash is built once, and
+   * scanning stops as soon as all blocks were found.
+   **/
+  void reuseBlocks(FILE *wfp, const std::vector<std::string> &filenames);
+
   /**
    * return block list as string
    **/
@@ -121,7 +129,8 @@ public:
 
 private:
   void writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, std::vector<bool> &found) const;
-  bool checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const;
+  void scanRsums(FILE *wfp, FILE *fp, const unsigned int *ht, unsigned int hm, size_t blksize, std::vector<bool> &found) const;
+  void scanChecksums(FILE *wfp, FILE *fp, std::vector<bool> &found) const;
 
   off_t filesize;
   std::string fsumtype;
@@ -11,7 +11,9 @@
 */
 
 #include <iostream>
+#include <fstream>
 #include <list>
+#include <algorithm>
 
 #include "zypp/base/Logger.h"
 #include "zypp/ExternalProgram.h"
@@ -25,10 +27,15 @@
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/media/CurlConfig.h"
+#include "zypp/media/ConditionalRequest.h"
+#include "zypp/media/PartialDownload.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/thread/Once.h"
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZConfig.h"
+#include "zypp/Digest.h"
+#include "zypp/CheckSumCache.h"
 
 #include <cstdlib>
 #include <sys/types.h>
@@ -37,6 +44,7 @@
 #include <errno.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <sys/select.h>
 
 #define  DETECT_DIR_INDEX       0
 #define  CONNECT_TIMEOUT        60
@@ -148,6 +156,79 @@ namespace
 
     return max;
   }
+
+  /** Feed the MirrorScoreboard with the outcome of a transfer (of the host finally used). */
+  static void
+  score_transfer_curl( CURL * curl, CURLcode ret )
+  {
+    char * effective = 0;
+    if ( curl_easy_getinfo( curl, CURLINFO_EFFECTIVE_URL, &effective ) != CURLE_OK || ! effective )
+      return;
+    zypp::Url url;
+    try { url = zypp::Url( effective ); }
+    catch ( const zypp::Exception & ) { return; }
+
+    long httpReturnCode = 0;
+    curl_easy_getinfo( curl, CURLINFO_RESPONSE_CODE, &httpReturnCode );
+    switch ( ret )
+    {
+      case CURLE_OK:
+      {
+        double size = 0, speed = 0, latency = 0;
+        curl_easy_getinfo( curl, CURLINFO_SIZE_DOWNLOAD, &size );
+        curl_easy_getinfo( curl, CURLINFO_SPEED_DOWNLOAD, &speed );
+        curl_easy_getinfo( curl, CURLINFO_STARTTRANSFER_TIME, &latency );
+        // throughput of small files is mostly noise
+        zypp::media::MirrorScoreboard::instance().success( url, size >= 65536 ? speed : 0, latency );
+      }
+      break;
+
+      case CURLE_HTTP_RETURNED_ERROR:
+        if ( httpReturnCode < 500 )	// e.g. probing for optional files
+          break;
+        // fall through
+      case CURLE_COULDNT_RESOLVE_HOST:
+      case CURLE_COULDNT_CONNECT:
+      case CURLE_OPERATION_TIMEDOUT:
+      case CURLE_PARTIAL_FILE:
+      case CURLE_RECV_ERROR:
+      case CURLE_GOT_NOTHING:
+      case CURLE_SSL_CONNECT_ERROR:
+        zypp::media::MirrorScoreboard::instance().failure( url );
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  /** CURLOPT_HEADERFUNCTION collecting the CacheValidators of the final response. */
+  static size_t
+  collect_validators_curl( void *ptr, size_t size, size_t nmemb, void *userdata )
+  {
+    size_t max = size * nmemb;
+    zypp::media::CacheValidators & validators( *reinterpret_cast<zypp::media::CacheValidators *>( userdata ) );
+
+    std::string line( zypp::str::trim( std::string( (const char *)ptr, max ) ) );
+    if ( zypp::str::hasPrefix( line, "HTTP/" ) )
+    {
+      validators = zypp::media::CacheValidators();	// next response (redirected)
+      return max;
+    }
+
+    std::string::size_type sep = line.find( ':' );
+    if ( sep != std::string::npos )
+    {
+      std::string name( zypp::str::toLower( line.substr( 0, sep ) ) );
+      if ( name == "etag" )
+        validators.etag = zypp::str::trim( line.substr( sep+1 ) );
+      else if ( name == "last-modified" )
+        validators.lastModified = zypp::str::trim( line.substr( sep+1 ) );
+      else if ( name == "location" )
+        DBG << "redirecting to " << line << endl;
+    }
+    return max;
+  }
 }
 
 namespace zypp {
@@ -458,7 +539,8 @@ MediaCurl::MediaCurl( const Url &      url_r,
                     "/", // urlpath at attachpoint
                     true ), // does_download
       _curl( NULL ),
-      _customHeaders(0L)
+      _customHeaders(0L),
+      _curlHeaders(0L)
 {
   _curlError[0] = '\0';
   _curlDebug = 0L;
@@ -778,6 +860,13 @@ void MediaCurl::setupEasy()
   }
 
   SET_OPTION(CURLOPT_HTTPHEADER, _customHeaders);
+  _curlHeaders = _customHeaders;
+}
+
+void MediaCurl::setCurlHeaders( curl_slist * headers_r ) const
+{
+  curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, headers_r );
+  _curlHeaders = headers_r;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -832,11 +921,15 @@ MediaCurl::checkAttachPoint(const Pathname &apoint) const
 
 void MediaCurl::disconnectFrom()
 {
+  _prefetched.clear();
+  MirrorScoreboard::instance().save();
+
   if ( _customHeaders )
   {
     curl_slist_free_all(_customHeaders);
     _customHeaders = 0L;
   }
+  _curlHeaders = 0L;
 
   if ( _curl )
   {
@@ -870,6 +963,17 @@ Url MediaCurl::getFileUrl( const Pathname & filename_r ) const
 
 void MediaCurl::getFile( const Pathname & filename ) const
 {
+    std::set<Pathname>::iterator prefetched( _prefetched.find( filename ) );
+    if ( prefetched != _prefetched.end() )
+    {
+      _prefetched.erase( prefetched );
+      if ( PathInfo( localPath( filename ) ).isFile() )
+      {
+        DBG << "Already prefetched " << filename << endl;
+        return;
+      }
+    }
+
     // Use absolute file name to prevent access of files outside of the
     // hierarchy below the attach point.
     getFileCopy(filename, localPath(filename).absolutename());
@@ -1272,6 +1376,33 @@ bool MediaCurl::detectDirIndex() const
 
 ///////////////////////////////////////////////////////////////////
 
+void MediaCurl::keepPartialDownload( PartialDownload & partial, const std::string & tmpfile, off_t resumedFrom ) const
+{
+  if ( resumedFrom )
+  {
+    // data were appended to the partial file
+    if ( ! partial.resumable() )
+      partial.discard();
+    return;
+  }
+
+  if ( off_t(PathInfo( tmpfile ).size()) >= PartialDownload::minSize )
+  {
+    // we need a validator to send as If-Range, so a changed file is sent as a whole
+    double length = -1;
+    curl_easy_getinfo( _curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length );
+    if ( length > 0 && ! _validators.ifRange().empty() && partial.keep( tmpfile ) )
+    {
+      partial.save( _validators, off_t(length) );
+      filesystem::unlink( tmpfile );
+      return;
+    }
+  }
+  filesystem::unlink( tmpfile );
+}
+
+///////////////////////////////////////////////////////////////////
+
 void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & target, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
 {
     Pathname dest = target.absolutename();
@@ -1281,38 +1412,58 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
       Url url(getFileUrl(filename));
       ZYPP_THROW( MediaSystemException(url, "System error on " + dest.dirname().asString()) );
     }
-    string destNew = target.asString() + ".new.zypp.XXXXXX";
-    char *buf = ::strdup( destNew.c_str());
-    if( !buf)
+
+    // resume an interrupted download if possible
+    Url url( getFileUrl( filename ) );
+    bool resumable = str::hasPrefix( _url.getScheme(), "http" );
+    PartialDownload partial( url );
+    off_t resumeFrom = 0;
+    string destNew;
+    FILE *file = 0;
+    if ( resumable && partial.resumable() )
     {
-      ERR << "out of memory for temp file name" << endl;
-      Url url(getFileUrl(filename));
-      ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+      destNew = partial.file().asString();
+      file = ::fopen( destNew.c_str(), "ae" );
+      if ( file )
+        resumeFrom = PathInfo( destNew ).size();
     }
-
-    int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
-    if( tmp_fd == -1)
+    if ( ! file )
     {
+      if ( partial.exists() )
+        partial.discard();
+
+      destNew = target.asString() + ".new.zypp.XXXXXX";
+      char *buf = ::strdup( destNew.c_str());
+      if( !buf)
+      {
+        ERR << "out of memory for temp file name" << endl;
+        ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+      }
+
+      int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
+      if( tmp_fd == -1)
+      {
+        free( buf);
+        ERR << "mkstemp failed for file '" << destNew << "'" << endl;
+        ZYPP_THROW(MediaWriteException(destNew));
+      }
+      destNew = buf;
       free( buf);
-      ERR << "mkstemp failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
-    }
-    destNew = buf;
-    free( buf);
 
-    FILE *file = ::fdopen( tmp_fd, "we" );
-    if ( !file ) {
-      ::close( tmp_fd);
-      filesystem::unlink( destNew );
-      ERR << "fopen failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
+      file = ::fdopen( tmp_fd, "we" );
+      if ( !file ) {
+        ::close( tmp_fd);
+        filesystem::unlink( destNew );
+        ERR << "fopen failed for file '" << destNew << "'" << endl;
+        ZYPP_THROW(MediaWriteException(destNew));
+      }
     }
 
     DBG << "dest: " << dest << endl;
     DBG << "temp: " << destNew << endl;
 
     // set IFMODSINCE time condition (no download if not modified)
-    if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) )
+    if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) && !resumeFrom )
     {
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, (long)PathInfo(target).mtime());
@@ -1322,19 +1473,63 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
     }
+    // compute the checksum the caller is going to verify while downloading
+    const std::string & digestType( CheckSumCache::wantedType() );
+    Digest digest;
+    bool useDigest = ! digestType.empty() && digest.create( digestType );
+
+    if ( resumeFrom )
+    {
+      MIL << "Resume " << partial << endl;
+      if ( useDigest )
+      {
+        // the digest must include the data we already have
+        std::ifstream in( destNew.c_str() );
+        char buf[65536];
+        while ( in.read( buf, sizeof(buf) ) || in.gcount() )
+          digest.update( buf, in.gcount() );
+      }
+      // a changed file is sent as a whole, which curl refuses when resuming
+      curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)resumeFrom );
+      _ifRange = partial.ifRange();
+    }
+
     try
     {
-      doGetFileCopyFile(filename, dest, file, report, options);
+      doGetFileCopyFile(filename, dest, file, report, options, useDigest ? &digest : nullptr );
     }
     catch (Exception &e)
     {
       ::fclose( file );
-      filesystem::unlink( destNew );
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
+      curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0 );
+      _ifRange.clear();
+
+      const MediaCurlException * curlerr = dynamic_cast<const MediaCurlException *>( &e );
+      if ( resumeFrom && off_t(PathInfo( destNew ).size()) == resumeFrom
+           && curlerr && curlerr->errstr() != "User abort" )
+      {
+        // range request was refused or the file changed meanwhile; start over
+        WAR << "Can't resume " << partial << ": " << e << endl;
+        partial.discard();
+        doGetFileCopy( filename, target, report, options | OPTION_NO_REPORT_START );
+        return;
+      }
+
+      if ( resumable )
+        keepPartialDownload( partial, destNew, resumeFrom );
+      else
+        filesystem::unlink( destNew );
       ZYPP_RETHROW(e);
     }
 
+    if ( resumeFrom )
+    {
+      curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0 );
+      _ifRange.clear();
+    }
+
     long httpReturnCode = 0;
     CURLcode infoRet = curl_easy_getinfo(_curl,
                                          CURLINFO_RESPONSE_CODE,
@@ -1368,11 +1563,15 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
         ERR << "Fclose failed for file '" << destNew << "'" << endl;
         ZYPP_THROW(MediaWriteException(destNew));
       }
-      // move the temp file into dest
-      if ( rename( destNew, dest ) != 0 ) {
+      // move the temp file into dest (the partial file may be on another filesystem)
+      if ( resumeFrom ? hardlinkCopy( destNew, dest ) != 0 : rename( destNew, dest ) != 0 ) {
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      if ( resumeFrom )
+        partial.discard();
+      if ( useDigest )
+        CheckSumCache::remember( dest, CheckSum( digestType, digest.digest() ) );
     }
     else
     {
@@ -1386,7 +1585,253 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
 
 ///////////////////////////////////////////////////////////////////
 
-void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
+namespace
+{
+  /** CURLOPT_WRITEDATA for \ref MediaCurl::writeCallback. */
+  struct DigestWriteData
+  {
+    FILE * file;
+    Digest * digest;
+  };
+}
+
+size_t MediaCurl::writeCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+{
+  DigestWriteData * data = reinterpret_cast<DigestWriteData *>( userdata );
+  size_t written = ::fwrite( ptr, 1, size * nmemb, data->file );
+  if ( written && data->digest )
+    data->digest->update( ptr, written );
+  return written;
+}
+
+///////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /** A single transfer of \ref MediaCurl::prefetchFiles. */
+  struct PrefetchJob
+  {
+    PrefetchJob()
+    : curl( 0 ), size( 0 ), total( 0 )
+    { writeData.file = 0; writeData.digest = nullptr; curlError[0] = '\0'; }
+
+    /** Release the curl handle and close the file. \ref tmpfile is removed unless cleared. */
+    void done( CURLM * multi_r )
+    {
+      if ( curl )
+      {
+        curl_multi_remove_handle( multi_r, curl );
+        curl_easy_cleanup( curl );
+        curl = 0;
+      }
+      if ( writeData.file )
+      {
+        ::fclose( writeData.file );
+        writeData.file = 0;
+      }
+      if ( ! tmpfile.empty() )
+      {
+        filesystem::unlink( tmpfile );
+        tmpfile.clear();
+      }
+    }
+
+    Pathname filename;
+    Pathname dest;
+    std::string url;
+    std::string tmpfile;
+    CURL * curl;
+    DigestWriteData writeData;
+    char curlError[ CURL_ERROR_SIZE ];
+    double size;	//!< bytes received
+    double total;	//!< bytes expected (0 if unknown)
+  };
+}
+
+void MediaCurl::prefetchFiles( const std::vector<Pathname> & filenames ) const
+{
+  // conditional requests and delta downloads are getFile's business
+  if ( filenames.size() < 2 || ! _curl || ! deltafile().empty() || ScopedConditionalRequest::current() )
+    return;
+
+  CURLM * multi = curl_multi_init();
+  if ( ! multi )
+    return;
+
+  std::list<PrefetchJob> jobs;	// stable addresses for CURLOPT_WRITEDATA
+  for_( it, filenames.begin(), filenames.end() )
+  {
+    if ( _prefetched.count( *it ) )
+      continue;
+    jobs.push_back( PrefetchJob() );
+    jobs.back().filename = *it;
+    jobs.back().dest = localPath( *it ).absolutename();
+    jobs.back().url = clearQueryString( getFileUrl( *it ) ).asString();
+  }
+  MIL << "Prefetch " << jobs.size() << " files from " << _url.asString() << endl;
+
+  callback::SendReport<DownloadProgressReport> report;
+  report->start( _url, localRoot() );
+
+  long maxConnections = std::max( _settings.maxConcurrentConnections(), 1L );
+  std::list<PrefetchJob>::iterator next( jobs.begin() );
+  int running = 0;
+  int lastPercent = -1;
+  time_t started = time( NULL );
+  bool aborted = false;
+
+  while ( ! aborted && ( running || next != jobs.end() ) )
+  {
+    // keep up to maxConnections transfers running
+    for ( ; running < maxConnections && next != jobs.end(); ++next )
+    {
+      PrefetchJob & job( *next );
+      if ( assert_dir( job.dest.dirname() ) != 0 )
+        continue;
+
+      std::string tmpl( job.dest.asString() + ".new.zypp.XXXXXX" );
+      std::vector<char> buf( tmpl.begin(), tmpl.end() );
+      buf.push_back( '\0' );
+      int tmp_fd = ::mkostemp( &buf[0], O_CLOEXEC );
+      if ( tmp_fd == -1 )
+        continue;
+      job.tmpfile = &buf[0];
+      job.writeData.file = ::fdopen( tmp_fd, "we" );
+      if ( ! job.writeData.file )
+      {
+        ::close( tmp_fd );
+        job.done( multi );
+        continue;
+      }
+
+      // a copy of our handle: proxy, authentication, ssl and custom headers included
+      job.curl = curl_easy_duphandle( _curl );
+      if ( ! job.curl )
+      {
+        job.done( multi );
+        continue;
+      }
+      curl_easy_setopt( job.curl, CURLOPT_URL, job.url.c_str() );
+      curl_easy_setopt( job.curl, CURLOPT_ERRORBUFFER, job.curlError );
+      curl_easy_setopt( job.curl, CURLOPT_WRITEFUNCTION, &writeCallback );
+      curl_easy_setopt( job.curl, CURLOPT_WRITEDATA, &job.writeData );
+      curl_easy_setopt( job.curl, CURLOPT_HTTPHEADER, _customHeaders );	// no metalink
+      curl_easy_setopt( job.curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE );
+      curl_easy_setopt( job.curl, CURLOPT_TIMEVALUE, 0L );
+      curl_easy_setopt( job.curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0 );
+      curl_easy_setopt( job.curl, CURLOPT_PROGRESSDATA, (void *)0 );
+      curl_easy_setopt( job.curl, CURLOPT_NOPROGRESS, 1L );
+      if ( _settings.timeout() )
+      {
+        // progressCallback is not there to enforce it
+        curl_easy_setopt( job.curl, CURLOPT_LOW_SPEED_LIMIT, 1L );
+        curl_easy_setopt( job.curl, CURLOPT_LOW_SPEED_TIME, _settings.timeout() );
+      }
+      if ( curl_multi_add_handle( multi, job.curl ) != CURLM_OK )
+      {
+        job.done( multi );
+        continue;
+      }
+      ++running;
+    }
+
+    fd_set rset, wset, xset;
+    int maxfd = -1;
+    FD_ZERO( &rset );
+    FD_ZERO( &wset );
+    FD_ZERO( &xset );
+    curl_multi_fdset( multi, &rset, &wset, &xset, &maxfd );
+    timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 200000;
+    if ( ::select( maxfd + 1, &rset, &wset, &xset, &tv ) == -1 && errno != EINTR )
+      break;
+
+    CURLMcode mcode;
+    while ( ( mcode = curl_multi_perform( multi, &running ) ) == CURLM_CALL_MULTI_PERFORM )
+      ;
+    if ( mcode != CURLM_OK )
+      break;
+
+    // collect finished transfers
+    CURLMsg * msg;
+    int nqueue;
+    while ( ( msg = curl_multi_info_read( multi, &nqueue ) ) != 0 )
+    {
+      if ( msg->msg != CURLMSG_DONE )
+        continue;
+      std::list<PrefetchJob>::iterator it( jobs.begin() );
+      while ( it != jobs.end() && it->curl != msg->easy_handle )
+        ++it;
+      if ( it == jobs.end() )
+        continue;
+      PrefetchJob & job( *it );
+      CURLcode cc = msg->data.result;
+      score_transfer_curl( job.curl, cc );
+
+      char * ct = 0;
+      if ( cc == CURLE_OK
+           && ! ( curl_easy_getinfo( job.curl, CURLINFO_CONTENT_TYPE, &ct ) == CURLE_OK && ct && ::strstr( ct, "metalink" ) )
+           && ::fchmod( ::fileno( job.writeData.file ), filesystem::applyUmaskTo( 0644 ) ) == 0
+           && ::fclose( job.writeData.file ) == 0 )
+      {
+        job.writeData.file = 0;
+        if ( rename( job.tmpfile, job.dest ) == 0 )
+        {
+          job.tmpfile.clear();
+          _prefetched.insert( job.filename );
+          DBG << "Prefetched " << job.filename << endl;
+        }
+      }
+      else
+      {
+        DBG << "Prefetch " << job.url << " failed (" << cc << "): " << job.curlError << endl;
+      }
+      curl_easy_getinfo( job.curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &job.total );
+      curl_easy_getinfo( job.curl, CURLINFO_SIZE_DOWNLOAD, &job.size );
+      job.done( multi );
+    }
+
+    // report the combined progress
+    double total = 0;
+    double now = 0;
+    for_( it, jobs.begin(), next )
+    {
+      if ( it->curl )
+      {
+        curl_easy_getinfo( it->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &it->total );
+        curl_easy_getinfo( it->curl, CURLINFO_SIZE_DOWNLOAD, &it->size );
+      }
+      if ( it->total > 0 )
+      {
+        total += it->total;
+        now += it->size;
+      }
+    }
+    int percent = total > 0 ? int( now * 100 / total ) : 0;
+    if ( percent != lastPercent )
+    {
+      lastPercent = percent;
+      time_t secs = time( NULL ) - started;
+      if ( ! report->progress( percent, _url, secs > 0 ? now / secs : -1 ) )
+      {
+        MIL << "Prefetch aborted by user" << endl;
+        aborted = true;
+      }
+    }
+  }
+
+  for_( it, jobs.begin(), jobs.end() )
+    it->done( multi );
+  curl_multi_cleanup( multi );
+
+  if ( aborted )
+    report->finish( _url, DownloadProgressReport::ERROR, "User abort" );
+  else
+    report->finish( _url, DownloadProgressReport::NO_ERROR, "" );
+}
+
+void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options, Digest * digest_r ) const
 {
     DBG << filename.asString() << endl;
 
@@ -1420,11 +1865,63 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
-    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    DigestWriteData writeData = { file, digest_r };
+    if ( digest_r )
+    {
+      // compute the checksum on the fly, so it's not necessary to read the file again
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &writeCallback );
+      if ( ret == 0 )
+        ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, &writeData );
+    }
+    else
+    {
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    }
     if ( ret != 0 ) {
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
+    // conditional request: send and collect the validators
+    bool http = str::hasPrefix( _url.getScheme(), "http" );
+    ScopedConditionalRequest * conditional( http ? ScopedConditionalRequest::current() : nullptr );
+    _validators = CacheValidators();
+    std::string ifNoneMatch;
+    curl_slist * conditionalHeaders = 0L;
+    bool conditionalTime = false;
+    if ( conditional )
+    {
+      CacheValidators sent( conditional->request( filename ) );
+      ifNoneMatch = sent.etag;
+      if ( ! sent.lastModified.empty() )
+      {
+        time_t lastModified = curl_getdate( sent.lastModified.c_str(), NULL );
+        if ( lastModified != -1 )
+        {
+          curl_easy_setopt( _curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE );
+          curl_easy_setopt( _curl, CURLOPT_TIMEVALUE, (long)lastModified );
+          conditionalTime = true;
+        }
+      }
+      DBG << "Conditional request " << sent << endl;
+    }
+    if ( http && ( ! ifNoneMatch.empty() || ! _ifRange.empty() ) )
+    {
+      // extend the headers currently in use (e.g. metalink Accept)
+      for ( curl_slist * sl = _curlHeaders; sl; sl = sl->next )
+        conditionalHeaders = curl_slist_append( conditionalHeaders, sl->data );
+      if ( ! ifNoneMatch.empty() )
+        conditionalHeaders = curl_slist_append( conditionalHeaders, ( "If-None-Match: " + ifNoneMatch ).c_str() );
+      if ( ! _ifRange.empty() )
+        conditionalHeaders = curl_slist_append( conditionalHeaders, ( "If-Range: " + _ifRange ).c_str() );
+      curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, conditionalHeaders );
+    }
+    if ( http )
+    {
+      // the validators are also needed to resume an interrupted download
+      curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, collect_validators_curl );
+      curl_easy_setopt( _curl, CURLOPT_HEADERDATA, &_validators );
+    }
+
     // Set callback and perform.
     ProgressData progressData(_curl, _settings.timeout(), url, &report);
     if (!(options & OPTION_NO_REPORT_START))
@@ -1459,6 +1956,36 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
     if ( curl_easy_setopt( _curl, CURLOPT_PROGRESSDATA, NULL ) != 0 ) {
       WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
     }
+    score_transfer_curl( _curl, ret );
+
+    if ( http )
+    {
+      curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, log_redirects_curl );
+      curl_easy_setopt( _curl, CURLOPT_HEADERDATA, (void *)0 );
+    }
+    if ( conditionalHeaders )
+    {
+      curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, _curlHeaders );
+      curl_slist_free_all( conditionalHeaders );
+    }
+    if ( conditional )
+    {
+      if ( conditionalTime )
+      {
+        curl_easy_setopt( _curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE );
+        curl_easy_setopt( _curl, CURLOPT_TIMEVALUE, 0L );
+      }
+      long httpReturnCode = 0;
+      if ( ret == 0 && curl_easy_getinfo( _curl, CURLINFO_RESPONSE_CODE, &httpReturnCode ) == CURLE_OK )
+        conditional->reply( filename, _validators, httpReturnCode == 304 );
+    }
+
+    if ( digest_r )
+    {
+      // back to curls default fwrite
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, (void *)0 );
+      curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    }
 
     if ( ret != 0 )
     {
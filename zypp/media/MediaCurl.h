@@ -15,12 +15,18 @@
 #include "zypp/base/Flags.h"
 #include "zypp/media/TransferSettings.h"
 #include "zypp/media/MediaHandler.h"
+#include "zypp/media/ConditionalRequest.h"
 #include "zypp/ZYppCallbacks.h"
 
 #include <curl/curl.h>
+#include <set>
+#include <vector>
 
 namespace zypp {
+  class Digest;
+
   namespace media {
+    class PartialDownload;
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -54,6 +60,8 @@ class MediaCurl : public MediaHandler
     virtual void attachTo (bool next = false);
     virtual void releaseFrom( const std::string & ejectDev );
     virtual void getFile( const Pathname & filename ) const;
+    /** Download \a filenames concurrently (see \ref MediaHandler::precacheFiles). */
+    virtual void prefetchFiles( const std::vector<Pathname> & filenames ) const;
     virtual void getDir( const Pathname & dirname, bool recurse_r ) const;
     virtual void getDirInfo( std::list<std::string> & retlist,
                              const Pathname & dirname, bool dots = true ) const;
@@ -148,7 +156,23 @@ class MediaCurl : public MediaHandler
      */
     void evaluateCurlCode( const zypp::Pathname &filename, CURLcode code, bool timeout ) const;
 
-    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
+    /**
+     * Download \a srcFilename into \a file.
+     * If \a digest_r is not \c NULL, all received data are fed into it.
+     */
+    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE, Digest * digest_r = nullptr ) const;
+
+    /** CURLOPT_WRITEFUNCTION writing to a FILE and updating a \ref Digest. */
+    static size_t writeCallback( char *ptr, size_t size, size_t nmemb, void *userdata );
+
+    /**
+     * After a failed transfer keep the data received in \a tmpfile as
+     * \a partial download, if a later attempt will be able to resume
+     * it. \a resumedFrom is the offset the transfer was resumed at
+     * (i.e. \a tmpfile is the partial file), or \c 0.
+     * Otherwise \a tmpfile is removed.
+     */
+    void keepPartialDownload( PartialDownload & partial, const std::string & tmpfile, off_t resumedFrom ) const;
 
   private:
     /**
@@ -167,10 +191,24 @@ class MediaCurl : public MediaHandler
     std::string _currentCookieFile;
     static Pathname _cookieFile;
 
+    /** Files downloaded by \ref prefetchFiles, but not yet requested by \ref getFile. */
+    mutable std::set<Pathname> _prefetched;
+
+    /** \c If-Range to send with the next transfer (resuming a \ref PartialDownload). */
+    mutable std::string _ifRange;
+    /** The cache validators received with the last http(s) transfer. */
+    mutable CacheValidators _validators;
+
+  protected:
+    /** Set the headers to send via \ref _curl (remembered in \ref _curlHeaders). */
+    void setCurlHeaders( curl_slist * headers_r ) const;
+
   protected:
     CURL *_curl;
     char _curlError[ CURL_ERROR_SIZE ];
     curl_slist *_customHeaders;
+    /** The headers currently set on \ref _curl (e.g. \ref _customHeaders plus metalink). */
+    mutable curl_slist *_curlHeaders;
     TransferSettings _settings;
 };
 ZYPP_DECLARE_OPERATORS_FOR_FLAGS(MediaCurl::RequestOptions);
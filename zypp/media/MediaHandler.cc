@@ -18,6 +18,7 @@
 #include "zypp/Date.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Measure.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/Mount.h"
@@ -994,7 +995,9 @@ void MediaHandler::provideFile( Pathname filename ) const
     ZYPP_THROW(MediaNotAttachedException(url()));
   }
 
+  debug::MeasureCounter counter( "media::getFile" );
   getFile( filename ); // pass to concrete handler
+  counter.stop();
   DBG << "provideFile(" << filename << ")" << endl;
 }
 
@@ -1390,6 +1393,26 @@ Pathname MediaHandler::deltafile() const {
   return _deltafile;
 }
 
+void MediaHandler::setCachePaths( const std::vector<Pathname> & cachePaths ) const
+{
+  _cachePaths = cachePaths;
+}
+
+const std::vector<Pathname> & MediaHandler::cachePaths() const {
+  return _cachePaths;
+}
+
+void MediaHandler::precacheFiles( const std::vector<Pathname> & filenames ) const
+{
+  if ( !isAttached() || filenames.empty() )
+    return;
+
+  debug::MeasureCounter counter( "media::prefetchFiles" );
+  prefetchFiles( filenames ); // pass to concrete handler
+  counter.stop();
+  DBG << "precacheFiles(" << filenames.size() << " files)" << endl;
+}
+
   } // namespace media
 } // namespace zypp
 // vim: set ts=8 sts=2 sw=2 ai noet:
@@ -16,6 +16,7 @@
 #include <iosfwd>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
@@ -103,6 +104,9 @@ class MediaHandler {
 	/** file usable for delta downloads */
 	mutable Pathname _deltafile;
 
+	/** local caches possibly holding older versions of the files to download */
+	mutable std::vector<Pathname> _cachePaths;
+
     protected:
         /**
 	 * Url to handle
@@ -359,6 +363,18 @@ class MediaHandler {
 	 **/
 	virtual void getFile( const Pathname & filename ) const = 0;
 
+	/**
+	 * Call concrete handler to download \a filenames below the attach
+	 * point in advance, see \ref precacheFiles.
+	 *
+	 * Default implementation does nothing. Must not throw; files which
+	 * can't be fetched are simply left to \ref getFile.
+	 *
+	 * Asserted that media is attached.
+	 **/
+	virtual void prefetchFiles( const std::vector<Pathname> & /*filenames*/ ) const
+	{}
+
         /**
          * Call concrete handler to provide a file under a different place
          * in the file system (usually not under attach point) as a copy.
@@ -649,6 +665,28 @@ class MediaHandler {
 	 */
 	Pathname deltafile () const;
 
+	/**
+	 * set the local cache directories to search for older versions
+	 * of the files to download next (see \ref Fetcher::addCachePath)
+	 */
+	void setCachePaths( const std::vector<Pathname> & cachePaths = std::vector<Pathname>() ) const;
+
+	/**
+	 * return the cache directories set with setCachePaths()
+	 */
+	const std::vector<Pathname> & cachePaths() const;
+
+	/**
+	 * Hint that \a filenames are going to be provided next.
+	 *
+	 * Handlers able to transfer several files at once may download them
+	 * concurrently in advance (see \ref prefetchFiles), so the following
+	 * \ref provideFile does not need to transfer them again. This is best
+	 * effort only: files which could not be fetched are downloaded (and
+	 * errors are reported) by \ref provideFile as usual.
+	 **/
+	void precacheFiles( const std::vector<Pathname> & filenames ) const;
+
     public:
 
 	/**
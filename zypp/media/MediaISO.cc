@@ -151,6 +151,13 @@ namespace zypp
     // ---------------------------------------------------------------
     string MediaISO::findUnusedLoopDevice()
     {
+      string device = Mount::getFreeLoopDevice();
+      if ( ! device.empty() )
+      {
+        DBG << "found " << device << endl;
+        return device;
+      }
+
       const char* argv[] =
       {
         LOSETUP_TOOL_PATH,
@@ -160,7 +167,7 @@ namespace zypp
       ExternalProgram losetup(argv, ExternalProgram::Stderr_To_Stdout);
 
       string out = losetup.receiveLine();
-      string device = out.substr(0, out.size() - 1); // remove the trailing endl
+      device = out.substr(0, out.size() - 1); // remove the trailing endl
       for(; out.length(); out = losetup.receiveLine())
         DBG << "losetup: " << out;
 
@@ -219,10 +219,10 @@ namespace zypp
       static inline time_t
       getMountTableMTime()
       {
-        time_t mtime = zypp::PathInfo("/etc/mtab").mtime();
+        time_t mtime = Mount::getMTime();
         if( mtime <= 0)
         {
-          WAR << "Failed to retrieve modification time of '/etc/mtab'"
+          WAR << "Failed to retrieve modification time of the mount table"
               << std::endl;
         }
         return mtime;
@@ -707,6 +707,34 @@ namespace zypp
       ref.handler->setDeltafile(filename);
     }
 
+    // ---------------------------------------------------------------
+    void
+    MediaManager::setCachePaths(MediaAccessId   accessId,
+                                const std::vector<Pathname> &cachePaths ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->setCachePaths(cachePaths);
+    }
+
+    // ---------------------------------------------------------------
+    void
+    MediaManager::precacheFiles(MediaAccessId   accessId,
+                                const std::vector<Pathname> &filenames ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->precacheFiles(filenames);
+    }
+
     // ---------------------------------------------------------------
     void
     MediaManager::provideDir(MediaAccessId   accessId,
@@ -21,6 +21,7 @@
 #include "zypp/Url.h"
 
 #include <list>
+#include <vector>
 
 
 //////////////////////////////////////////////////////////////////////
@@ -840,17 +841,36 @@ namespace zypp
       setDeltafile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Local cache directories possibly holding older versions
+       * of the files to provide next.
+       * \see MediaHandler::setCachePaths
+       */
+      void
+      setCachePaths(MediaAccessId   accessId,
+                    const std::vector<Pathname> &cachePaths ) const;
+
+      /**
+       * Hint that \a filenames are going to be provided next, so
+       * the handler may download them concurrently in advance.
+       * \see MediaHandler::precacheFiles
+       */
+      void
+      precacheFiles(MediaAccessId   accessId,
+                    const std::vector<Pathname> &filenames ) const;
+
     public:
       /**
-       * Get the modification time of the /etc/mtab file.
-       * \return Modification time of the /etc/mtab file.
+       * Get the modification time of the mount table.
+       * \return A time stamp changing whenever the mount table changes
+       *         (see \ref Mount::getMTime).
        */
       static time_t
       getMountTableMTime();
 
       /**
-       * Get current mount entries from /etc/mtab file.
-       * \return Current mount entries from /etc/mtab file.
+       * Get current mount entries (cached until the mount table changes).
+       * \return Current mount entries.
        */
       static std::vector<MountEntry>
       getMountEntries();
@@ -18,14 +18,23 @@
 #include <arpa/inet.h>
 
 #include <vector>
+#include <list>
+#include <set>
 #include <iostream>
 #include <algorithm>
+#include <functional>
 
 
 #include "zypp/ZConfig.h"
+#include "zypp/Digest.h"
+#include "zypp/CheckSumCache.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
 #include "zypp/media/MediaMultiCurl.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/PartialDownload.h"
+#include "zypp/media/MirrorScoreboard.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -538,6 +547,7 @@ multifetchworker::dnsevent(fd_set &rset)
   XXX << "#" << _workerno << ": DNS lookup returned " << exitcode << endl;
   if (exitcode != 0)
     {
+      MirrorScoreboard::instance().failure(_url);
       _state = WORKER_BROKEN;
       strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
       _request->_activeworkers--;
@@ -825,6 +835,7 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
 
 multifetchrequest::~multifetchrequest()
 {
+  MirrorScoreboard::instance().save();
   for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
     {
       multifetchworker *worker = *workeriter;
@@ -989,12 +1000,14 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  multifetchworker *worker;
 	  if (curl_easy_getinfo(easy, CURLINFO_PRIVATE, &worker) != CURLE_OK)
 	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_easy_getinfo", "unknown error"));
+	  double blkspeed = 0;
 	  if (worker->_blkreceived && now > worker->_blkstarttime)
 	    {
+	      blkspeed = worker->_blkreceived / (now - worker->_blkstarttime);
 	      if (worker->_avgspeed)
-		worker->_avgspeed = (worker->_avgspeed + worker->_blkreceived / (now - worker->_blkstarttime)) / 2;
+		worker->_avgspeed = (worker->_avgspeed + blkspeed) / 2;
 	      else
-		worker->_avgspeed = worker->_blkreceived / (now - worker->_blkstarttime);
+		worker->_avgspeed = blkspeed;
 	    }
 	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << endl;
 	  curl_multi_remove_handle(_multi, easy);
@@ -1030,6 +1043,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      if (!worker->checkChecksum())
 		{
 		  WAR << "#" << worker->_workerno << ": checksum error, disable worker" << endl;
+		  MirrorScoreboard::instance().failure(worker->_url);
 		  worker->_state = WORKER_BROKEN;
 		  strncpy(worker->_curlError, "checksum error", CURL_ERROR_SIZE);
 		  _activeworkers--;
@@ -1054,6 +1068,9 @@ multifetchrequest::run(std::vector<Url> &urllist)
 			}
 		    }
 		  _fetchedgoodsize += worker->_blksize;
+		  double latency = 0;
+		  curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &latency);
+		  MirrorScoreboard::instance().success(worker->_url, blkspeed, latency);
 		}
 
 	      // make bad workers sleep a little
@@ -1111,6 +1128,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	    }
 	  else
 	    {
+	      MirrorScoreboard::instance().failure(worker->_url);
 	      worker->_state = WORKER_BROKEN;
 	      _activeworkers--;
 	      if (!_activeworkers && !(urliter != urllist.end() && _workers.size() < MAXURLS))
@@ -1235,6 +1253,84 @@ static bool looks_like_metalink(const Pathname & file)
   return ret;
 }
 
+// the package name of an rpm file name (name-version-release.arch.rpm)
+static string rpm_name_of(const string & basename)
+{
+  if (!str::hasSuffix(basename, ".rpm"))
+    return string();
+  string::size_type p = basename.rfind('-');		// -release.arch.rpm
+  if (p == string::npos || !p)
+    return string();
+  p = basename.rfind('-', p - 1);			// -version
+  if (p == string::npos || !p)
+    return string();
+  return basename.substr(0, p);
+}
+
+// older cached versions of the package we are about to download, newest
+// first: look into the target directory, the directory of the deltafile,
+// the file's subdirectory in the cache directories and, for caches in the
+// configured package cache, in the package caches of the other repos.
+static vector<string> seed_candidates(const Pathname & filename, const Pathname & target, const Pathname & deltafile, const vector<Pathname> & cachepaths)
+{
+  static const unsigned maxseeds = 3;
+  vector<string> ret;
+  string basename(target.basename());
+  string name(rpm_name_of(basename));
+  if (name.empty())
+    return ret;
+  string archsuffix(basename.substr(basename.rfind('.', basename.size() - 5)));	// .arch.rpm
+
+  set<Pathname> dirs;
+  dirs.insert(target.dirname());
+  if (!deltafile.empty())
+    dirs.insert(deltafile.dirname());
+  Pathname subdir(filename.dirname());
+  set<Pathname> roots;
+  if (!cachepaths.empty())
+    {
+      // don't scan the siblings of arbitrary directories (e.g. /tmp)
+      set<Pathname> pkgroots;
+      pkgroots.insert(ZConfig::instance().repoPackagesPath());
+      pkgroots.insert(Pathname::assertprefix(ZConfig::instance().systemRoot(), ZConfig::instance().repoPackagesPath()));
+      for (const Pathname & cachepath : cachepaths)
+	{
+	  dirs.insert(cachepath / subdir);
+	  if (pkgroots.count(cachepath.dirname()))
+	    roots.insert(cachepath.dirname());
+	}
+    }
+  for (const Pathname & root : roots)
+    {
+      // <root>/<alias>/<subdir>/<file>
+      list<string> aliases;
+      filesystem::readdir(aliases, root, false);
+      for (const string & alias : aliases)
+	dirs.insert(root / alias / subdir);
+    }
+
+  vector<pair<time_t,string> > found;
+  for (const Pathname & dir : dirs)
+    {
+      list<string> entries;
+      if (filesystem::readdir(entries, dir, false) != 0)
+	continue;
+      for (const string & entry : entries)
+	{
+	  if (!str::hasSuffix(entry, archsuffix) || rpm_name_of(entry) != name)
+	    continue;
+	  PathInfo pi(dir / entry);
+	  if (!pi.isFile() || pi.path() == target)
+	    continue;
+	  found.push_back(make_pair(pi.mtime(), pi.path().asString()));
+	}
+    }
+  sort(found.begin(), found.end(), greater<pair<time_t,string> >());
+  for (unsigned i = 0; i < found.size() && i < maxseeds; ++i)
+    ret.push_back(found[i].second);
+  return ret;
+}
+
 // here we try to suppress all progress coming from a metalink download
 int MediaMultiCurl::progressCallback( void *clientp, double dltotal, double dlnow, double ultotal, double ulnow)
 {
@@ -1290,6 +1386,16 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
     Url url(getFileUrl(filename));
     ZYPP_THROW( MediaSystemException(url, "System error on " + dest.dirname().asString()) );
   }
+  Url url( getFileUrl( filename ) );
+  bool resumable = str::hasPrefix( _url.getScheme(), "http" );
+  PartialDownload partial( url );
+  if ( resumable && partial.resumable() )
+  {
+    // an interrupted plain download: resume it
+    curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, &MediaCurl::progressCallback);
+    MediaCurl::doGetFileCopy( filename, target, report, options );
+    return;
+  }
   string destNew = target.asString() + ".new.zypp.XXXXXX";
   char *buf = ::strdup( destNew.c_str());
   if( !buf)
@@ -1331,27 +1437,35 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
     curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
   }
   // change header to include Accept: metalink
-  curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeadersMetalink);
+  setCurlHeaders(_customHeadersMetalink);
   // change to our own progress funcion
   curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, &progressCallback);
   curl_easy_setopt(_curl, CURLOPT_PRIVATE, file);
+  // compute the checksum the caller is going to verify while downloading
+  const std::string & digestType( CheckSumCache::wantedType() );
+  Digest digest;
+  bool useDigest = ! digestType.empty() && digest.create( digestType );
   try
     {
-      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options);
+      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options, useDigest ? &digest : nullptr );
     }
   catch (Exception &ex)
     {
       ::fclose(file);
-      filesystem::unlink(destNew);
+      // keep an interrupted plain download for resume
+      if ( resumable && ! looks_like_metalink(Pathname(destNew)) )
+	keepPartialDownload( partial, destNew, 0 );
+      else
+	filesystem::unlink(destNew);
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
-      curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeaders);
+      setCurlHeaders(_customHeaders);
       curl_easy_setopt(_curl, CURLOPT_PRIVATE, (void *)0);
       ZYPP_RETHROW(ex);
     }
   curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
   curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
-  curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeaders);
+  setCurlHeaders(_customHeaders);
   curl_easy_setopt(_curl, CURLOPT_PRIVATE, (void *)0);
   long httpReturnCode = 0;
   CURLcode infoRet = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &httpReturnCode);
@@ -1362,6 +1476,8 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	 || ( httpReturnCode == 213 && _url.getScheme() == "ftp" ) ) // not modified
     {
       DBG << "not modified: " << PathInfo(dest) << endl;
+      ::fclose( file );
+      filesystem::unlink( destNew );
       return;
     }
   }
@@ -1391,6 +1507,8 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 
   if (ismetalink)
     {
+      // blocks are fetched in parallel and out of order
+      useDigest = false;
       bool userabort = false;
       fclose(file);
       file = NULL;
@@ -1411,8 +1529,16 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	      bl.reuseBlocks(file, target.asString());
 	      XXX << bl << endl;
 	    }
-	  if (bl.haveChecksum(1) && PathInfo(failedFile).isExist())
+	  if (bl.haveChecksum(1) && partial.exists())
+	    {
+	      XXX << "reusing blocks from file " << partial.file() << endl;
+	      bl.reuseBlocks(file, partial.file().asString());
+	      XXX << bl << endl;
+	      partial.discard();
+	    }
+	  else if (bl.haveChecksum(1) && PathInfo(failedFile).isExist())
 	    {
+	      // the last failed download, maybe of an other url
 	      XXX << "reusing blocks from file " << failedFile << endl;
 	      bl.reuseBlocks(file, failedFile.asString());
 	      XXX << bl << endl;
@@ -1425,6 +1551,13 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	      bl.reuseBlocks(file, df.asString());
 	      XXX << bl << endl;
 	    }
+	  vector<string> seeds(seed_candidates(filename, target, df, cachePaths()));
+	  if (!seeds.empty() && bl.numBlocks())
+	    {
+	      MIL << "reusing blocks from " << seeds.size() << " older versions of " << target.basename() << endl;
+	      bl.reuseBlocks(file, seeds);
+	      XXX << bl << endl;
+	    }
 	  try
 	    {
 	      multifetch(filename, file, &urls, &report, &bl);
@@ -1441,9 +1574,11 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  if (file)
 	    fclose(file);
 	  file = NULL;
-	  if (PathInfo(destNew).size() >= 63336)
+	  if (off_t(PathInfo(destNew).size()) >= PartialDownload::minSize)
 	    {
-	      ::unlink(failedFile.asString().c_str());
+	      // the blocks we got are verified by checksum when reused
+	      if (partial.keep(destNew))
+		partial.save();
 	      filesystem::hardlinkCopy(destNew, failedFile);
 	    }
 	  if (userabort)
@@ -1454,7 +1589,8 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  file = fopen(destNew.c_str(), "w+e");
 	  if (!file)
 	    ZYPP_THROW(MediaWriteException(destNew));
-	  MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START);
+	  useDigest = ! digestType.empty() && digest.create( digestType );
+	  MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START, useDigest ? &digest : nullptr );
 	}
     }
 
@@ -1473,6 +1609,10 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
       ERR << "Rename failed" << endl;
       ZYPP_THROW(MediaWriteException(dest));
     }
+  if ( partial.exists() )
+    partial.discard();	// outdated
+  if ( useDigest )
+    CheckSumCache::remember( dest, CheckSum( digestType, digest.digest() ) );
   DBG << "done: " << PathInfo(dest) << endl;
 }
 
@@ -1523,6 +1663,8 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     }
   if (!myurllist.size())
     myurllist.push_back(baseurl);
+  // the first _maxworkers urls get a worker right away
+  MirrorScoreboard::instance().order(myurllist);
   req.run(myurllist);
   checkFileDigest(baseurl, fp, blklist);
 }
@@ -0,0 +1,239 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/MirrorScoreboard.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/media/MirrorScoreboard.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Weight of a new sample in the moving averages. */
+      const double alpha = 0.3;
+
+      /** Scores not updated for this long are forgotten. */
+      const Date::ValueType maxAge = 7 * Date::day;
+
+      /** The block size MediaMultiCurl fetches; what \ref rank is about. */
+      const double blockSize = 131072;
+
+      inline double ewma( double value_r, double sample_r )
+      { return value_r * ( 1 - alpha ) + sample_r * alpha; }
+
+      /** The median of \a values_r (the lower one, if even) or \c 0 if empty. */
+      inline double lowerMedian( std::vector<double> values_r )
+      {
+	if ( values_r.empty() )
+	  return 0;
+	std::nth_element( values_r.begin(), values_r.begin() + ( values_r.size() - 1 ) / 2, values_r.end() );
+	return values_r[( values_r.size() - 1 ) / 2];
+      }
+
+      /** The map key for \a url_r */
+      inline std::string hostKey( const Url & url_r )
+      {
+	std::string ret( url_r.getHost() );
+	if ( ! url_r.getPort().empty() )
+	  ret += ":" + url_r.getPort();
+	return ret;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    double MirrorScoreboard::Score::rank( double throughput_r ) const
+    {
+      double ret = latency;
+      if ( throughput > 0 )
+	ret += blockSize / std::max( throughput, 1024.0 );
+      else if ( latency <= 0 )
+	ret += blockSize / 1024.0;	// never got data from the host
+      else if ( throughput_r > 0 )
+	ret += blockSize / std::max( throughput_r, 1024.0 );
+      return ret / ( 1 - std::min( failureRate, 0.9 ) );
+    }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorScoreboard::Score & obj )
+    {
+      if ( obj.empty() )
+	return str << "{no score}";
+      return str << "{" << obj.throughput << " B/s, " << obj.latency << " s, failed " << obj.failureRate << "}";
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	The file format:
+    //	  <host> <throughput> <latency> <failure rate> <last update>
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    MirrorScoreboard::MirrorScoreboard( const Pathname & file_r )
+    : _file( file_r )
+    , _dirty( false )
+    {
+      if ( ! PathInfo( _file ).isFile() )
+	return;
+
+      Date::ValueType expired = Date::now() - maxAge;
+      InputStream in( _file );
+      for ( iostr::EachLine line( in ); line; line.next() )
+      {
+	std::istringstream words( *line );
+	std::string host;
+	Score score;
+	Date::ValueType lastUpdate = 0;
+	if ( ! ( words >> host >> score.throughput >> score.latency >> score.failureRate >> lastUpdate ) )
+	  continue;
+	if ( lastUpdate < expired )
+	{
+	  _dirty = true;	// drop it on the next save
+	  continue;
+	}
+	score.lastUpdate = lastUpdate;
+	_scores[host] = score;
+      }
+      DBG << "Loaded scores of " << _scores.size() << " mirrors from " << _file << endl;
+    }
+
+    MirrorScoreboard & MirrorScoreboard::instance()
+    {
+      // follow the target root (it may be initialized after the first download)
+      static shared_ptr<MirrorScoreboard> _instance;
+      Pathname file( Pathname::assertprefix( ZConfig::instance().systemRoot(), ZConfig::instance().repoCachePath() ) / "mirrors.scores" );
+      if ( ! _instance || _instance->_file != file )
+      {
+	if ( _instance )
+	  _instance->save();
+	_instance.reset( new MirrorScoreboard( file ) );
+      }
+      return *_instance;
+    }
+
+    MirrorScoreboard::Score MirrorScoreboard::score( const Url & url_r ) const
+    {
+      auto it = _scores.find( hostKey( url_r ) );
+      return it == _scores.end() ? Score() : it->second;
+    }
+
+    void MirrorScoreboard::success( const Url & url_r, double throughput_r, double latency_r )
+    {
+      Score & score( _scores[hostKey( url_r )] );
+      if ( score.empty() )
+      {
+	score.throughput = throughput_r;
+	score.latency = latency_r;
+      }
+      else
+      {
+	if ( throughput_r > 0 )
+	  score.throughput = score.throughput > 0 ? ewma( score.throughput, throughput_r ) : throughput_r;
+	score.latency = ewma( score.latency, latency_r );
+      }
+      score.failureRate = ewma( score.failureRate, 0.0 );
+      score.lastUpdate = Date::now();
+      _dirty = true;
+    }
+
+    void MirrorScoreboard::failure( const Url & url_r )
+    {
+      Score & score( _scores[hostKey( url_r )] );
+      score.failureRate = score.empty() ? alpha : ewma( score.failureRate, 1.0 );
+      score.lastUpdate = Date::now();
+      _dirty = true;
+    }
+
+    void MirrorScoreboard::order( std::vector<Url> & urls_r ) const
+    {
+      std::vector<Score> scores;
+      scores.reserve( urls_r.size() );
+      std::vector<double> throughputs;
+      for ( const Url & url : urls_r )
+      {
+	scores.push_back( score( url ) );
+	if ( scores.back().throughput > 0 )
+	  throughputs.push_back( scores.back().throughput );
+      }
+      // hosts we only fetched small files from get the median throughput
+      double throughput = lowerMedian( throughputs );
+
+      std::vector<double> ranks;
+      ranks.reserve( urls_r.size() );
+      std::vector<double> known;
+      for ( const Score & s : scores )
+      {
+	ranks.push_back( s.empty() ? -1 : s.rank( throughput ) );
+	if ( ! s.empty() )
+	  known.push_back( ranks.back() );
+      }
+      if ( known.empty() )
+	return;
+
+      // unknown hosts rank like the median of the known ones
+      double median = lowerMedian( known );
+
+      std::vector<std::pair<double,size_t> > order;
+      for ( size_t i = 0; i < urls_r.size(); ++i )
+	order.push_back( std::make_pair( ranks[i] < 0 ? median : ranks[i], i ) );
+      std::stable_sort( order.begin(), order.end(),
+                        []( const std::pair<double,size_t> & lhs, const std::pair<double,size_t> & rhs )
+                        { return lhs.first < rhs.first; } );
+
+      std::vector<Url> ret;
+      ret.reserve( urls_r.size() );
+      for ( const auto & el : order )
+	ret.push_back( urls_r[el.second] );
+      urls_r.swap( ret );
+    }
+
+    void MirrorScoreboard::save()
+    {
+      if ( ! _dirty || _file.empty() )
+	return;
+
+      Pathname tmp( _file.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	for ( const auto & el : _scores )
+	  out << el.first << " " << el.second.throughput << " " << el.second.latency
+	      << " " << el.second.failureRate << " " << Date::ValueType(el.second.lastUpdate) << endl;
+	if ( ! out )
+	{
+	  DBG << "Can't write " << _file << endl;	// e.g. not root
+	  filesystem::unlink( tmp );
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmp, _file ) == 0 )
+	_dirty = false;
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/MirrorScoreboard.h
+ *
+*/
+#ifndef ZYPP_MEDIA_MIRRORSCOREBOARD_H
+#define ZYPP_MEDIA_MIRRORSCOREBOARD_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+#include "zypp/Date.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorScoreboard
+    /// \brief Remember how well the mirrors we downloaded from performed.
+    ///
+    /// Per host an exponentially weighted moving average of the throughput,
+    /// the latency (time to the first byte) and the failure rate is kept.
+    /// \ref order sorts a list of mirrors by the expected time to fetch a
+    /// block from them, so the next download starts with the mirrors that
+    /// worked well the last time.
+    ///
+    /// Hosts not seen for a week are forgotten, so a mirror that was slow
+    /// once gets its chance again.
+    ///
+    /// The \ref instance used by the media backends is stored in
+    /// <tt>repoCachePath/mirrors.scores</tt> below the system root.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorScoreboard : private base::NonCopyable
+    {
+    public:
+      /** The scores of a single host. */
+      struct Score
+      {
+	Score()
+	: throughput( 0 ), latency( 0 ), failureRate( 0 )
+	{}
+	double throughput;	//!< bytes per second (0 if only small files were transferred)
+	double latency;		//!< seconds to the first byte
+	double failureRate;	//!< 0.0 (never failed) ... 1.0 (always failed)
+	Date lastUpdate;
+
+	/** Whether anything is known about the host. */
+	bool empty() const
+	{ return ! lastUpdate; }
+
+	/** Expected seconds to fetch one block (lower is better).
+	 * If the \ref throughput is unknown, \a throughput_r is assumed
+	 * instead; if that's \c 0 too, the latency alone counts. Hosts
+	 * we never received data from are assumed to be slow.
+	 */
+	double rank( double throughput_r = 0 ) const;
+      };
+
+    public:
+      /** Ctor loading the scores from \a file_r (if it exists). */
+      explicit MirrorScoreboard( const Pathname & file_r );
+
+      /** The scoreboard stored in the repo cache. */
+      static MirrorScoreboard & instance();
+
+    public:
+      /** The scores of \a url_r s host. */
+      Score score( const Url & url_r ) const;
+
+      /** Remember a successful transfer from \a url_r. */
+      void success( const Url & url_r, double throughput_r, double latency_r );
+
+      /** Remember a failed transfer from \a url_r. */
+      void failure( const Url & url_r );
+
+      /** Stable sort \a urls_r, best mirrors first.
+       * Hosts without score are ranked like the median of the known ones,
+       * so the original order (e.g. by location) is kept among them.
+       * Hosts with unknown throughput are assumed to have the median
+       * throughput of the known ones.
+       */
+      void order( std::vector<Url> & urls_r ) const;
+
+      /** Write pending changes to the file. */
+      void save();
+
+    private:
+      Pathname _file;
+      std::map<std::string,Score> _scores;
+      bool _dirty;
+    };
+
+    /** \relates MirrorScoreboard::Score Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorScoreboard::Score & obj );
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_MIRRORSCOREBOARD_H
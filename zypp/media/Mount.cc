@@ -11,6 +11,12 @@
 */
 
 #include <mntent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <linux/loop.h>
 
 #include <cstdio>
 #include <climits>
@@ -19,9 +25,16 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
 
 #include "zypp/base/ExternalDataSource.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/Easy.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
 #include "zypp/media/Mount.h"
 #include "zypp/media/MediaException.h"
 
@@ -44,6 +57,285 @@ namespace zypp {
       return str;
     }
 
+    namespace
+    {
+      /** Filesystems needing a mount helper, left to the mount program. */
+      bool needsMountHelper( const std::string & filesystem_r )
+      {
+	if ( filesystem_r == "nfs" || filesystem_r == "nfs4"
+	     || filesystem_r == "cifs" || filesystem_r == "smbfs" )
+	  return true;
+	return PathInfo( "/sbin/mount." + filesystem_r ).isExist();
+      }
+
+      /** The filesystems to try for type "auto" (the ones needing a device). */
+      std::vector<std::string> autoFilesystems()
+      {
+	std::vector<std::string> ret;
+	InputStream in( "/proc/filesystems" );
+	for ( iostr::EachLine line( in ); line; line.next() )
+	{
+	  std::vector<std::string> words;
+	  str::split( *line, std::back_inserter(words) );
+	  if ( words.size() == 1 )	// no "nodev"
+	    ret.push_back( words[0] );
+	}
+	return ret;
+      }
+
+      /** Attach \a file_r to the loop device \a loopdev_r, which is
+       * detached again when it is unmounted.
+       * \return The open loop device, or -1 (errno set).
+       */
+      int attachLoopDevice( const std::string & loopdev_r, const std::string & file_r, bool readonly_r )
+      {
+	int ffd = ::open( file_r.c_str(), ( readonly_r ? O_RDONLY : O_RDWR ) | O_CLOEXEC );
+	if ( ffd < 0 )
+	  return -1;
+	int dfd = ::open( loopdev_r.c_str(), ( readonly_r ? O_RDONLY : O_RDWR ) | O_CLOEXEC );
+	if ( dfd < 0 || ::ioctl( dfd, LOOP_SET_FD, ffd ) != 0 )
+	{
+	  int err = errno;
+	  if ( dfd >= 0 )
+	    ::close( dfd );
+	  ::close( ffd );
+	  errno = err;
+	  return -1;
+	}
+	::close( ffd );
+
+	struct loop_info64 info;
+	memset( &info, 0, sizeof(info) );
+	info.lo_flags = LO_FLAGS_AUTOCLEAR;
+	strncpy( (char *)info.lo_file_name, file_r.c_str(), LO_NAME_SIZE - 1 );
+	if ( ::ioctl( dfd, LOOP_SET_STATUS64, &info ) != 0 )
+	{
+	  int err = errno;
+	  ::ioctl( dfd, LOOP_CLR_FD, 0 );
+	  ::close( dfd );
+	  errno = err;
+	  return -1;
+	}
+	return dfd;
+      }
+
+      /** Mount by the mount(2) system call.
+       * \return \c false if this is better left to the mount program, e.g.
+       * if the filesystem needs a mount helper, we're not root or no loaded
+       * filesystem fits type \c auto.
+       * \throws MediaMountException if mounting failed.
+       */
+      bool nativeMount( const std::string & source_r, const std::string & target_r,
+			const std::string & filesystem_r, const std::string & options_r,
+			const Mount::Environment & environment_r )
+      {
+	if ( ::geteuid() != 0 || ! environment_r.empty() || needsMountHelper( filesystem_r ) )
+	  return false;
+
+	unsigned long flags = 0;
+	bool loop = false;
+	std::string loopdev;
+	std::string data;
+	std::vector<std::string> opts;
+	str::split( options_r, std::back_inserter(opts), "," );
+	for_( it, opts.begin(), opts.end() )
+	{
+	  const std::string & opt( *it );
+	  if ( opt == "ro" )			flags |= MS_RDONLY;
+	  else if ( opt == "rw" )		flags &= ~MS_RDONLY;
+	  else if ( opt == "nosuid" )		flags |= MS_NOSUID;
+	  else if ( opt == "nodev" )		flags |= MS_NODEV;
+	  else if ( opt == "noexec" )		flags |= MS_NOEXEC;
+	  else if ( opt == "sync" )		flags |= MS_SYNCHRONOUS;
+	  else if ( opt == "dirsync" )		flags |= MS_DIRSYNC;
+	  else if ( opt == "noatime" )		flags |= MS_NOATIME;
+	  else if ( opt == "nodiratime" )	flags |= MS_NODIRATIME;
+	  else if ( opt == "relatime" )		flags |= MS_RELATIME;
+	  else if ( opt == "strictatime" )	flags |= MS_STRICTATIME;
+	  else if ( opt == "bind" )		flags |= MS_BIND;
+	  else if ( opt == "loop" )		loop = true;
+	  else if ( str::hasPrefix( opt, "loop=" ) )
+	  {
+	    loop = true;
+	    loopdev = opt.substr( 5 );
+	  }
+	  else if ( opt == "defaults" || opt == "auto" || opt == "noauto" || opt == "nofail" || opt == "_netdev"
+		    || opt == "user" || opt == "users" || opt == "nouser" || opt == "owner" || opt == "group" )
+	    ;	// just for fstab
+	  else if ( ! opt.empty() )
+	  {
+	    if ( ! data.empty() )
+	      data += ",";
+	    data += opt;
+	  }
+	}
+
+	std::string source( source_r );
+	int loopfd = -1;
+	if ( loop )
+	{
+	  if ( loopdev.empty() )
+	    loopdev = Mount::getFreeLoopDevice();
+	  if ( loopdev.empty() )
+	    return false;
+	  loopfd = attachLoopDevice( loopdev, source_r, flags & MS_RDONLY );
+	  if ( loopfd < 0 )
+	  {
+	    WAR << "Can't attach " << source_r << " to " << loopdev << ": " << str::strerror( errno ) << endl;
+	    return false;
+	  }
+	  source = loopdev;
+	}
+
+	std::vector<std::string> filesystems;
+	if ( flags & MS_BIND )
+	  filesystems.push_back( "none" );
+	else if ( filesystem_r == "auto" )
+	  filesystems = autoFilesystems();
+	else
+	  filesystems.push_back( filesystem_r );
+
+	int res = -1;
+	int err = EINVAL;
+	for_( fs, filesystems.begin(), filesystems.end() )
+	{
+	  res = ::mount( source.c_str(), target_r.c_str(), fs->c_str(), flags,
+			 data.empty() ? NULL : data.c_str() );
+	  if ( res == 0 )
+	    break;
+	  err = errno;
+	  if ( err != EINVAL && err != ENODEV )
+	    break;	// not about the filesystem type
+	}
+	if ( res == 0 && ( flags & (MS_BIND|MS_RDONLY) ) == (MS_BIND|MS_RDONLY) )
+	{
+	  // a bind mount gets read-only by remounting it
+	  if ( ::mount( "none", target_r.c_str(), NULL, MS_REMOUNT|MS_BIND|MS_RDONLY, NULL ) != 0 )
+	  {
+	    err = errno;
+	    ::umount2( target_r.c_str(), 0 );
+	    res = -1;
+	  }
+	}
+
+	if ( loopfd >= 0 )
+	{
+	  if ( res != 0 )
+	    ::ioctl( loopfd, LOOP_CLR_FD, 0 );
+	  ::close( loopfd );	// the mount keeps it in use
+	}
+
+	if ( res == 0 )
+	{
+	  MIL << "mounted " << source_r << " " << target_r << endl;
+	  return true;
+	}
+	if ( err == EPERM )
+	  return false;		// e.g. in a container; let the mount program tell
+	if ( filesystem_r == "auto" && ( err == EINVAL || err == ENODEV ) )
+	{
+	  // the mount program probes the type and may load the module
+	  DBG << "no loaded filesystem fits " << source_r << "; trying the mount program" << endl;
+	  return false;
+	}
+
+	std::string msg;
+	switch ( err )
+	{
+	  case EBUSY:		msg = "Media already mounted";			break;
+	  case EACCES:		msg = "Permission denied";			break;
+	  case EINVAL:
+	  case ENODEV:		msg = "Invalid filesystem on media";		break;
+	  case ENOMEDIUM:	msg = "No medium found";			break;
+	  case ENOTDIR:		msg = "Unable to find directory on the media";	break;
+	  default:		msg = "Mounting media failed";			break;
+	}
+	WAR << "mount " << source_r << " " << target_r << ": " << msg << " (" << str::strerror( err ) << ")" << endl;
+	ZYPP_THROW( MediaMountException( msg, source_r, target_r, str::strerror( err ) ) );
+	return false;	// not reached
+      }
+
+      /** Unmount by the umount2(2) system call.
+       * \return \c false if this is better left to the umount program.
+       * \throws MediaUnmountException if unmounting failed.
+       */
+      bool nativeUmount( const std::string & path_r )
+      {
+	if ( ::geteuid() != 0 )
+	  return false;
+	if ( ::umount2( path_r.c_str(), 0 ) == 0 )
+	{
+	  MIL << "unmounted " << path_r << endl;
+	  return true;
+	}
+	int err = errno;
+	if ( err == EPERM )
+	  return false;
+
+	std::string msg( err == EBUSY ? "Device is busy" : "Unmounting media failed" );
+	WAR << "umount " << path_r << ": " << msg << " (" << str::strerror( err ) << ")" << endl;
+	ZYPP_THROW( MediaUnmountException( msg, path_r ) );
+	return false;	// not reached
+      }
+
+      /** The cached mount entries of the running system. */
+      struct MountTableCache
+      {
+	MountTableCache()
+	: fd( ::open( "/proc/self/mountinfo", O_RDONLY|O_CLOEXEC ) )
+	, mtime( 0 )
+	, mtabMtime( 0 )
+	, valid( false )
+	{}
+
+	~MountTableCache()
+	{ if ( fd >= 0 ) ::close( fd ); }
+
+	/** Invalidate the entries if the mount table changed. */
+	void check()
+	{
+	  bool changed = fd < 0;	// no change notification; always re-read
+	  if ( fd >= 0 )
+	  {
+	    struct pollfd pfd;
+	    pfd.fd = fd;
+	    pfd.events = POLLPRI;
+	    pfd.revents = 0;
+	    if ( ::poll( &pfd, 1, 0 ) > 0 && ( pfd.revents & (POLLPRI|POLLERR) ) )
+	      changed = true;	// the event is consumed by polling
+	  }
+
+	  PathInfo mtab( "/etc/mtab", PathInfo::LSTAT );
+	  time_t mtabnow = mtab.isFile() ? mtab.mtime() : 0;
+	  if ( mtabnow != mtabMtime )
+	  {
+	    mtabMtime = mtabnow;
+	    changed = true;
+	  }
+
+	  if ( changed || ! mtime )
+	  {
+	    valid = false;
+	    mtime = std::max( ::time( 0 ), mtime + 1 );	// must differ after every change
+	  }
+	}
+
+	int fd;
+	time_t mtime;
+	time_t mtabMtime;
+	bool valid;
+	MountEntries entries;
+      };
+
+      MountTableCache & mountTableCache()
+      {
+	static MountTableCache _cache;
+	return _cache;
+      }
+
+      MountEntries readEntries( const std::string & mtab );
+    } // namespace
+
 
 Mount::Mount()
 {
@@ -69,6 +361,9 @@ void Mount::mount( const std::string & source,
                    const std::string & options,
                    const Environment & environment )
 {
+    if ( nativeMount( source, target, filesystem, options, environment ) )
+      return;
+
     const char *const argv[] = {
 	"/bin/mount",
 	"-t", filesystem.c_str(),
@@ -161,6 +456,9 @@ void Mount::mount( const std::string & source,
 
 void Mount::umount( const std::string & path )
 {
+    if ( nativeUmount( path ) )
+      return;
+
     const char *const argv[] = {
 	"/bin/umount",
 	path.c_str(),
@@ -273,6 +571,47 @@ void Mount::Kill()
 // STATIC
 MountEntries
 Mount::getEntries(const std::string &mtab)
+{
+  if ( ! mtab.empty() )
+    return readEntries( mtab );
+
+  MountTableCache & cache( mountTableCache() );
+  cache.check();
+  if ( ! cache.valid )
+  {
+    cache.entries = readEntries( mtab );
+    cache.valid = cache.fd >= 0 && ! cache.entries.empty();
+  }
+  return cache.entries;
+}
+
+// STATIC
+time_t
+Mount::getMTime()
+{
+  MountTableCache & cache( mountTableCache() );
+  cache.check();
+  return cache.mtime;
+}
+
+// STATIC
+std::string
+Mount::getFreeLoopDevice()
+{
+  int fd = ::open( "/dev/loop-control", O_RDWR|O_CLOEXEC );
+  if ( fd < 0 )
+    return std::string();
+  int nr = ::ioctl( fd, LOOP_CTL_GET_FREE );
+  ::close( fd );
+  if ( nr < 0 )
+    return std::string();
+  return "/dev/loop" + str::numstring( nr );
+}
+
+    namespace
+    {
+MountEntries
+readEntries(const std::string &mtab)
 {
   MountEntries             entries;
   std::vector<std::string> mtabs;
@@ -366,6 +705,7 @@ Mount::getEntries(const std::string &mtab)
   }
   return entries;
 }
+    } // namespace
 
   } // namespace media
 } // namespace zypp
@@ -19,6 +19,7 @@
 #include <map>
 #include <string>
 #include <iosfwd>
+#include <ctime>
 
 #include "zypp/ExternalProgram.h"
 #include "zypp/KVMap.h"
@@ -65,6 +66,11 @@ namespace zypp {
 
     /**
      * @short Interface to the mount program
+     *
+     * Running as root, local filesystems (including loop mounts) are
+     * mounted and unmounted by the mount(2) and umount2(2) system calls.
+     * Everything else (e.g. nfs and cifs, which need their mount helpers)
+     * is left to the mount program.
      */
     class Mount
     {
@@ -137,6 +143,27 @@ namespace zypp {
 	static MountEntries
 	getEntries(const std::string &mtab = "");
 
+	/**
+	 * Return a time stamp which changes whenever the mount table
+	 * changes. The mount entries of the running system returned by
+	 * \ref getEntries are cached until then.
+	 *
+	 * The kernel reports mount table changes by polling
+	 * /proc/self/mountinfo, so checking for a change does not need to
+	 * read the table. If /etc/mtab is a regular file, its modification
+	 * time is taken into account as well.
+	 */
+	static time_t
+	getMTime();
+
+	/**
+	 * Return the name of an unused loop device (e.g. /dev/loop0), as
+	 * provided by the loop-control device. An empty string if there is
+	 * no loop-control device or it is not accessible.
+	 */
+	static std::string
+	getFreeLoopDevice();
+
     private:
 
 	/** The connection to the mount process.
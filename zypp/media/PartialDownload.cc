@@ -0,0 +1,170 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/PartialDownload.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Digest.h"
+#include "zypp/Date.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/media/PartialDownload.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Partial downloads not touched for this long are removed. */
+      const time_t maxAge = 7 * 24 * 60 * 60;
+
+      /** The file name for \a url_r: <tt>basename-hash.part.zypp</tt> */
+      inline std::string fileName( const std::string & url_r )
+      {
+	Pathname path( Url( url_r ).getPathName() );
+	return str::form( "%s-%s.part.zypp",
+			  path.basename().c_str(),
+			  Digest::digest( Digest::sha1(), url_r ).substr( 0, 16 ).c_str() );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	The state file format:
+    //	  url <url>
+    //	  etag <etag>
+    //	  last-modified <date>
+    //	  size <bytes>
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    Pathname PartialDownload::defaultDir()
+    {
+      return Pathname::assertprefix( ZConfig::instance().systemRoot(), ZConfig::instance().repoCachePath() ) / "partial";
+    }
+
+    PartialDownload::PartialDownload( const Url & url_r )
+    : PartialDownload( defaultDir(), url_r )
+    {}
+
+    PartialDownload::PartialDownload( const Pathname & dir_r, const Url & url_r )
+    : _url( url_r.asString() )
+    , _size( 0 )
+    {
+      _file = dir_r / fileName( _url );
+      _stateFile = _file.extend( ".state" );
+      if ( ! PathInfo( _stateFile ).isFile() )
+	return;
+
+      InputStream in( _stateFile );
+      for ( iostr::EachLine line( in ); line; line.next() )
+      {
+	std::string value( *line );
+	std::string key( str::stripFirstWord( value, true ) );
+	if ( key == "url" )
+	  _stateUrl = value;
+	else if ( key == "etag" )
+	  _validators.etag = value;
+	else if ( key == "last-modified" )
+	  _validators.lastModified = value;
+	else if ( key == "size" )
+	  _size = str::strtonum<off_t>( value );
+      }
+    }
+
+    bool PartialDownload::exists() const
+    { return PathInfo( _file ).isFile(); }
+
+    bool PartialDownload::resumable() const
+    {
+      if ( _stateUrl != _url || ifRange().empty() || ! _size )
+	return false;
+      PathInfo pi( _file );
+      return pi.isFile() && pi.size() > 0 && off_t(pi.size()) < _size;
+    }
+
+    bool PartialDownload::keep( const Pathname & data_r )
+    {
+      discard();
+      if ( filesystem::assert_dir( _file.dirname() ) != 0
+	   || filesystem::hardlinkCopy( data_r, _file ) != 0 )
+      {
+	WAR << "Can't keep " << data_r << " as " << _file << endl;
+	return false;
+      }
+      return true;
+    }
+
+    void PartialDownload::save( const CacheValidators & validators_r, off_t size_r )
+    {
+      _stateUrl = _url;
+      _validators = validators_r;
+      _size = size_r;
+
+      std::ofstream out( _stateFile.c_str() );
+      out << "url " << _url << endl;
+      if ( ! _validators.etag.empty() )
+	out << "etag " << _validators.etag << endl;
+      if ( ! _validators.lastModified.empty() )
+	out << "last-modified " << _validators.lastModified << endl;
+      if ( _size )
+	out << "size " << _size << endl;
+      if ( ! out )
+	WAR << "Can't write " << _stateFile << endl;
+      MIL << "Keep " << *this << endl;
+
+      // forget about downloads not resumed for a long time
+      std::list<std::string> entries;
+      filesystem::readdir( entries, _file.dirname(), false );
+      Date outdated( Date::now() - maxAge );
+      for ( const std::string & entry : entries )
+      {
+	PathInfo pi( _file.dirname() / entry );
+	if ( pi.isFile() && Date( pi.mtime() ) < outdated
+	     && ( str::hasSuffix( entry, ".part.zypp" ) || str::hasSuffix( entry, ".part.zypp.state" ) ) )
+	{
+	  MIL << "Remove outdated " << pi.path() << endl;
+	  filesystem::unlink( pi.path() );
+	}
+      }
+    }
+
+    void PartialDownload::discard()
+    {
+      filesystem::unlink( _file );
+      filesystem::unlink( _stateFile );
+      _stateUrl.clear();
+      _validators = CacheValidators();
+      _size = 0;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PartialDownload & obj )
+    {
+      return str << "PartialDownload(" << obj.file() << " " << PathInfo( obj.file() ).size()
+                 << "/" << obj.size() << " bytes, " << obj.validators() << ")";
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
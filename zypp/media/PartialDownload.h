@@ -0,0 +1,111 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/PartialDownload.h
+ *
+*/
+#ifndef ZYPP_MEDIA_PARTIALDOWNLOAD_H
+#define ZYPP_MEDIA_PARTIALDOWNLOAD_H
+
+#include <sys/types.h>
+#include <iosfwd>
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+#include "zypp/media/ConditionalRequest.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PartialDownload
+    /// \brief The data received by an interrupted download of \a url_r.
+    ///
+    /// The data are kept in a directory surviving the media handlers
+    /// attach point (by default <tt>repoCachePath/partial</tt>), in a file
+    /// named after the url. A small state record (<tt>file.state</tt>)
+    /// remembers the url, the cache validators (\c ETag, \c Last-Modified)
+    /// received with the data and the expected total size. If all of them
+    /// are known, the next attempt can \ref resumable "resume" with a range
+    /// request sending \ref ifRange, so a changed file is sent as a whole.
+    ///
+    /// Without state (e.g. after an interrupted metalink download) the data
+    /// are still useful to seed a \ref MediaBlockList, as the blocks are
+    /// verified by their checksums.
+    ///////////////////////////////////////////////////////////////////
+    class PartialDownload : private base::NonCopyable
+    {
+    public:
+      /** Partial files smaller than this are not worth to be kept. */
+      static const off_t minSize = 64 * 1024;
+
+      /** The directory partial downloads are kept in by default (below the system root). */
+      static Pathname defaultDir();
+
+    public:
+      /** Ctor loading the state of a partial download of \a url_r kept in the \ref defaultDir (if any). */
+      explicit PartialDownload( const Url & url_r );
+
+      /** Ctor loading the state of a partial download of \a url_r kept in \a dir_r (if any). */
+      PartialDownload( const Pathname & dir_r, const Url & url_r );
+
+      /** The file holding the data received so far. */
+      const Pathname & file() const
+      { return _file; }
+
+      /** Whether there are data received so far. */
+      bool exists() const;
+
+      /** Whether the download can be resumed at the end of \ref file. */
+      bool resumable() const;
+
+      /** The cache validators received with the data. */
+      const CacheValidators & validators() const
+      { return _validators; }
+
+      /** The validator to send as \c If-Range when resuming (or empty). */
+      std::string ifRange() const
+      { return _validators.ifRange(); }
+
+      /** The expected total size or \c 0 if unknown. */
+      off_t size() const
+      { return _size; }
+
+      /** Hardlink (or copy) \a data_r to \ref file, replacing a previous partial download. */
+      bool keep( const Pathname & data_r );
+
+      /** Remember \ref file as partial download received with \a validators_r.
+       * Partial downloads in the same directory not touched for a week are removed.
+       */
+      void save( const CacheValidators & validators_r = CacheValidators(), off_t size_r = 0 );
+
+      /** Remove \ref file and the state record. */
+      void discard();
+
+    private:
+      Pathname _file;
+      Pathname _stateFile;
+      std::string _url;
+      std::string _stateUrl;
+      CacheValidators _validators;
+      off_t _size;
+    };
+
+    /** \relates PartialDownload Stream output */
+    std::ostream & operator<<( std::ostream & str, const PartialDownload & obj );
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_PARTIALDOWNLOAD_H
@@ -10,6 +10,7 @@
  *
 */
 #include <iostream>
+#include <map>
 #include "zypp/base/Logger.h"
 #include "zypp/media/UrlResolverPlugin.h"
 #include "zypp/media/MediaException.h"
@@ -28,8 +29,46 @@ namespace zypp
     /** UrlResolverPlugin implementation. */
     struct UrlResolverPlugin::Impl
     {
+      typedef std::map<Pathname,PluginScript> PluginMap;
 
+      /** The running plugins, closed by \ref UrlResolverPlugin::shutdown.
+       * Intentionally never destructed, as closing a plugin during static
+       * destruction would talk to it (and log) after the logger is gone.
+       * Plugins left running just see EOF when we exit.
+       */
+      static PluginMap & plugins()
+      {
+        static PluginMap & _plugins( *new PluginMap );
+        return _plugins;
+      }
 
+      /** Send \a frame_r to the plugin and return its response.
+       * Plugins are kept running for subsequent requests. If a
+       * reused plugin fails (e.g. because it handles just one
+       * request and exits) it is restarted once.
+       */
+      static PluginFrame request( const Pathname & plugin_r, const PluginFrame & frame_r )
+      {
+        PluginScript & scr( plugins()[plugin_r] );
+        bool reused = scr.isOpen();
+        do {
+          if ( ! scr.isOpen() )
+            scr.open( plugin_r );
+          try {
+            scr.send( frame_r );
+            return scr.receive();
+          }
+          catch ( const PluginScriptException & excpt_r )
+          {
+            scr.close();
+            if ( ! reused )
+              throw;
+            ZYPP_CAUGHT( excpt_r );
+            DBG << "Restart plugin " << plugin_r << endl;
+            reused = false;
+          }
+        } while ( true );
+      }
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -42,8 +81,6 @@ namespace zypp
         std::string name = url.getPathName();
         Pathname plugin_path = (ZConfig::instance().pluginsPath()/"urlresolver")/name;    
         if (PathInfo(plugin_path).isExist()) {
-            PluginScript scr;
-            scr.open(plugin_path);
             // send frame to plugin
             PluginFrame f("RESOLVEURL");
 
@@ -54,9 +91,7 @@ namespace zypp
                  ++param_it)
                 f.setHeader(param_it->first, param_it->second);
             
-            scr.send(f);
-
-            PluginFrame r(scr.receive());
+            PluginFrame r(Impl::request(plugin_path, f));
             if (r.command() == "RESOLVEDURL") {
                 // now set
                 url = Url(r.body());
@@ -80,6 +115,16 @@ namespace zypp
         return url;        
     }
 
+    void UrlResolverPlugin::shutdown()
+    {
+      Impl::PluginMap & plugins( Impl::plugins() );
+      if ( ! plugins.empty() )
+      {
+        MIL << "Close " << plugins.size() << " url resolver plugins" << endl;
+        plugins.clear();	// ~PluginScript closes them
+      }
+    }
+
     /** \relates UrlResolverPlugin::Impl Stream output */
     inline std::ostream & operator<<( std::ostream & str, const UrlResolverPlugin::Impl & obj )
     {
@@ -49,6 +49,14 @@ namespace zypp
        */
       static Url resolveUrl(const Url &url, HeaderList &headers);
 
+      /**
+       * Close the plugins kept running by \ref resolveUrl.
+       *
+       * Called when ZYpp is torn down. Plugins needed again
+       * afterwards are simply restarted.
+       */
+      static void shutdown();
+
     public:
       /** Dtor */
       ~UrlResolverPlugin();
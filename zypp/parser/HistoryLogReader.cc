@@ -11,10 +11,17 @@
  *
  */
 #include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
 
 #include "zypp/base/InputStream.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/HistoryLog.h"
 #include "zypp/parser/ParseException.h"
 
 #include "zypp/parser/HistoryLogReader.h"
@@ -41,19 +48,34 @@ namespace zypp
     , _callback( callback_r )
     {}
 
-    bool parseLine( const std::string & line_r, unsigned int lineNr_r );
+    /** Parse and report a record. \a lineNr_r is counted from the end of the file if \a fromEnd_r. */
+    bool parseLine( const std::string & line_r, unsigned int lineNr_r, bool fromEnd_r = false );
 
-    void readAll( const ProgressData::ReceiverFnc & progress_r );
-    void readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r );
-    void readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r );
+    /** Position \a str_r at a line no later than the first record past \a date_r.
+     * Uses the day index maintained by \ref HistoryLog if present, and
+     * bisects the time ordered log otherwise.
+     */
+    void seekDate( std::istream & str_r, const Pathname & file_r, const Date & date_r );
+
+    /** Read records past \a fromDate_r and before \a toDate_r (unless \c 0) from all files. */
+    void read( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r );
+
+    /** Read records past \a fromDate_r and before \a toDate_r (unless \c 0) from a single file.
+     * Returns \c false if no more files need to be read.
+     */
+    bool readFile( const Pathname & file_r, const Date & fromDate_r, const Date & toDate_r, ProgressData & pd_r );
+
+    /** \ref readFile for \ref NEWEST_FIRST: read the file backwards from its end. */
+    bool readFileReverse( const Pathname & file_r, const Date & fromDate_r, const Date & toDate_r, ProgressData & pd_r );
 
     Pathname _filename;
     Options  _options;
     ProcessData _callback;
   };
 
-  bool HistoryLogReader::Impl::parseLine( const std::string & line_r, unsigned lineNr_r )
+  bool HistoryLogReader::Impl::parseLine( const std::string & line_r, unsigned lineNr_r, bool fromEnd_r )
   {
+    const char * where = fromEnd_r ? " from the end" : "";
     // parse into fields
     HistoryLogData::FieldVector fields;
     str::splitEscaped( line_r, std::back_inserter(fields), "|", true );
@@ -71,13 +93,13 @@ namespace zypp
       ZYPP_CAUGHT( excpt );
       if ( _options.testFlag( IGNORE_INVALID_ITEMS ) )
       {
-	WAR << "Ignore invalid history log entry on line #" << lineNr_r << " '"<< line_r << "'" << endl;
+	WAR << "Ignore invalid history log entry on line #" << lineNr_r << where << " '"<< line_r << "'" << endl;
 	return true;
       }
       else
       {
-	ERR << "Invalid history log entry on line #" << lineNr_r << " '"<< line_r << "'" << endl;
-	ParseException newexcpt( str::Str() << "Error in history log on line #" << lineNr_r );
+	ERR << "Invalid history log entry on line #" << lineNr_r << where << " '"<< line_r << "'" << endl;
+	ParseException newexcpt( str::Str() << "Error in history log on line #" << lineNr_r << where );
 	newexcpt.remember( excpt );
 	ZYPP_THROW( newexcpt );
       }
@@ -86,45 +108,224 @@ namespace zypp
     // consume data
     if ( _callback && !_callback( data ) )
     {
-      WAR << "Stop parsing requested by consumer callback on line #" << lineNr_r << endl;
+      WAR << "Stop parsing requested by consumer callback on line #" << lineNr_r << where << endl;
       return false;
     }
     return true;
   }
 
-  void HistoryLogReader::Impl::readAll( const ProgressData::ReceiverFnc & progress_r )
+  ///////////////////////////////////////////////////////////////////
+  namespace
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    /** Bisection stops if the remaining range is smaller. */
+    const std::streamoff bisectLimit = 16*1024;
+
+    /** The day part of a date string (\c %Y-%m-%d). */
+    inline std::string dayOf( const std::string & date_r )
+    { return date_r.substr( 0, 10 ); }
+
+    /** Read the first record starting at or after \a pos_r.
+     * \a pos_r is adjusted to the start of the record and its date
+     * is returned. An empty date is returned if there is no record.
+     */
+    std::string nextRecordDate( std::istream & str_r, std::streamoff & pos_r )
+    {
+      str_r.clear();
+      str_r.seekg( pos_r );
+      std::string line;
+      if ( pos_r && ! std::getline( str_r, line ) )	// skip partial line
+	return std::string();
 
-    ProgressData pd;
-    pd.sendTo( progress_r );
-    pd.toMin();
+      while ( true )
+      {
+	pos_r = str_r.tellg();
+	if ( ! std::getline( str_r, line ) )
+	  break;
+	if ( line.empty() || line[0] == '#' )
+	  continue;
+	return line.substr( 0, line.find('|') );
+      }
+      return std::string();
+    }
 
-    for ( ; line; line.next(), pd.tick() )
+    /** Read the lines of a file backwards, from its end to its beginning, block by block. */
+    class ReverseLineReader
     {
-      // ignore comments
-      if ( (*line)[0] == '#' )
-        continue;
+    public:
+      ReverseLineReader( const Pathname & file_r )
+      : _in( file_r.c_str(), std::ios::in|std::ios::binary )
+      , _pos( 0 )
+      , _lineNo( 0 )
+      {
+	if ( _in.seekg( 0, std::ios::end ) )
+	  _pos = _in.tellg();
+	// a trailing newline does not start another line
+	if ( _pos && read() && _buf[_buf.size()-1] == '\n' )
+	  _buf.erase( _buf.size()-1 );
+      }
 
-      if ( ! parseLine( *line, line.lineNo() ) )
-	break;	// requested by consumer callback
+      /** Get the previous line; \c false at the beginning of the file. */
+      bool prev( std::string & line_r )
+      {
+	while ( true )
+	{
+	  std::string::size_type nl = _buf.rfind( '\n' );
+	  if ( nl != std::string::npos )
+	  {
+	    line_r = _buf.substr( nl+1 );
+	    _buf.erase( nl );
+	    ++_lineNo;
+	    return true;
+	  }
+	  if ( ! _pos || ! read() )
+	  {
+	    if ( _buf.empty() && ! _pos )
+	      return false;
+	    line_r.swap( _buf );	// the first line
+	    _buf.clear();
+	    _pos = 0;
+	    ++_lineNo;
+	    return true;
+	  }
+	}
+      }
+
+      /** Number of the last line returned, counted from the end. */
+      unsigned lineNo() const
+      { return _lineNo; }
+
+    private:
+      /** Prepend the previous block to the buffer. */
+      bool read()
+      {
+	static const std::streamoff blockSize = 64*1024;
+	std::streamoff size = std::min( _pos, blockSize );
+	_pos -= size;
+	std::string block( size, '\0' );
+	_in.clear();
+	if ( ! ( _in.seekg( _pos ) && _in.read( &block[0], size ) ) )
+	{
+	  _pos = 0;
+	  return false;
+	}
+	_buf.insert( 0, block );
+	return true;
+      }
+
+    private:
+      std::ifstream _in;
+      std::streamoff _pos;	///< start of the data in \ref _buf
+      std::string _buf;		///< unsplit data
+      unsigned _lineNo;
+    };
+
+    /** Whether a record of \a day_r starts at \a pos_r (i.e. an index entry is valid). */
+    bool dayStartsAt( std::istream & str_r, std::streamoff pos_r, const std::string & day_r )
+    {
+      str_r.clear();
+      if ( pos_r )
+      {
+	str_r.seekg( pos_r - 1 );
+	if ( str_r.get() != '\n' )
+	  return false;	// not at the start of a line
+      }
+      else
+	str_r.seekg( 0 );
+
+      std::string line;
+      return std::getline( str_r, line ) && dayOf( line ) == day_r;
     }
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
 
-    pd.toMax();
+  void HistoryLogReader::Impl::seekDate( std::istream & str_r, const Pathname & file_r, const Date & date_r )
+  {
+    PathInfo pi( file_r );
+    std::streamoff lo = 0;
+    std::streamoff hi = pi.size();
+    if ( hi <= bisectLimit )
+      return;
+
+    // The day index (if present) narrows the range to bisect.
+    std::string day( dayOf( date_r.form( HISTORY_LOG_DATE_FORMAT ) ) );
+    {
+      Pathname indexfile( file_r.extend( HISTORY_LOG_INDEX_SUFFIX ) );
+      std::ifstream index( indexfile.c_str() );
+      std::streamoff ilo = 0;
+      std::streamoff ihi = hi;
+      std::string iloDay;
+      std::string ihiDay;
+      std::streamoff last = 0;
+      bool valid = true;
+      for ( iostr::EachLine line( index ); line; line.next() )
+      {
+	std::vector<std::string> words;
+	if ( str::split( *line, std::back_inserter(words), "|" ) != 2 )
+	  continue;
+	std::streamoff off = str::strtonum<std::streamoff>( words[1] );
+	if ( off < last || off > hi )
+	{
+	  valid = false;
+	  break;
+	}
+	last = off;
+	if ( words[0] <= day )
+	{
+	  ilo = off;
+	  iloDay = words[0];
+	}
+	else
+	{
+	  ihi = off;
+	  ihiDay = words[0];
+	  break;
+	}
+      }
+
+      // After rotation or truncation an offset may be in range but stale.
+      if ( valid && ! iloDay.empty() && ! dayStartsAt( str_r, ilo, iloDay ) )
+	valid = false;
+      if ( valid && ! ihiDay.empty() && ! dayStartsAt( str_r, ihi, ihiDay ) )
+	valid = false;
+
+      if ( valid )
+      {
+	lo = ilo;
+	hi = ihi;
+      }
+      else
+	WAR << "Ignore stale history log index " << indexfile << endl;	// bisect the whole log
+    }
+
+    // Lines are time ordered: keep lo at the start of a record older than date_r.
+    while ( hi - lo > bisectLimit )
+    {
+      std::streamoff pos = lo + ( hi - lo ) / 2;
+      std::string logdate( nextRecordDate( str_r, pos ) );
+      if ( logdate.empty() || pos >= hi || Date( logdate, HISTORY_LOG_DATE_FORMAT ) >= date_r )
+	hi = lo + ( hi - lo ) / 2;
+      else
+	lo = pos;
+    }
+
+    DBG << "Start reading " << file_r << " at " << lo << " for " << date_r << endl;
+    str_r.clear();
+    str_r.seekg( lo );
   }
 
-  void HistoryLogReader::Impl::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
+  bool HistoryLogReader::Impl::readFile( const Pathname & file_r, const Date & fromDate_r, const Date & toDate_r, ProgressData & pd_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    if ( _options.testFlag( NEWEST_FIRST ) )
+      return readFileReverse( file_r, fromDate_r, toDate_r, pd_r );
 
-    ProgressData pd;
-    pd.sendTo( progress_r );
-    pd.toMin();
+    InputStream is( file_r );
+    if ( fromDate_r && filesystem::zipType( file_r ) == filesystem::ZT_NONE )
+      seekDate( is.stream(), file_r, fromDate_r );
+    iostr::EachLine line( is );
 
-    bool pastDate = false;
-    for ( ; line; line.next(), pd.tick() )
+    bool pastFromDate = ! fromDate_r;
+    bool pastToDate = false;
+    for ( ; line; line.next(), pd_r.tick() )
     {
       const std::string & s = *line;
 
@@ -132,60 +333,104 @@ namespace zypp
       if ( s[0] == '#' )
         continue;
 
-      if ( pastDate )
+      if ( toDate_r || ! pastFromDate )
       {
-	if ( ! parseLine( s, line.lineNo() ) )
-	  break;	// requested by consumer callback
+	Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
+
+	// past toDate - stop reading
+	if ( toDate_r && logDate >= toDate_r )
+	{
+	  pastToDate = true;
+	  break;
+	}
+
+	// past fromDate - start reading
+	if ( ! pastFromDate && logDate > fromDate_r )
+	  pastFromDate = true;
       }
-      else
-      {
-        Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
-        if ( logDate > date_r )
-        {
-          pastDate = true;
-          if ( ! parseLine( s, line.lineNo() ) )
-	    break;	// requested by consumer callback
-        }
-      }
-    }
 
-    pd.toMax();
+      if ( pastFromDate && ! parseLine( s, line.lineNo() ) )
+	return false;	// requested by consumer callback
+    }
+    return ! pastToDate;
   }
 
-  void HistoryLogReader::Impl::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
+  bool HistoryLogReader::Impl::readFileReverse( const Pathname & file_r, const Date & fromDate_r, const Date & toDate_r, ProgressData & pd_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
-
-    ProgressData pd;
-    pd.sendTo( progress_r );
-    pd.toMin();
+    // A compressed (rotated) log can't be read backwards; unpack it first.
+    filesystem::TmpFile unpacked;
+    Pathname file( file_r );
+    if ( filesystem::zipType( file_r ) != filesystem::ZT_NONE )
+    {
+      InputStream is( file_r );
+      std::ofstream out( unpacked.path().c_str() );
+      out << is.stream().rdbuf();
+      file = unpacked.path();
+    }
 
-    bool pastFromDate = false;
-    for ( ; line; line.next(), pd.tick() )
+    ReverseLineReader reader( file );
+    std::string s;
+    while ( reader.prev( s ) )
     {
-      const std::string & s = *line;
+      pd_r.tick();
 
       // ignore comments
-      if ( s[0] == '#' )
+      if ( s.empty() || s[0] == '#' )
         continue;
 
-      Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
+      if ( toDate_r || fromDate_r )
+      {
+	Date logDate( s.substr( 0, s.find('|') ), HISTORY_LOG_DATE_FORMAT );
+
+	// not yet before toDate - skip
+	if ( toDate_r && logDate >= toDate_r )
+	  continue;
 
-      // past toDate - stop reading
-      if ( logDate >= toDate_r )
-        break;
+	// reached fromDate - stop reading (older files too)
+	if ( fromDate_r && logDate <= fromDate_r )
+	  return false;
+      }
 
-      // past fromDate - start reading
-      if ( !pastFromDate && logDate > fromDate_r )
-        pastFromDate = true;
+      if ( ! parseLine( s, reader.lineNo(), true ) )
+	return false;	// requested by consumer callback
+    }
+    // Older logs are read next
+    return true;
+  }
 
-      if ( pastFromDate )
+  void HistoryLogReader::Impl::read( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
+  {
+    std::vector<Pathname> files;
+    bool pastToDate = false;
+    if ( _options.testFlag( READ_ROTATED ) )
+    {
+      for ( const auto & rotated : HistoryLog::rotatedLogs( _filename ) )
       {
-	if ( ! parseLine( s, line.lineNo() ) )
-	  break;	// requested by consumer callback
+	// a rotated log contains records older than its rotation date
+	if ( fromDate_r && rotated.first <= fromDate_r )
+	  continue;
+	files.push_back( rotated.second );
+	if ( toDate_r && rotated.first >= toDate_r )
+	{
+	  pastToDate = true;
+	  break;
+	}
       }
     }
+    if ( ! pastToDate )
+      files.push_back( _filename );
+    if ( _options.testFlag( NEWEST_FIRST ) )
+      std::reverse( files.begin(), files.end() );
+
+    ProgressData pd;
+    pd.sendTo( progress_r );
+    pd.toMin();
+
+    for ( const Pathname & file : files )
+    {
+      if ( ! readFile( file, fromDate_r, toDate_r, pd ) )
+	break;
+    }
 
     pd.toMax();
   }
@@ -210,13 +455,13 @@ namespace zypp
   { return _pimpl->_options.testFlag( IGNORE_INVALID_ITEMS ); }
 
   void HistoryLogReader::readAll( const ProgressData::ReceiverFnc & progress_r )
-  { _pimpl->readAll( progress_r ); }
+  { _pimpl->read( Date(), Date(), progress_r ); }
 
   void HistoryLogReader::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
-  { _pimpl->readFrom( date_r, progress_r ); }
+  { _pimpl->read( date_r, Date(), progress_r ); }
 
   void HistoryLogReader::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
-  { _pimpl->readFromTo( fromDate_r, toDate_r, progress_r ); }
+  { _pimpl->read( fromDate_r, toDate_r, progress_r ); }
 
   } // namespace parser
   ///////////////////////////////////////////////////////////////////
@@ -62,6 +62,10 @@ namespace zypp
   /// \endcode
   /// \see \ref HistoryLogData for how to access the individual data fields.
   ///
+  /// With \ref READ_ROTATED the (compressed) logs rotated by \ref HistoryLog
+  /// are read as well, as if they were part of the history file. Records are
+  /// reported oldest first, unless \ref NEWEST_FIRST is set.
+  ///
   ///////////////////////////////////////////////////////////////////
   class HistoryLogReader
   {
@@ -69,7 +73,9 @@ namespace zypp
 
     enum OptionBits	///< Parser option flags
     {
-      IGNORE_INVALID_ITEMS	= (1 << 0)	///< ignore invalid items and continue parsing
+      IGNORE_INVALID_ITEMS	= (1 << 0),	///< ignore invalid items and continue parsing
+      READ_ROTATED		= (1 << 1),	///< also read the rotated logs (\see \ref HistoryLog::rotatedLogs)
+      NEWEST_FIRST		= (1 << 2)	///< report the newest records first
     };
     ZYPP_DECLARE_FLAGS( Options, OptionBits );
 
@@ -97,6 +103,11 @@ namespace zypp
     /**
      * Read log from specified \a date.
      *
+     * The log is expected to be time ordered. Unless the file is small,
+     * reading does not start at the beginning of the file. It starts at
+     * the offset found in the day index maintained by \ref HistoryLog
+     * (\c history.idx), or found by bisecting the file.
+     *
      * \param date     Date from which to read.
      * \param progress An optional progress data receiver function.
      *
@@ -119,6 +130,9 @@ namespace zypp
      * will yield log entries from midnight of January, 1st untill
      * one second before midnight of January, 2nd.
      *
+     * Like \ref readFrom, this seeks to \a fromDate rather than reading
+     * the log from the beginning.
+     *
      * \param fromDate Date from which to read.
      * \param toDate   Date on which to stop reading.
      * \param progress An optional progress data receiver function.
@@ -33,15 +33,15 @@ namespace zypp
     class ServiceFileReader::Impl
     {
     public:
-      static void parseServices( const Pathname & file,
+      static void parseServices( const InputStream & is,
           const ServiceFileReader::ProcessService & callback );
     };
 
-    void ServiceFileReader::Impl::parseServices( const Pathname & file,
+    void ServiceFileReader::Impl::parseServices( const InputStream & is,
                                   const ServiceFileReader::ProcessService & callback/*,
                                   const ProgressData::ReceiverFnc &progress*/ )
     {
-      InputStream is(file);
+      const Pathname & file( is.path() );
       if( is.stream().fail() )
       {
         ZYPP_THROW(Exception("Failed to open service file"));
@@ -159,10 +159,16 @@ namespace zypp
                                     const ProcessService & callback/*,
                                     const ProgressData::ReceiverFnc &progress */)
     {
-      Impl::parseServices(repo_file, callback/*, progress*/);
+      Impl::parseServices(InputStream(repo_file), callback/*, progress*/);
       //MIL << "Done" << endl;
     }
 
+    ServiceFileReader::ServiceFileReader( const InputStream & is,
+                                    const ProcessService & callback )
+    {
+      Impl::parseServices(is, callback);
+    }
+
     ServiceFileReader::~ServiceFileReader()
     {}
 
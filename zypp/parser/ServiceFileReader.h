@@ -23,6 +23,7 @@ namespace zypp
 { /////////////////////////////////////////////////////////////////
 
   class ServiceInfo;
+  class InputStream;
   ///////////////////////////////////////////////////////////////////
   namespace parser
   { /////////////////////////////////////////////////////////////////
@@ -70,6 +71,13 @@ namespace zypp
       */
       ServiceFileReader( const Pathname & serviceFile,
                       const ProcessService & callback);
+
+     /**
+      * \short Constructor reading from a stream.
+      * The services \ref ServiceInfo::filepath is the streams \c path().
+      */
+      ServiceFileReader( const InputStream & is,
+                      const ProcessService & callback);
      
       /**
        * Dtor
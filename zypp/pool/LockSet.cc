@@ -0,0 +1,365 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/LockSet.cc
+ *
+*/
+#include <iostream>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Function.h"
+#include "zypp/base/StrMatcher.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/Repository.h"
+
+#include "zypp/pool/LockSet.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** The name a query sees with \ref Match::SKIP_KIND (like libsolv strips it). */
+      inline const char * nameSkipKind( const char * ident_r )
+      {
+	const char * s = ident_r;
+	while ( *s >= 'a' && *s <= 'z' )
+	  ++s;
+	return( *s == ':' && s != ident_r ? s+1 : ident_r );
+      }
+
+      inline std::string lower( const char * str_r )
+      {
+	std::string ret( str_r );
+	for_( it, ret.begin(), ret.end() )
+	  if ( *it >= 'A' && *it <= 'Z' )
+	    *it += 'a' - 'A';
+	return ret;
+      }
+
+      inline unsigned char lower( unsigned char ch_r )
+      { return ch_r >= 'A' && ch_r <= 'Z' ? ch_r + 'a' - 'A' : ch_r; }
+
+      /** Whether \a glob_r contains no wildcards (i.e. matches itself only). */
+      inline bool isLiteralGlob( const std::string & glob_r )
+      { return glob_r.find_first_of( "*?[\\" ) == std::string::npos; }
+
+      /** Everything but the name a simple query looks at. */
+      struct Restriction
+      {
+	Restriction( const PoolQuery & query_r )
+	: kinds( query_r.kinds() )
+	, repos( query_r.repos() )
+	, op( query_r.editionRel() )
+	, edition( query_r.edition() )
+	, status( query_r.statusFilterFlags() )
+	{}
+
+	bool operator()( sat::Solvable solv_r ) const
+	{
+	  if ( status && ( ( status == PoolQuery::INSTALLED_ONLY ) != solv_r.isSystem() ) )
+	    return false;
+	  if ( ! repos.empty() && repos.find( solv_r.repository().alias() ) == repos.end() )
+	    return false;
+	  if ( ! kinds.empty() && ! solv_r.isKind( kinds.begin(), kinds.end() ) )
+	    return false;
+	  if ( op != Rel::ANY && ! compareByRel( op, solv_r.edition(), edition, Edition::Match() ) )
+	    return false;
+	  return true;
+	}
+
+	PoolQuery::Kinds kinds;
+	PoolQuery::StrContainer repos;
+	Rel op;
+	Edition edition;
+	PoolQuery::StatusFilter status;
+      };
+
+      /** A pattern matching names, with its literal prefix. */
+      struct Pattern
+      {
+	Pattern( unsigned idx_r, const std::string & prefix_r, const StrMatcher & matcher_r )
+	: idx( idx_r ), prefix( prefix_r ), matcher( matcher_r )
+	{}
+
+	unsigned idx;
+	std::string prefix;
+	StrMatcher matcher;
+      };
+      typedef std::vector<Pattern> Patterns;
+
+      typedef std::unordered_map<std::string, std::vector<unsigned> > NameIndex;
+
+      /** Whether \a query_r looks at the solvables name only, i.e. it is
+       * equivalent to a query built from the name values and the
+       * \ref Restriction.
+       */
+      bool isNameQuery( const PoolQuery & query_r )
+      {
+	if ( query_r.attributes().size() != 1 || ! query_r.strings().empty() )
+	  return false;
+	const PoolQuery::StrContainer & names( query_r.attribute( sat::SolvAttr::name ) );
+	if ( names.empty() || names.find( "" ) != names.end() )
+	  return false;	// an empty string matches everything
+	if ( query_r.matchWord() || ! query_r.flags().test( Match::SKIP_KIND ) )
+	  return false;
+
+	PoolQuery q;
+	for_( it, names.begin(), names.end() )
+	  q.addAttribute( sat::SolvAttr::name, *it );
+	for_( it, query_r.kinds().begin(), query_r.kinds().end() )
+	  q.addKind( *it );
+	for_( it, query_r.repos().begin(), query_r.repos().end() )
+	  q.addRepo( *it );
+	q.setEdition( query_r.edition(), query_r.editionRel() );
+	q.setStatusFilterFlags( query_r.statusFilterFlags() );
+	q.setFlags( query_r.flags() );
+	return q == query_r;	// e.g. no dependency predicates
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class LockSet::Impl
+    /// \brief LockSet implementation.
+    ///////////////////////////////////////////////////////////////////
+    class LockSet::Impl
+    {
+    public:
+      void add( const PoolQuery & query_r )
+      {
+	unsigned idx = _queries.size();
+	_queries.push_back( query_r );
+	if ( isNameQuery( query_r ) && compile( idx, query_r ) )
+	  return;
+	_other.push_back( idx );
+      }
+
+      /** Pass each match to \a fnc_r (maybe more than once). */
+      void evaluate( const function<void(unsigned, sat::Solvable)> & fnc_r ) const
+      {
+	for_( it, _other.begin(), _other.end() )
+	{
+	  try
+	  {
+	    const PoolQuery & query( _queries[*it] );
+	    for_( solv, query.begin(), query.end() )
+	      fnc_r( *it, *solv );
+	  }
+	  catch ( const Exception & excpt )
+	  {
+	    ZYPP_CAUGHT( excpt );	// like PoolQueryResult: no matches
+	  }
+	}
+
+	if ( _restrictions.empty() )
+	  return;	// nothing compiled
+
+	for_( it, sat::Pool::instance().solvablesBegin(), sat::Pool::instance().solvablesEnd() )
+	{
+	  sat::Solvable solv( *it );
+	  const char * name = nameSkipKind( solv.ident().c_str() );
+
+	  if ( ! _exact.empty() )
+	    lookup( _exact, name, solv, fnc_r );
+	  if ( ! _exactNocase.empty() )
+	    lookup( _exactNocase, lower( name ), solv, fnc_r );
+
+	  unsigned char first = *name;
+	  match( _patterns[first], name, false, solv, fnc_r );
+	  match( _patternsNocase[lower( first )], name, true, solv, fnc_r );
+	  match( _patternsAny, name, false, solv, fnc_r );
+	}
+      }
+
+      const std::vector<PoolQuery> & queries() const
+      { return _queries; }
+
+      unsigned compiledCount() const
+      { return _queries.size() - _other.size(); }
+
+    private:
+      /** Add a name query to the lookup tables.
+       * \return \c false if it can't be compiled.
+       */
+      bool compile( unsigned idx_r, const PoolQuery & query_r )
+      {
+	bool nocase = ! query_r.caseSensitive();
+	Match::Mode mode = query_r.matchMode();
+	const PoolQuery::StrContainer & names( query_r.attribute( sat::SolvAttr::name ) );
+
+	std::vector<Pattern> patterns;
+	std::vector<std::string> exact;
+	for_( it, names.begin(), names.end() )
+	{
+	  if ( mode == Match::STRING || ( mode == Match::GLOB && isLiteralGlob( *it ) ) )
+	  {
+	    exact.push_back( *it );
+	    continue;
+	  }
+
+	  std::string prefix;
+	  if ( mode == Match::GLOB )
+	    prefix = it->substr( 0, it->find_first_of( "*?[\\" ) );
+	  else if ( mode != Match::SUBSTRING && mode != Match::REGEX )
+	    return false;
+
+	  Match flags( mode );
+	  if ( nocase )
+	    flags |= Match::NOCASE;
+	  StrMatcher matcher( *it, flags );
+	  try
+	  {
+	    matcher.compile();
+	  }
+	  catch ( const Exception & excpt )
+	  {
+	    ZYPP_CAUGHT( excpt );
+	    return false;	// PoolQuery will report it
+	  }
+	  patterns.push_back( Pattern( idx_r, prefix, matcher ) );
+	}
+
+	_restrictions.insert( std::make_pair( idx_r, Restriction( query_r ) ) );
+	for_( it, exact.begin(), exact.end() )
+	{
+	  if ( nocase )
+	    _exactNocase[lower( it->c_str() )].push_back( idx_r );
+	  else
+	    _exact[*it].push_back( idx_r );
+	}
+	for_( it, patterns.begin(), patterns.end() )
+	{
+	  if ( it->prefix.empty() )
+	    _patternsAny.push_back( *it );
+	  else if ( nocase )
+	    _patternsNocase[lower( (unsigned char)it->prefix[0] )].push_back( *it );
+	  else
+	    _patterns[(unsigned char)it->prefix[0]].push_back( *it );
+	}
+	return true;
+      }
+
+      void lookup( const NameIndex & index_r, const std::string & name_r, sat::Solvable solv_r,
+		   const function<void(unsigned, sat::Solvable)> & fnc_r ) const
+      {
+	NameIndex::const_iterator found( index_r.find( name_r ) );
+	if ( found == index_r.end() )
+	  return;
+	for_( it, found->second.begin(), found->second.end() )
+	{
+	  if ( _restrictions.find( *it )->second( solv_r ) )
+	    fnc_r( *it, solv_r );
+	}
+      }
+
+      void match( const Patterns & patterns_r, const char * name_r, bool nocase_r, sat::Solvable solv_r,
+		  const function<void(unsigned, sat::Solvable)> & fnc_r ) const
+      {
+	for_( it, patterns_r.begin(), patterns_r.end() )
+	{
+	  const std::string & prefix( it->prefix );
+	  if ( ! prefix.empty()
+	       && ( nocase_r ? ::strncasecmp( name_r, prefix.c_str(), prefix.size() )
+			     : ::strncmp( name_r, prefix.c_str(), prefix.size() ) ) != 0 )
+	    continue;
+	  if ( it->matcher( name_r ) && _restrictions.find( it->idx )->second( solv_r ) )
+	    fnc_r( it->idx, solv_r );
+	}
+      }
+
+    private:
+      std::vector<PoolQuery> _queries;
+      /** Indices of the queries to execute. */
+      std::vector<unsigned> _other;
+      /** The restrictions of the compiled queries. */
+      std::map<unsigned, Restriction> _restrictions;
+      NameIndex _exact;
+      NameIndex _exactNocase;
+      /** Patterns by the first char of their prefix (lowercase if case insensitive). */
+      Patterns _patterns[256];
+      Patterns _patternsNocase[256];
+      /** Patterns without prefix. */
+      Patterns _patternsAny;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : LockSet
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    LockSet::LockSet()
+    : _pimpl( new Impl )
+    {}
+
+    LockSet::~LockSet()
+    {}
+
+    void LockSet::add( const PoolQuery & query_r )
+    { _pimpl->add( query_r ); }
+
+    bool LockSet::empty() const
+    { return _pimpl->queries().empty(); }
+
+    LockSet::size_type LockSet::size() const
+    { return _pimpl->queries().size(); }
+
+    namespace
+    {
+      struct CollectAll
+      {
+	CollectAll( PoolQueryResult & result_r ) : _result( result_r ) {}
+	void operator()( unsigned, sat::Solvable solv_r ) const
+	{ _result += solv_r; }
+	PoolQueryResult & _result;
+      };
+
+      struct CollectEach
+      {
+	CollectEach( std::vector<PoolQueryResult> & results_r ) : _results( results_r ) {}
+	void operator()( unsigned idx_r, sat::Solvable solv_r ) const
+	{ _results[idx_r] += solv_r; }
+	std::vector<PoolQueryResult> & _results;
+      };
+    } // namespace
+
+    PoolQueryResult LockSet::result() const
+    {
+      PoolQueryResult ret;
+      _pimpl->evaluate( CollectAll( ret ) );
+      return ret;
+    }
+
+    std::vector<PoolQueryResult> LockSet::results() const
+    {
+      std::vector<PoolQueryResult> ret( size() );
+      _pimpl->evaluate( CollectEach( ret ) );
+      return ret;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const LockSet & obj )
+    {
+      return str << "LockSet(" << obj.size() << " queries, "
+		 << obj._pimpl->compiledCount() << " compiled)";
+    }
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,102 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/LockSet.h
+ *
+*/
+#ifndef ZYPP_POOL_LOCKSET_H
+#define ZYPP_POOL_LOCKSET_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/Easy.h"
+#include "zypp/PoolQuery.h"
+#include "zypp/PoolQueryResult.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class LockSet
+    /// \brief A set of lock queries, evaluated in one pass over the pool.
+    ///
+    /// Executing each \ref PoolQuery on its own walks the whole pool
+    /// once per query. Most locks however just look at the solvables
+    /// name (optionally restricted by kind, repo, edition or status):
+    /// \li Names matched exactly (or by a glob without wildcards) are
+    ///     looked up in a hash table.
+    /// \li Glob, regex and substring matches are grouped by the first
+    ///     character of their literal prefix, so a name is just matched
+    ///     against the patterns that may match it.
+    ///
+    /// All of them are evaluated in a single walk over the pool. Any
+    /// other query is executed as usual.
+    ///
+    /// \code
+    ///   PoolQueryResult locked( LockSet( queries.begin(), queries.end() ).result() );
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class LockSet
+    {
+      friend std::ostream & operator<<( std::ostream & str, const LockSet & obj );
+
+    public:
+      typedef std::vector<PoolQuery>::size_type size_type;
+
+    public:
+      /** Default ctor: empty set. */
+      LockSet();
+
+      /** Ctor adding a range of \ref PoolQuery. */
+      template<class TIterator>
+      LockSet( TIterator begin_r, TIterator end_r )
+      : LockSet()
+      {
+	for_( it, begin_r, end_r )
+	  add( *it );
+      }
+
+      /** Dtor */
+      ~LockSet();
+
+    public:
+      /** Add \a query_r. Its index in \ref results is the number of queries added before. */
+      void add( const PoolQuery & query_r );
+
+      /** Whether the set is empty. */
+      bool empty() const;
+
+      /** The number of queries. */
+      size_type size() const;
+
+    public:
+      /** The solvables matched by any of the queries. */
+      PoolQueryResult result() const;
+
+      /** The solvables matched by each of the queries (in the order they were added). */
+      std::vector<PoolQueryResult> results() const;
+
+    public:
+      class Impl;              ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+    };
+
+    /** \relates LockSet Stream output */
+    std::ostream & operator<<( std::ostream & str, const LockSet & obj );
+
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_POOL_LOCKSET_H
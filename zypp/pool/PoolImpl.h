@@ -20,6 +20,7 @@
 #include "zypp/APIConfig.h"
 
 #include "zypp/pool/PoolTraits.h"
+#include "zypp/pool/LockSet.h"
 #include "zypp/ResPoolProxy.h"
 #include "zypp/PoolQueryResult.h"
 
@@ -229,11 +230,7 @@ namespace zypp
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
           MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
-          PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
-          {
-            locked += *it;
-          }
+          PoolQueryResult locked( LockSet( _hardLockQueries.begin(), _hardLockQueries.end() ).result() );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
           for_( it, begin(), end() )
           {
@@ -246,11 +243,7 @@ namespace zypp
           MIL << "Apply " << newLocks_r.size() << " HardLockQueries" << endl;
           _hardLockQueries = newLocks_r;
           // now adjust the pool status
-          PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
-          {
-            locked += *it;
-          }
+          PoolQueryResult locked( LockSet( _hardLockQueries.begin(), _hardLockQueries.end() ).result() );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
           for_( it, begin(), end() )
           {
@@ -356,21 +349,28 @@ namespace zypp
         }
 
 	const Id2ItemT & id2item () const
+	{ return *id2itemPtr(); }
+
+	/** The ident index, shared with \ref ResPoolProxy.
+	 * Once built, it is never modified. A changed pool gets a new one.
+	 */
+	shared_ptr<const Id2ItemT> id2itemPtr () const
 	{
 	  checkSerial();
 	  if ( _id2itemDirty )
 	  {
 	    store();
-	    _id2item = Id2ItemT( size() );
+	    shared_ptr<Id2ItemT> id2item( new Id2ItemT( size() ) );
             for_( it, begin(), end() )
             {
               const sat::Solvable &s = (*it)->satSolvable();
               sat::detail::IdType id = s.ident().id();
               if ( s.isKind( ResKind::srcpackage ) )
                 id = -id;
-              _id2item.insert( std::make_pair( id, *it ) );
+              id2item->insert( std::make_pair( id, *it ) );
             }
-            //INT << _id2item << endl;
+            //INT << *id2item << endl;
+	    _id2item = id2item;
 	    _id2itemDirty = false;
           }
 	  return _id2item;
@@ -391,7 +391,7 @@ namespace zypp
         {
           _storeDirty = true;
 	  _id2itemDirty = true;
-	  _id2item.clear();
+	  _id2item.reset();
           _poolProxy.reset();
         }
 
@@ -400,7 +400,7 @@ namespace zypp
         SerialNumberWatcher                   _watcher;
         mutable ContainerT                    _store;
         mutable DefaultIntegral<bool,true>    _storeDirty;
-	mutable Id2ItemT		      _id2item;
+	mutable shared_ptr<const Id2ItemT>    _id2item;
         mutable DefaultIntegral<bool,true>    _id2itemDirty;
 
       private:
@@ -0,0 +1,267 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/ConfigDirSnapshot.cc
+ *
+*/
+extern "C"
+{
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+}
+#include <cerrno>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <list>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Gettext.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Exception.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/repo/ConfigDirSnapshot.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      const char * const snapshotMagic = "zypp-config-snapshot 1";
+
+      /** Files modified less than this ago are not written to the snapshot. */
+      const long long racyNanoseconds = 2000000000LL;
+
+      inline long long nanoseconds( const struct timespec & ts_r )
+      { return ts_r.tv_sec * 1000000000LL + ts_r.tv_nsec; }
+
+      /** The stat data identifying a files version. */
+      struct Stamp
+      {
+	Stamp()
+	: isFile( false ), ino( 0 ), size( 0 ), mtime( 0 ), ctime( 0 )
+	{}
+
+	bool operator==( const Stamp & rhs ) const
+	{ return ino == rhs.ino && size == rhs.size && mtime == rhs.mtime && ctime == rhs.ctime; }
+
+	bool operator!=( const Stamp & rhs ) const
+	{ return ! ( *this == rhs ); }
+
+	/** Modified shortly before \a now_r? */
+	bool racy( long long now_r ) const
+	{ return std::max( mtime, ctime ) + racyNanoseconds > now_r; }
+
+	bool isFile;
+	unsigned long long ino;
+	long long size;
+	long long mtime;
+	long long ctime;
+      };
+
+      std::ostream & operator<<( std::ostream & str, const Stamp & obj )
+      { return str << obj.ino << ' ' << obj.size << ' ' << obj.mtime << ' ' << obj.ctime; }
+
+      std::istream & operator>>( std::istream & str, Stamp & obj )
+      { return str >> obj.ino >> obj.size >> obj.mtime >> obj.ctime; }
+
+      bool stamp( const Pathname & path_r, Stamp & stamp_r )
+      {
+	struct stat st;
+	if ( ::stat( path_r.c_str(), &st ) != 0 )
+	  return false;
+	stamp_r.isFile = S_ISREG( st.st_mode );
+	stamp_r.ino    = st.st_ino;
+	stamp_r.size   = st.st_size;
+	stamp_r.mtime  = nanoseconds( st.st_mtim );
+	stamp_r.ctime  = nanoseconds( st.st_ctim );
+	return true;
+      }
+
+      /** Name and stamp of the regular files in a directory. */
+      typedef std::vector<std::pair<std::string,Stamp> > Stamps;
+
+      /** Parse the snapshot if it matches \a dirStamp_r and \a stamps_r. */
+      bool readSnapshot( const Pathname & snapshot_r, const Pathname & dir_r,
+			 const Stamp & dirStamp_r, const Stamps & stamps_r,
+			 ConfigDirSnapshot::Files & files_r )
+      {
+	std::ifstream in( snapshot_r.c_str() );
+	if ( ! in )
+	  return false;
+
+	std::string line;
+	if ( ! std::getline( in, line ) || line != snapshotMagic )
+	  return false;
+
+	Stamp stamp;
+	std::string name;
+	if ( ! ( std::getline( in, line ) && line == dir_r.asString() && in >> stamp ) || stamp != dirStamp_r )
+	  return false;
+
+	ConfigDirSnapshot::Files files;
+	files.reserve( stamps_r.size() );
+	for_( it, stamps_r.begin(), stamps_r.end() )
+	{
+	  std::string::size_type len = 0;
+	  if ( ! ( in >> stamp >> len ) || stamp != it->second || in.get() != ' ' )
+	    return false;
+	  if ( ! std::getline( in, name ) || name != it->first )
+	    return false;
+	  std::string content( len, '\0' );
+	  if ( len && ! in.read( &content[0], len ) )
+	    return false;
+	  files.push_back( ConfigDirSnapshot::File( dir_r / name, std::string() ) );
+	  files.back().second.swap( content );
+	}
+	// no more files
+	if ( in >> stamp )
+	  return false;
+
+	files_r.swap( files );
+	return true;
+      }
+
+      /** Write the snapshot (readable for the owner only). */
+      void writeSnapshot( const Pathname & snapshot_r, const Pathname & dir_r,
+			  const Stamp & dirStamp_r, const Stamps & stamps_r,
+			  const ConfigDirSnapshot::Files & files_r )
+      {
+	std::ostringstream str;
+	str << snapshotMagic << endl << dir_r.asString() << endl << dirStamp_r;
+	for ( Stamps::size_type i = 0; i < stamps_r.size(); ++i )
+	{
+	  str << endl << stamps_r[i].second << ' ' << files_r[i].second.size() << ' ' << stamps_r[i].first << endl;
+	  str << files_r[i].second;
+	}
+	str << endl;
+	const std::string & data( str.str() );
+
+	Pathname tmp( snapshot_r.extend( ".new" ) );
+	filesystem::unlink( tmp );
+	int fd = ::open( tmp.c_str(), O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, 0600 );
+	if ( fd < 0 )
+	{
+	  DBG << "Can not write snapshot " << snapshot_r << ": " << str::strerror( errno ) << endl;
+	  return;
+	}
+	const char * buf = data.c_str();
+	std::string::size_type left = data.size();
+	while ( left )
+	{
+	  ssize_t written = ::write( fd, buf, left );
+	  if ( written < 0 )
+	  {
+	    if ( errno == EINTR )
+	      continue;
+	    break;
+	  }
+	  buf += written;
+	  left -= written;
+	}
+	if ( ::close( fd ) != 0 || left || filesystem::rename( tmp, snapshot_r ) != 0 )
+	{
+	  WAR << "Failed to write snapshot " << snapshot_r << endl;
+	  filesystem::unlink( tmp );
+	  return;
+	}
+	MIL << "Wrote snapshot " << snapshot_r << " of " << files_r.size() << " files in " << dir_r << endl;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ConfigDirSnapshot::ConfigDirSnapshot( const Pathname & dir_r, const Pathname & snapshot_r )
+    : _dir( dir_r )
+    , _fromSnapshot( false )
+    {
+      Stamp dirStamp;
+      std::list<std::string> entries;
+      if ( ! stamp( dir_r, dirStamp ) || filesystem::readdir( entries, dir_r, false ) != 0 )
+      {
+	// TranslatorExplanation '%s' is a pathname
+	ZYPP_THROW( Exception( str::form( _("Failed to read directory '%s'"), dir_r.c_str() ) ) );
+      }
+
+      Stamps stamps;
+      stamps.reserve( entries.size() );
+      bool canSnapshot = true;
+      for_( it, entries.begin(), entries.end() )
+      {
+	if ( it->find( '\n' ) != std::string::npos )
+	  canSnapshot = false;	// not representable in the snapshot
+	Stamp fileStamp;
+	if ( stamp( dir_r / *it, fileStamp ) && fileStamp.isFile )
+	  stamps.push_back( std::make_pair( *it, fileStamp ) );
+      }
+
+      if ( ! canSnapshot )
+      {
+	WAR << "Not using a snapshot for " << dir_r << endl;
+      }
+      else if ( ! snapshot_r.empty() && readSnapshot( snapshot_r, dir_r, dirStamp, stamps, _files ) )
+      {
+	_fromSnapshot = true;
+	MIL << "Read " << _files.size() << " files in " << dir_r << " from snapshot " << snapshot_r << endl;
+	return;
+      }
+
+      // read the files
+      bool complete = true;
+      _files.reserve( stamps.size() );
+      for_( it, stamps.begin(), stamps.end() )
+      {
+	Pathname file( dir_r / it->first );
+	InputStream in( file );
+	std::ostringstream content;
+	if ( in.stream().fail() )
+	  complete = false;
+	else if ( in.stream().peek() != EOF )
+	  content << in.stream().rdbuf();
+	_files.push_back( File( file, content.str() ) );
+      }
+
+      if ( snapshot_r.empty() || ! canSnapshot || ! complete || ! PathInfo( snapshot_r.dirname() ).isDir() )
+	return;
+
+      struct timespec now;
+      ::clock_gettime( CLOCK_REALTIME, &now );
+      bool racy = dirStamp.racy( nanoseconds( now ) );
+      for ( Stamps::const_iterator it = stamps.begin(); ! racy && it != stamps.end(); ++it )
+	racy = it->second.racy( nanoseconds( now ) );
+
+      if ( racy )
+      {
+	filesystem::unlink( snapshot_r );	// outdated anyway
+	DBG << "Recently modified files in " << dir_r << ": don't write snapshot " << snapshot_r << endl;
+      }
+      else
+	writeSnapshot( snapshot_r, dir_r, dirStamp, stamps, _files );
+    }
+
+    std::ostream & operator<<( std::ostream & str, const ConfigDirSnapshot & obj )
+    {
+      return str << "ConfigDirSnapshot(" << obj._dir << ": " << obj._files.size() << " files"
+		 << ( obj.fromSnapshot() ? ", from snapshot)" : ")" );
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/ConfigDirSnapshot.h
+ *
+*/
+#ifndef ZYPP_REPO_CONFIGDIRSNAPSHOT_H
+#define ZYPP_REPO_CONFIGDIRSNAPSHOT_H
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class ConfigDirSnapshot
+    /// \brief The content of all files in a config directory (e.g. \c repos.d).
+    ///
+    /// Reading hundreds of small config files is slow, so the content of
+    /// all files is additionally stored in a single snapshot file. The
+    /// snapshot is used as long as the directory and all the files in it
+    /// (inode, size, mtime and ctime) are unchanged. Otherwise the files
+    /// are read and the snapshot is rewritten. The files in the directory
+    /// remain the source of truth.
+    ///
+    /// The snapshot is written readable for the owner only, as config files
+    /// may contain credentials. It is not written if a file was modified
+    /// within the last seconds, because a further modification might not
+    /// be detectable on file systems with coarse timestamps.
+    ///
+    /// \code
+    ///   repo::ConfigDirSnapshot snapshot( "/etc/zypp/repos.d", "/var/cache/zypp/repos.d.snapshot" );
+    ///   for ( const auto & file : snapshot.files() )
+    ///     parse( file.first, file.second );
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class ConfigDirSnapshot : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const ConfigDirSnapshot & obj );
+
+    public:
+      /** Path and content of a file. */
+      typedef std::pair<Pathname,std::string> File;
+      typedef std::vector<File> Files;
+
+    public:
+      /** Read the regular files in \a dir_r, via \a snapshot_r if it is up to date.
+       * If \a snapshot_r is empty, no snapshot is used.
+       * \throws Exception if \a dir_r can not be read.
+       */
+      ConfigDirSnapshot( const Pathname & dir_r, const Pathname & snapshot_r );
+
+    public:
+      /** The files in \a dir_r in \c readdir order. */
+      const Files & files() const
+      { return _files; }
+
+      /** Whether the content was loaded from the snapshot. */
+      bool fromSnapshot() const
+      { return _fromSnapshot; }
+
+    private:
+      Pathname _dir;
+      Files _files;
+      bool _fromSnapshot;
+    };
+
+    /** \relates ConfigDirSnapshot Stream output */
+    std::ostream & operator<<( std::ostream & str, const ConfigDirSnapshot & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_CONFIGDIRSNAPSHOT_H
@@ -0,0 +1,355 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageCache.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/ContentStore.h"
+
+#include "zypp/repo/PackageCache.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef std::map<std::string,PackageCache::Entry>::iterator EntryIterator;
+
+      /** Eviction order: least recently used first. */
+      inline bool lessRecentlyUsed( const EntryIterator & lhs, const EntryIterator & rhs )
+      { return lhs->second.lastUse < rhs->second.lastUse; }
+
+      /** Eviction order: least frequently used first, the older one if used equally often. */
+      inline bool lessFrequentlyUsed( const EntryIterator & lhs, const EntryIterator & rhs )
+      {
+	if ( lhs->second.uses != rhs->second.uses )
+	  return lhs->second.uses < rhs->second.uses;
+	return lessRecentlyUsed( lhs, rhs );
+      }
+
+      /** The instances handed out by \ref PackageCache::forPath. */
+      std::map<Pathname, shared_ptr<PackageCache> > & caches()
+      {
+	static std::map<Pathname, shared_ptr<PackageCache> > _caches;
+	return _caches;
+      }
+
+      /** Collect all packages below \a dir_r (as path relative to \a root_r). */
+      void scanPackages( const Pathname & root_r, const std::string & dir_r, std::map<std::string,PathInfo> & result_r )
+      {
+	std::list<std::string> names;
+	if ( filesystem::readdir( names, root_r / dir_r, false ) != 0 )
+	  return;
+	for_( it, names.begin(), names.end() )
+	{
+	  std::string rel( dir_r.empty() ? *it : dir_r + "/" + *it );
+	  PathInfo pi( root_r / rel, PathInfo::LSTAT );
+	  if ( pi.isDir() )
+	    scanPackages( root_r, rel, result_r );
+	  else if ( pi.isFile() && str::hasSuffix( *it, ".rpm" ) )
+	    result_r[rel] = pi;
+	}
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	The usage file format:
+    //	  @hits <n>
+    //	  @misses <n>
+    //	  @saved <bytes>
+    //	  @downloaded <bytes>
+    //	  <last use> <uses> <size> <path relative to the cache dir>
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    PackageCache::PackageCache( const Pathname & root_r )
+    : _root( root_r )
+    , _file( root_r.extend( ".usage" ) )
+    , _sessionStart( Date::now() )
+    , _dirty( false )
+    {
+      if ( ! PathInfo( _file ).isFile() )
+	return;
+
+      InputStream in( _file );
+      for ( iostr::EachLine line( in ); line; line.next() )
+      {
+	if ( line->empty() )
+	  continue;
+	std::istringstream words( *line );
+	if ( (*line)[0] == '@' )
+	{
+	  std::string key;
+	  ByteCount::SizeType value = 0;
+	  if ( ! ( words >> key >> value ) )
+	    continue;
+	  if ( key == "@hits" )
+	    _stats.hits = value;
+	  else if ( key == "@misses" )
+	    _stats.misses = value;
+	  else if ( key == "@saved" )
+	    _stats.bytesSaved = value;
+	  else if ( key == "@downloaded" )
+	    _stats.bytesDownloaded = value;
+	  continue;
+	}
+
+	Date::ValueType lastUse = 0;
+	Entry entry;
+	ByteCount::SizeType size = 0;
+	std::string rel;
+	if ( ! ( words >> lastUse >> entry.uses >> size >> std::ws ) || ! std::getline( words, rel ) || rel.empty() )
+	  continue;
+	entry.lastUse = lastUse;
+	entry.size = size;
+	_entries[rel] = entry;
+      }
+      DBG << "Loaded usage of " << _entries.size() << " packages from " << _file << endl;
+    }
+
+    PackageCache & PackageCache::forPath( const Pathname & root_r )
+    {
+      shared_ptr<PackageCache> & ret( caches()[root_r] );
+      if ( ! ret )
+	ret.reset( new PackageCache( root_r ) );
+      return *ret;
+    }
+
+    PackageCache::Policy PackageCache::policyFromString( const std::string & policy_r, Policy default_r )
+    {
+      std::string policy( str::toLower( policy_r ) );
+      if ( policy == "lru" )
+	return LRU;
+      if ( policy == "lfu" )
+	return LFU;
+      if ( ! policy.empty() )
+	WAR << "Unknown package cache policy '" << policy_r << "'" << endl;
+      return default_r;
+    }
+
+    std::string PackageCache::relative( const Pathname & file_r ) const
+    {
+      const std::string & root( _root.asString() );
+      const std::string & file( file_r.asString() );
+      if ( file.size() <= root.size() + 1 || file.compare( 0, root.size(), root ) != 0 || file[root.size()] != '/' )
+	return std::string();
+      return file.substr( root.size() + 1 );
+    }
+
+    void PackageCache::hit( const Pathname & file_r )
+    {
+      ByteCount size( PathInfo( file_r ).size() );
+      // e.g. the commit asks for the packages it preloaded before
+      if ( _sessionUsed.insert( file_r.asString() ).second )
+      {
+	++_stats.hits;
+	_stats.bytesSaved += size;
+      }
+
+      std::string rel( relative( file_r ) );
+      if ( ! rel.empty() )
+      {
+	Entry & entry( _entries[rel] );
+	entry.size = size;
+	entry.lastUse = Date::now();
+	++entry.uses;
+      }
+      _dirty = true;
+    }
+
+    void PackageCache::miss( const Pathname & file_r, bool cached_r )
+    {
+      ByteCount size( PathInfo( file_r ).size() );
+      _sessionUsed.insert( file_r.asString() );
+      ++_stats.misses;
+      _stats.bytesDownloaded += size;
+
+      std::string rel( relative( file_r ) );
+      if ( ! rel.empty() )
+      {
+	if ( cached_r )
+	{
+	  Entry & entry( _entries[rel] );
+	  entry.size = size;
+	  entry.lastUse = Date::now();
+	  entry.uses = 1;
+	}
+	else
+	  _entries.erase( rel );
+      }
+      _dirty = true;
+    }
+
+    ByteCount PackageCache::size() const
+    {
+      ByteCount ret;
+      for_( it, _entries.begin(), _entries.end() )
+	ret += it->second.size;
+      return ret;
+    }
+
+    void PackageCache::sync()
+    {
+      std::map<std::string,PathInfo> found;
+      scanPackages( _root, std::string(), found );
+
+      for ( EntryIterator it = _entries.begin(); it != _entries.end(); )
+      {
+	if ( found.find( it->first ) == found.end() )
+	{
+	  _entries.erase( it++ );	// removed meanwhile
+	  _dirty = true;
+	}
+	else
+	  ++it;
+      }
+      for_( it, found.begin(), found.end() )
+      {
+	Entry & entry( _entries[it->first] );
+	if ( ! entry.lastUse )
+	{
+	  // not downloaded by us; assume it was used when it was written
+	  entry.lastUse = it->second.mtime();
+	  _dirty = true;
+	}
+	entry.size = it->second.size();
+      }
+    }
+
+    unsigned PackageCache::enforceLimit( ByteCount limit_r, Policy policy_r )
+    { return enforceLimit( limit_r, policy_r, ContentStore::instance() ); }
+
+    unsigned PackageCache::enforceLimit( ByteCount limit_r, Policy policy_r, const ContentStore & store_r )
+    {
+      if ( ! limit_r )
+	return 0;
+      sync();
+      ByteCount total( size() );
+      if ( total <= limit_r )
+	return 0;
+
+      std::vector<EntryIterator> candidates;
+      for ( EntryIterator it = _entries.begin(); it != _entries.end(); ++it )
+      {
+	if ( it->second.lastUse < _sessionStart )	// keep what we just used
+	  candidates.push_back( it );
+      }
+      std::stable_sort( candidates.begin(), candidates.end(),
+                        policy_r == LFU ? &lessFrequentlyUsed : &lessRecentlyUsed );
+
+      unsigned ret = 0;
+      bool linked = false;	// the space is freed once the store entry is gone too
+      for_( it, candidates.begin(), candidates.end() )
+      {
+	if ( total <= limit_r )
+	  break;
+	PathInfo pi( _root / (*it)->first, PathInfo::LSTAT );
+	if ( pi.nlink() > 1 )
+	  linked = true;
+	int res = filesystem::unlink( pi.path() );
+	if ( res != 0 && res != ENOENT )
+	  continue;
+	DBG << "Evict " << (*it)->first << " (" << (*it)->second.size << ")" << endl;
+	total -= (*it)->second.size;
+	_entries.erase( *it );
+	++ret;
+      }
+      _dirty = true;
+
+      if ( linked && store_r.enabled() )
+	store_r.clean();
+
+      if ( total > limit_r )
+	WAR << "Package cache " << _root << " still exceeds its limit: " << total << " > " << limit_r << endl;
+      MIL << "Evicted " << ret << " packages from " << _root << ", " << total << " left" << endl;
+      return ret;
+    }
+
+    void PackageCache::cleanup()
+    {
+      enforceLimit( ZConfig::instance().download_package_cache_limit(),
+                    policyFromString( ZConfig::instance().download_package_cache_policy() ) );
+      MIL << *this << endl;
+      save();
+    }
+
+    void PackageCache::cleanupAll()
+    {
+      // the configured caches, even if nothing was provided from them in this session
+      forPath( Pathname::assertprefix( ZConfig::instance().systemRoot(), ZConfig::instance().repoPackagesPath() ) );
+      forPath( ZConfig::instance().repoPackagesPath() );
+      for_( it, caches().begin(), caches().end() )
+	it->second->cleanup();
+    }
+
+    void PackageCache::save()
+    {
+      if ( ! _dirty )
+	return;
+      if ( filesystem::assert_dir( _file.dirname() ) != 0 )
+	return;
+
+      Pathname tmp( _file.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	out << "@hits " << _stats.hits << endl;
+	out << "@misses " << _stats.misses << endl;
+	out << "@saved " << ByteCount::SizeType(_stats.bytesSaved) << endl;
+	out << "@downloaded " << ByteCount::SizeType(_stats.bytesDownloaded) << endl;
+	for_( it, _entries.begin(), _entries.end() )
+	  out << Date::ValueType(it->second.lastUse) << " " << it->second.uses
+	      << " " << ByteCount::SizeType(it->second.size) << " " << it->first << endl;
+	if ( ! out )
+	{
+	  DBG << "Can't write " << _file << endl;	// e.g. not root
+	  filesystem::unlink( tmp );
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmp, _file ) == 0 )
+	_dirty = false;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackageCache::Statistics & obj )
+    {
+      return str << obj.hits << " hits, " << obj.misses << " misses ("
+                 << str::numstring( int( obj.hitRate() * 100 ) ) << "%), saved " << obj.bytesSaved
+                 << ", downloaded " << obj.bytesDownloaded;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackageCache & obj )
+    {
+      return str << "PackageCache(" << obj.root() << ": " << obj.entries().size() << " packages, "
+                 << obj.size() << "; " << obj.statistics() << ")";
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,174 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageCache.h
+ *
+*/
+#ifndef ZYPP_REPO_PACKAGECACHE_H
+#define ZYPP_REPO_PACKAGECACHE_H
+
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+#include "zypp/ByteCount.h"
+#include "zypp/Date.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  class ContentStore;
+
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PackageCache
+    /// \brief Usage accounting and size limit of the package cache.
+    ///
+    /// For each package below the cache directory (the repos packages
+    /// directories) the size, the last use and the number of uses are
+    /// remembered. \ref enforceLimit removes packages until the cache
+    /// fits into a size limit, either the least recently (\ref LRU) or the
+    /// least frequently (\ref LFU) used ones first. Packages used since
+    /// this object was created are never removed. As cached packages may be
+    /// hardlinked from the \ref ContentStore, store entries no longer linked
+    /// from anywhere are removed along with them.
+    ///
+    /// Hit and miss statistics are kept as well, so it's possible to
+    /// tell how many bytes the cache actually saved.
+    ///
+    /// The accounting is stored in <tt>cachedir.usage</tt> next to the cache
+    /// directory (e.g. <tt>/var/cache/zypp/packages.usage</tt>), as the
+    /// cache directory itself must contain just the repos subdirectories.
+    ///////////////////////////////////////////////////////////////////
+    class PackageCache : private base::NonCopyable
+    {
+    public:
+      /** Which packages to evict first. */
+      enum Policy
+      {
+	LRU,	//!< least recently used
+	LFU	//!< least frequently used
+      };
+
+      /** Cache usage statistics. */
+      struct Statistics
+      {
+	Statistics()
+	: hits( 0 ), misses( 0 )
+	{}
+	unsigned long hits;		//!< packages provided from the cache
+	unsigned long misses;		//!< packages downloaded
+	ByteCount bytesSaved;		//!< bytes not downloaded due to cache hits
+	ByteCount bytesDownloaded;	//!< bytes downloaded due to cache misses
+
+	/** Ratio of hits, 0.0 if nothing was requested yet. */
+	double hitRate() const
+	{ return hits + misses ? double(hits) / ( hits + misses ) : 0.0; }
+      };
+
+      /** A cached package. */
+      struct Entry
+      {
+	Entry()
+	: uses( 0 )
+	{}
+	ByteCount size;
+	Date lastUse;
+	unsigned uses;
+      };
+
+    public:
+      /** Ctor loading the accounting of the cache directory \a root_r. */
+      explicit PackageCache( const Pathname & root_r );
+
+      /** The (shared) accounting of the cache directory \a root_r. */
+      static PackageCache & forPath( const Pathname & root_r );
+
+      /** \ref cleanup the configured package caches (of the target root and
+       * the toplevel one) and all other caches handed out by \ref forPath.
+       */
+      static void cleanupAll();
+
+      /** The policy named \a policy_r (\c lru or \c lfu), or \a default_r. */
+      static Policy policyFromString( const std::string & policy_r, Policy default_r = LRU );
+
+    public:
+      /** The cache directory. */
+      const Pathname & root() const
+      { return _root; }
+
+      /** \a file_r was provided from the cache.
+       * Providing the same file again within this session is not counted as another hit.
+       */
+      void hit( const Pathname & file_r );
+
+      /** \a file_r was downloaded.
+       * It's accounted as cached unless \a cached_r is \c false (i.e. it
+       * is removed after use).
+       */
+      void miss( const Pathname & file_r, bool cached_r = true );
+
+      /** The statistics (of all sessions). */
+      const Statistics & statistics() const
+      { return _stats; }
+
+      /** The known entries, keyed by their path relative to \ref root. */
+      const std::map<std::string,Entry> & entries() const
+      { return _entries; }
+
+      /** Total size of the cache. */
+      ByteCount size() const;
+
+      /** Rescan the cache directory to learn about added and removed packages. */
+      void sync();
+
+      /** Remove packages (by \a policy_r) until the cache is not larger than \a limit_r.
+       * A \c 0 \a limit_r means unlimited.
+       * \return The number of removed packages.
+       */
+      unsigned enforceLimit( ByteCount limit_r, Policy policy_r = LRU );
+
+      /** \overload Removing unlinked entries from \a store_r rather than \ref ContentStore::instance. */
+      unsigned enforceLimit( ByteCount limit_r, Policy policy_r, const ContentStore & store_r );
+
+      /** \ref enforceLimit as configured in zypp.conf and \ref save. */
+      void cleanup();
+
+      /** Write pending changes to the usage file. */
+      void save();
+
+    private:
+      /** \a file_r relative to \ref root, or empty if it's not below \ref root. */
+      std::string relative( const Pathname & file_r ) const;
+
+    private:
+      Pathname _root;
+      Pathname _file;
+      std::map<std::string,Entry> _entries;
+      Statistics _stats;
+      Date _sessionStart;
+      std::set<std::string> _sessionUsed;
+      bool _dirty;
+    };
+
+    /** \relates PackageCache::Statistics Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackageCache::Statistics & obj );
+
+    /** \relates PackageCache Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackageCache & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_PACKAGECACHE_H
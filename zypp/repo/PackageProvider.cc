@@ -18,6 +18,7 @@
 #include "zypp/base/UserRequestException.h"
 #include "zypp/base/NonCopyable.h"
 #include "zypp/repo/PackageProvider.h"
+#include "zypp/repo/PackageCache.h"
 #include "zypp/repo/Applydeltarpm.h"
 #include "zypp/repo/PackageDelta.h"
 
@@ -30,6 +31,7 @@
 #include "zypp/Target.h"
 #include "zypp/target/rpm/RpmDb.h"
 #include "zypp/FileChecker.h"
+#include "zypp/ContentStore.h"
 
 using std::endl;
 
@@ -272,6 +274,7 @@ namespace zypp
       if ( ! ret->empty() )
       {
 	MIL << "provided Package from cache " << _package << " at " << ret << endl;
+	PackageCache::forPath( _package->repoInfo().packagesPath().dirname() ).hit( ret.value() );
 	report()->infoInCache( _package, ret );
 	return ret; // <-- cache hit
       }
@@ -288,7 +291,7 @@ namespace zypp
 	  if ( ! loc.checksum().empty() )	// no cache hit without checksum
 	  {
 	    PathInfo pi( topCache.repoPackagesCachePath / info.packagesPath().basename() / loc.filename() );
-	    if ( pi.isExist() && loc.checksum() == CheckSum( loc.checksum().type(), std::ifstream( pi.c_str() ) ) )
+	    if ( pi.isExist() && filesystem::is_checksum( pi.path(), loc.checksum() ) )
 	    {
 	      report()->start( _package, pi.path().asFileUrl() );
 	      const Pathname & dest( info.packagesPath() / loc.filename() );
@@ -299,6 +302,7 @@ namespace zypp
 		  ret.setDispose( filesystem::unlink );
 
 		MIL << "provided Package from toplevel cache " << _package << " at " << ret << endl;
+		PackageCache::forPath( topCache.repoPackagesCachePath ).hit( pi.path() );
 		report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
 		return ret; // <-- toplevel cache hit
 	      }
@@ -307,6 +311,28 @@ namespace zypp
 	}
       }
 
+      // Check the content store shared by all repos and roots
+      {
+	const OnMediaLocation & loc( _package->location() );
+	Pathname stored( ContentStore::instance().path( loc.checksum() ) );
+	if ( ! stored.empty() && PathInfo( stored ).isFile() )
+	{
+	  report()->start( _package, stored.asFileUrl() );
+	  const Pathname & dest( info.packagesPath() / loc.filename() );
+	  if ( filesystem::assert_dir( dest.dirname() ) == 0 && ContentStore::instance().provide( loc.checksum(), dest ) )
+	  {
+	    ret = ManagedFile( dest );
+	    if ( ! info.keepPackages() )
+	      ret.setDispose( filesystem::unlink );
+
+	    MIL << "provided Package from content store " << _package << " at " << ret << endl;
+	    PackageCache::forPath( info.packagesPath().dirname() ).hit( dest );
+	    report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
+	    return ret; // <-- content store hit
+	  }
+	}
+      }
+
       // FIXME we only support the first url for now.
       if ( info.baseUrlsEmpty() )
         ZYPP_THROW(Exception("No url in repository."));
@@ -405,6 +431,12 @@ namespace zypp
           }
       } while ( _retry );
 
+      PackageCache::forPath( info.packagesPath().dirname() ).miss( ret.value(), info.keepPackages() );
+
+      // share it with other repos and roots (unless it's removed after commit anyway)
+      if ( info.keepPackages() && ! _package->location().checksum().empty() )
+	ContentStore::instance().add( ret.value(), _package->location().checksum() );
+
       report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
       MIL << "provided Package " << _package << " at " << ret << endl;
       return ret;
@@ -15,6 +15,7 @@
 #include <time.h>
 #include "zypp/repo/RepoMirrorList.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/MirrorScoreboard.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/ZConfig.h"
@@ -165,6 +166,8 @@ namespace zypp
 	  zypp::filesystem::unlink( cachefile );
 	}
       }
+      // best performing mirrors first
+      media::MirrorScoreboard::instance().order( _urls );
     }
 
     /////////////////////////////////////////////////////////////////
@@ -327,9 +327,8 @@ namespace zypp
           }
           else
           {
-            std::ifstream input( ret->asString().c_str() );
-            CheckSum retChecksum( loc_r.checksum().type(), input );
-            input.close();
+            // usually computed while downloading (see CheckSumCache)
+            CheckSum retChecksum( loc_r.checksum().type(), filesystem::checksum( *ret, loc_r.checksum().type() ) );
 
             if ( loc_r.checksum() != retChecksum )
             {
@@ -7,6 +7,7 @@
 |                                                                      |
 \---------------------------------------------------------------------*/
 #include <cstring>
+#include <unordered_map>
 
 #define ZYPP_DBG_VAREXPAND 0
 #if ( ZYPP_DBG_VAREXPAND )
@@ -20,6 +21,7 @@ using std::endl;
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Regex.h"
+#include "zypp/base/SerialNumber.h"
 
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZConfig.h"
@@ -443,6 +445,13 @@ namespace zypp
 	  return _releaseverMinor;
 	}
 
+	/** Changes whenever the \c $releasever value changes (\c $arch is set just once). */
+	unsigned releaseverSerial() const
+	{
+	  assertReleaseverStr();
+	  return _releaseverSerial.serial();
+	}
+
       private:
 	void assertArchStr() const
 	{
@@ -473,9 +482,11 @@ namespace zypp
 	      _releaseverMajor = _releasever.substr( 0, pos );
 	      _releaseverMinor = _releasever.substr( pos+1 ) ;
 	    }
+	    _releaseverSerial.setDirty();
 	  }
 	}
       private:
+	mutable SerialNumber _releaseverSerial;
 	mutable std::string _arch;
 	mutable std::string _basearch;
 	mutable std::string _releasever;
@@ -483,6 +494,13 @@ namespace zypp
 	mutable std::string _releaseverMinor;
       };
 
+      /** The variables used by \ref repoVarLookup. */
+      inline const RepoVars & repoVars()
+      {
+	static const RepoVars _repoVars;
+	return _repoVars;
+      }
+
       /** \brief */
       const std::string * repoVarLookup( const std::string & name_r )
       {
@@ -500,31 +518,105 @@ namespace zypp
 
 	const std::string * ret = nullptr;
 	if ( getter )	// known var
-	{
-	  static const RepoVars _repoVars;
-	  ret = &(_repoVars.*getter)();
-	}
+	  ret = &(repoVars().*getter)();
 	return ret;
       }
+
+      /** \brief Remember expanded strings and urls, so they are expanded (and urls are reparsed) just once.
+       * Keyed by the raw string (or the urls complete string). Values using \c $releasever
+       * are valid as long as it does not change.
+       */
+      template <class Tp>
+      struct RepoVarsCache : private zypp::base::NonCopyable
+      {
+	struct Entry
+	{
+	  Tp value;
+	  bool usesReleasever;
+	  unsigned releaseverSerial;
+	};
+
+	static RepoVarsCache & instance()
+	{
+	  static RepoVarsCache _instance;
+	  return _instance;
+	}
+
+	/** The remembered value of \a key_r or \c nullptr. */
+	const Tp * find( const std::string & key_r ) const
+	{
+	  auto it = _entries.find( key_r );
+	  if ( it == _entries.end() )
+	    return nullptr;
+	  if ( it->second.usesReleasever && it->second.releaseverSerial != repoVars().releaseverSerial() )
+	    return nullptr;
+	  return &it->second.value;
+	}
+
+	/** Compute the value of \a key_r using \a compute_r (taking a \ref RepoVarExpand::VarRetriever) and remember it. */
+	template <class TCompute>
+	const Tp & compute( std::string key_r, TCompute compute_r )
+	{
+	  bool usesReleasever = false;
+	  RepoVarExpand::VarRetriever retriever = [&usesReleasever]( const std::string & name_r ) {
+	    if ( name_r.compare( 0, 10, "releasever" ) == 0 )
+	      usesReleasever = true;
+	    return repoVarLookup( name_r );
+	  };
+	  Tp value( compute_r( retriever ) );
+
+	  if ( _entries.size() >= 4096 )	// don't let the cache grow unlimited
+	    _entries.clear();
+	  Entry & entry( _entries[std::move(key_r)] );
+	  entry.value = std::move(value);
+	  entry.usesReleasever = usesReleasever;
+	  entry.releaseverSerial = usesReleasever ? repoVars().releaseverSerial() : 0;
+	  return entry.value;
+	}
+
+      private:
+	std::unordered_map<std::string,Entry> _entries;
+      };
     } // namespace
     ///////////////////////////////////////////////////////////////////
 
     std::string RepoVariablesStringReplacer::operator()( const std::string & value ) const
     {
-      return RepoVarExpand()( value, repoVarLookup );
+      if ( value.find( '$' ) == std::string::npos )
+	return value;	// nothing to expand
+
+      RepoVarsCache<std::string> & cache( RepoVarsCache<std::string>::instance() );
+      if ( const std::string * cached = cache.find( value ) )
+	return *cached;
+
+      return cache.compute( value, [&value]( RepoVarExpand::VarRetriever retriever_r ) {
+	return RepoVarExpand()( value, retriever_r );
+      } );
     }
     std::string RepoVariablesStringReplacer::operator()( std::string && value ) const
     {
-      return RepoVarExpand()( value, repoVarLookup );
+      if ( value.find( '$' ) == std::string::npos )
+	return std::move(value);	// nothing to expand
+      return operator()( static_cast<const std::string &>(value) );
     }
 
     Url RepoVariablesUrlReplacer::operator()( const Url & value ) const
     {
-      RepoVarExpand expand;
-      Url newurl( value );
-      newurl.setPathData( expand( value.getPathData(), repoVarLookup ) );
-      newurl.setQueryString( expand( value.getQueryString(), repoVarLookup ) );
-      return newurl;
+      if ( value.getPathData().find( '$' ) == std::string::npos && value.getQueryString().find( '$' ) == std::string::npos )
+	return value;	// nothing to expand
+
+      RepoVarsCache<Url> & cache( RepoVarsCache<Url>::instance() );
+      std::string key( value.asCompleteString() );
+      if ( const Url * cached = cache.find( key ) )
+	return *cached;
+
+      return cache.compute( std::move(key), [&value]( RepoVarExpand::VarRetriever retriever_r ) {
+	RepoVarExpand expand;
+	Url newurl( value );
+	newurl.setPathData( expand( value.getPathData(), retriever_r ) );
+	newurl.setQueryString( expand( value.getQueryString(), retriever_r ) );
+	return newurl;
+      } );
     }
 
   } // namespace repo
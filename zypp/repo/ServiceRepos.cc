@@ -52,25 +52,19 @@ namespace zypp
     {
       PluginServiceRepos( const ServiceInfo & service,
 			  const ServiceRepos::ProcessRepo & callback,
-			  const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() )
+			  const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc(),
+			  const ServiceRepos::PluginProcess & plugin_r = ServiceRepos::PluginProcess() )
       {
-	Url serviceUrl( service.url() );
+	ServiceRepos::PluginProcess prog( plugin_r ? plugin_r : ServiceRepos::startPlugin( service ) );
 	stringstream buffer;
+	*prog >> buffer;
 
-	ExternalProgram::Arguments args;
-	args.reserve( 3 );
-	args.push_back( "/bin/sh" );
-	args.push_back( "-c" );
-	args.push_back( serviceUrl.getPathName() );
-	ExternalProgramWithStderr prog( args );
-	prog >> buffer;
-
-	if ( prog.close() != 0 )
+	if ( prog->close() != 0 )
 	{
 	  // ServicePluginInformalException:
 	  // Ignore this error but we'd like to report it somehow...
 	  std::string errbuffer;
-	  prog.stderrGetUpTo( errbuffer, '\0' );
+	  prog->stderrGetUpTo( errbuffer, '\0' );
 	  ERR << "Capture plugin error:[" << endl << errbuffer << endl << ']' << endl;
 	  ZYPP_THROW( repo::ServicePluginInformalException( service, errbuffer ) );
 	}
@@ -80,11 +74,26 @@ namespace zypp
 
     ///////////////////////////////////////////////////////////////////
 
+    ServiceRepos::PluginProcess ServiceRepos::startPlugin( const ServiceInfo & service )
+    {
+      if ( service.type() != ServiceType::PLUGIN )
+	return PluginProcess();
+
+      Url serviceUrl( service.url() );
+      ExternalProgram::Arguments args;
+      args.reserve( 3 );
+      args.push_back( "/bin/sh" );
+      args.push_back( "-c" );
+      args.push_back( serviceUrl.getPathName() );
+      return PluginProcess( new ExternalProgramWithStderr( args ) );
+    }
+
     ServiceRepos::ServiceRepos( const ServiceInfo & service,
 				const ServiceRepos::ProcessRepo & callback,
-				const ProgressData::ReceiverFnc &progress )
+				const ProgressData::ReceiverFnc &progress,
+				const PluginProcess & plugin_r )
     : _impl( ( service.type() == ServiceType::PLUGIN )
-	   ? static_cast<ServiceRepos::Impl*>( new PluginServiceRepos( service, callback, progress ) )
+	   ? static_cast<ServiceRepos::Impl*>( new PluginServiceRepos( service, callback, progress, plugin_r ) )
            : static_cast<ServiceRepos::Impl*>( new RIMServiceRepos (service, callback, progress ) ) )
     {}
 
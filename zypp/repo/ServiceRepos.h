@@ -11,12 +11,15 @@
 #define ZYPP_REPO_SERVICE_REPOS
 
 #include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
 #include "zypp/ProgressData.h"
 #include "zypp/ServiceInfo.h"
 #include "zypp/RepoInfo.h"
 
 namespace zypp
 {
+  class ExternalProgramWithStderr;
+
   namespace repo
   {
     /**
@@ -31,9 +34,24 @@ namespace zypp
       */
       typedef function< bool( const RepoInfo & )> ProcessRepo;
 
+      /** The script of a plugin service running in background. */
+      typedef shared_ptr<ExternalProgramWithStderr> PluginProcess;
+
+      /** Start the script of the plugin service \a service in background.
+       * Pass it to the ctor to collect its output. This way the scripts of
+       * several plugin services are able to run concurrently.
+       * \return An empty \ref PluginProcess if \a service is not a plugin service.
+       */
+      static PluginProcess startPlugin( const ServiceInfo & service );
+
+      /** Ctor
+       * For plugin services, \a plugin_r may be a script started by
+       * \ref startPlugin. Otherwise the script is run here.
+       */
       ServiceRepos( const ServiceInfo & service,
                     const ProcessRepo & callback,
-                    const ProgressData::ReceiverFnc &progress = ProgressData::ReceiverFnc() );
+                    const ProgressData::ReceiverFnc &progress = ProgressData::ReceiverFnc(),
+                    const PluginProcess & plugin_r = PluginProcess() );
       ~ServiceRepos();
 
     public:
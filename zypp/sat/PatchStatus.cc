@@ -0,0 +1,361 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PatchStatus.cc
+ *
+*/
+extern "C"
+{
+#include <solv/pool.h>
+}
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/SerialNumber.h"
+#include "zypp/base/Measure.h"
+#include "zypp/sat/PatchStatus.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/Map.h"
+#include "zypp/sat/Queue.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/Capability.h"
+#include "zypp/Repository.h"
+#include "zypp/PoolItem.h"
+#include "zypp/Patch.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef std::vector<detail::IdType> Names;
+      typedef std::unordered_set<detail::IdType> NameSet;
+
+      /** Identifies a solvable across pool reloads. */
+      struct Signature
+      {
+	Signature( const Solvable & solv_r )
+	: ident( solv_r.ident().id() )
+	, edition( solv_r.edition().id() )
+	, arch( solv_r.arch().id() )
+	{}
+
+	bool operator<( const Signature & rhs ) const
+	{
+	  if ( ident != rhs.ident )
+	    return ident < rhs.ident;
+	  if ( edition != rhs.edition )
+	    return edition < rhs.edition;
+	  return arch < rhs.arch;
+	}
+
+	bool operator==( const Signature & rhs ) const
+	{ return ident == rhs.ident && edition == rhs.edition && arch == rhs.arch; }
+
+	detail::IdType ident;
+	detail::IdType edition;
+	detail::IdType arch;
+      };
+
+      /** Collect the names \a cap_r refers to. */
+      void collectNames( const Capability & cap_r, Names & names_r )
+      {
+	CapDetail detail( cap_r );
+	if ( detail.isSimple() )
+	  names_r.push_back( detail.name().id() );
+	else if ( detail.isExpression() )
+	{
+	  collectNames( detail.lhs(), names_r );
+	  collectNames( detail.rhs(), names_r );
+	}
+      }
+
+      void collectNames( const Capabilities & caps_r, Names & names_r )
+      {
+	for_( it, caps_r.begin(), caps_r.end() )
+	  collectNames( *it, names_r );
+      }
+
+      void unify( Names & names_r )
+      {
+	std::sort( names_r.begin(), names_r.end() );
+	names_r.erase( std::unique( names_r.begin(), names_r.end() ), names_r.end() );
+      }
+
+      /** The names an installed package may affect a patches status by. */
+      Names installedNames( const Solvable & solv_r )
+      {
+	Names ret;
+	ret.push_back( solv_r.ident().id() );
+	collectNames( solv_r.provides(), ret );
+	collectNames( solv_r.conflicts(), ret );
+	unify( ret );
+	return ret;
+      }
+
+      /** The names a patches status depends on. */
+      Names patchNames( const Solvable & solv_r )
+      {
+	Names ret;
+	collectNames( solv_r.provides(), ret );
+	collectNames( solv_r.requires(), ret );
+	collectNames( solv_r.conflicts(), ret );
+	LookupAttr collection( SolvAttr::updateCollection, solv_r );
+	for_( it, collection.begin(), collection.end() )
+	  ret.push_back( it.subFind( SolvAttr::updateCollectionName ).id() );
+	unify( ret );
+	return ret;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class PatchStatus::Impl
+    /// \brief PatchStatus implementation.
+    ///////////////////////////////////////////////////////////////////
+    class PatchStatus::Impl
+    {
+    public:
+      struct Entry
+      {
+	Entry( const Solvable & solv_r )
+	: signature( solv_r )
+	, repo( solv_r.repository() )
+	, status( UNDETERMINED )
+	{}
+
+	Signature signature;
+	Repository repo;
+	Status status;
+	Names names;
+      };
+
+      typedef std::map<Solvable, Entry> Patches;
+      typedef std::map<Signature, Names> Installed;
+
+    public:
+      Impl()
+      : _evaluations( 0 )
+      {}
+
+      unsigned update()
+      {
+	if ( ! _watcher.remember( Pool::instance().serial() ) )
+	  return 0;
+	debug::Measure m( "PatchStatus::update" );
+	Pool::instance().prepare();
+
+	// Names affected by added or removed installed packages
+	NameSet changed;
+	Installed installed;
+	Repository system( Pool::instance().findSystemRepo() );
+	if ( system )
+	{
+	  for_( it, system.solvablesBegin(), system.solvablesEnd() )
+	  {
+	    Names & names( installed[Signature( *it )] );
+	    if ( names.empty() )
+	      names = installedNames( *it );
+	  }
+	}
+	diff( _installed, installed, changed );
+	diff( installed, _installed, changed );
+	_installed.swap( installed );
+
+	// Patches gone, kept or new (to evaluate)
+	Queue todo;
+	Patches patches;
+	for_( it, Pool::instance().solvablesBegin(), Pool::instance().solvablesEnd() )
+	{
+	  if ( ! it->isKind<Patch>() || it->isSystem() )
+	    continue;
+	  Entry entry( *it );
+	  Patches::iterator old( _patches.find( *it ) );
+	  if ( old != _patches.end() && old->second.signature == entry.signature && old->second.repo == entry.repo )
+	  {
+	    entry = old->second;
+	    bool affected = false;
+	    for_( name, entry.names.begin(), entry.names.end() )
+	    {
+	      if ( changed.count( *name ) )
+	      {
+		affected = true;
+		break;
+	      }
+	    }
+	    if ( ! affected )
+	    {
+	      patches.insert( std::make_pair( *it, entry ) );
+	      continue;
+	    }
+	  }
+	  else
+	    entry.names = patchNames( *it );
+	  patches.insert( std::make_pair( *it, entry ) );
+	  todo.push( it->id() );
+	}
+	_patches.swap( patches );
+
+	evaluate( todo );
+	MIL << "Evaluated " << todo.size() << " of " << _patches.size() << " patches ("
+	    << changed.size() << " names changed)" << endl;
+	return todo.size();
+      }
+
+      Status status( const Solvable & patch_r )
+      {
+	update();
+	Patches::const_iterator it( _patches.find( patch_r ) );
+	return( it == _patches.end() ? UNDETERMINED : it->second.status );
+      }
+
+      SolvableSet needed()
+      {
+	update();
+	SolvableSet ret;
+	for_( it, _patches.begin(), _patches.end() )
+	{
+	  if ( it->second.status == BROKEN )
+	    ret.insert( it->first );
+	}
+	return ret;
+      }
+
+      void apply()
+      {
+	update();
+	for_( it, _patches.begin(), _patches.end() )
+	{
+	  ResStatus & status( PoolItem( it->first ).status() );
+	  switch ( it->second.status )
+	  {
+	    case UNDETERMINED:	status.setUndetermined();	break;
+	    case NONRELEVANT:	status.setNonRelevant();	break;
+	    case SATISFIED:	status.setSatisfied();		break;
+	    case BROKEN:	status.setBroken();		break;
+	  }
+	}
+      }
+
+      unsigned size() const
+      { return _patches.size(); }
+
+      unsigned evaluations() const
+      { return _evaluations; }
+
+    private:
+      /** Collect the names of packages in \a lhs_r but not in \a rhs_r. */
+      static void diff( const Installed & lhs_r, const Installed & rhs_r, NameSet & changed_r )
+      {
+	for_( it, lhs_r.begin(), lhs_r.end() )
+	{
+	  if ( rhs_r.find( it->first ) == rhs_r.end() )
+	    changed_r.insert( it->second.begin(), it->second.end() );
+	}
+      }
+
+      /** Evaluate the patches in \a todo_r against the installed system. */
+      void evaluate( Queue & todo_r )
+      {
+	if ( todo_r.empty() )
+	  return;
+
+	Map installedmap( Map::poolSize );
+	Repository system( Pool::instance().findSystemRepo() );
+	if ( system )
+	{
+	  for_( it, system.solvablesBegin(), system.solvablesEnd() )
+	    installedmap.set( it->id() );
+	}
+
+	Queue result;
+	::pool_trivial_installable( Pool::instance().get(), installedmap, todo_r, result );
+	for ( Queue::size_type i = 0; i < todo_r.size(); ++i )
+	{
+	  Status & status( _patches.find( Solvable( todo_r[i] ) )->second.status );
+	  switch ( result[i] )
+	  {
+	    case -1:	status = NONRELEVANT;	break;
+	    case 1:	status = SATISFIED;	break;
+	    case 0:	status = BROKEN;	break;
+	    default:	status = UNDETERMINED;	break;
+	  }
+	}
+	_evaluations += todo_r.size();
+      }
+
+    private:
+      SerialNumberWatcher _watcher;
+      Installed _installed;
+      Patches _patches;
+      unsigned _evaluations;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : PatchStatus
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    PatchStatus::PatchStatus()
+    : _pimpl( new Impl )
+    {}
+
+    PatchStatus::~PatchStatus()
+    {}
+
+    unsigned PatchStatus::update()
+    { return _pimpl->update(); }
+
+    PatchStatus::Status PatchStatus::status( const Solvable & patch_r )
+    { return _pimpl->status( patch_r ); }
+
+    SolvableSet PatchStatus::needed()
+    { return _pimpl->needed(); }
+
+    void PatchStatus::apply()
+    { _pimpl->apply(); }
+
+    unsigned PatchStatus::size() const
+    { return _pimpl->size(); }
+
+    unsigned PatchStatus::evaluations() const
+    { return _pimpl->evaluations(); }
+
+    std::ostream & operator<<( std::ostream & str, PatchStatus::Status obj )
+    {
+      switch ( obj )
+      {
+	case PatchStatus::UNDETERMINED:	return str << "undetermined";
+	case PatchStatus::NONRELEVANT:	return str << "nonrelevant";
+	case PatchStatus::SATISFIED:	return str << "satisfied";
+	case PatchStatus::BROKEN:	return str << "broken";
+      }
+      return str << "?";
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PatchStatus & obj )
+    {
+      return str << "PatchStatus(" << obj.size() << " patches, "
+		 << obj.evaluations() << " evaluations)";
+    }
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
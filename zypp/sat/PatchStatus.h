@@ -0,0 +1,126 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PatchStatus.h
+ *
+*/
+#ifndef ZYPP_SAT_PATCHSTATUS_H
+#define ZYPP_SAT_PATCHSTATUS_H
+
+#include <iosfwd>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/Solvable.h"
+#include "zypp/sat/SolvableSet.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PatchStatus
+    /// \brief Incrementally maintained status of all patches in the pool.
+    ///
+    /// Computes whether a patch is needed (broken), satisfied or not
+    /// relevant for the installed system, like the resolvers establish
+    /// pass does, but without solving the whole pool.
+    ///
+    /// The packages each patch refers to (by its dependencies and by its
+    /// updateinfo collection) are indexed. Whenever the pool changes (e.g.
+    /// the \c @System repo is reloaded after a commit), just the patches
+    /// referring to a name provided or conflicted by an added or removed
+    /// installed package are evaluated again. Patches added to the pool
+    /// are evaluated when they show up, the others keep their status.
+    ///
+    /// \code
+    ///   sat::PatchStatus patchStatus;
+    ///   for ( const sat::Solvable & patch : patchStatus.needed() )
+    ///     ...
+    ///   // commit, reload @System...
+    ///   patchStatus.update();	// re-evaluates only the affected patches
+    /// \endcode
+    ///
+    /// \note The status refers to the installed system. Items transacting
+    /// in the pool are not taken into account (use the resolver for this).
+    ///////////////////////////////////////////////////////////////////
+    class PatchStatus : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const PatchStatus & obj );
+
+    public:
+      /** A patches status (like \ref ResStatus::ValidateValue). */
+      enum Status
+      {
+	UNDETERMINED,	//!< not a patch (or not evaluated)
+	NONRELEVANT,	//!< does not apply to the installed system
+	SATISFIED,	//!< applies and is already installed
+	BROKEN		//!< applies and is not installed, i.e. needed
+      };
+
+    public:
+      /** Default ctor. */
+      PatchStatus();
+
+      /** Dtor */
+      ~PatchStatus();
+
+    public:
+      /** Adjust to changes in the pool.
+       * This is done implicitly by all queries below, but may be
+       * called explicitly after loading or committing.
+       * \return The number of patches evaluated.
+       */
+      unsigned update();
+
+      /** The status of \a patch_r. */
+      Status status( const Solvable & patch_r );
+
+      /** Whether \a patch_r is needed. */
+      bool isNeeded( const Solvable & patch_r )
+      { return status( patch_r ) == BROKEN; }
+
+      /** Whether \a patch_r is satisfied. */
+      bool isSatisfied( const Solvable & patch_r )
+      { return status( patch_r ) == SATISFIED; }
+
+      /** All needed patches. */
+      SolvableSet needed();
+
+      /** Write the status into the \ref ResStatus of the patches,
+       * so \ref PoolItem::isNeeded etc. reflect it without establishing
+       * the pool.
+       */
+      void apply();
+
+    public:
+      /** The number of patches known. */
+      unsigned size() const;
+
+      /** Total number of patch evaluations done. */
+      unsigned evaluations() const;
+
+    public:
+      class Impl;              ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+    };
+
+    /** \relates PatchStatus::Status Stream output */
+    std::ostream & operator<<( std::ostream & str, PatchStatus::Status obj );
+
+    /** \relates PatchStatus Stream output */
+    std::ostream & operator<<( std::ostream & str, const PatchStatus & obj );
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_PATCHSTATUS_H
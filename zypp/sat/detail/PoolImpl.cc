@@ -261,6 +261,7 @@ namespace zypp
 
       void PoolImpl::prepare() const
       {
+	debug::MeasureCounter counter( "sat::Pool::prepare" );
 	if ( _watcher.remember( _serial ) )
         {
           // After repo/solvable add/remove:
@@ -40,6 +40,7 @@ extern "C"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Algorithm.h"
+#include "zypp/base/Measure.h"
 #include "zypp/ResPool.h"
 #include "zypp/ResFilters.h"
 #include "zypp/ZConfig.h"
@@ -417,7 +418,10 @@ SATResolver::solving(const CapabilitySet & requires_caps,
     // Solve !
     MIL << "Starting solving...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    {
+      debug::MeasureCounter counter( "solver::solve" );
+      solver_solve( _satSolver, &(_jobQueue) );
+    }
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
@@ -843,7 +847,10 @@ void SATResolver::doUpdate()
     // Solve !
     MIL << "Starting solving for update...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    {
+      debug::MeasureCounter counter( "solver::solve" );
+      solver_solve( _satSolver, &(_jobQueue) );
+    }
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
@@ -45,6 +45,7 @@
 #include "zypp/target/TargetCallbackReceiver.h"
 #include "zypp/target/rpm/librpmDb.h"
 #include "zypp/target/CommitPackageCache.h"
+#include "zypp/repo/PackageCache.h"
 #include "zypp/target/RpmPostTransCollector.h"
 
 #include "zypp/parser/ProductFileReader.h"
@@ -1327,6 +1328,9 @@ namespace zypp
 	  {
 	    DBG << "dryRun/downloadOnly: Not installing/deleting anything." << endl;
 	  }
+
+	  // keep the package caches within their size limit
+	  repo::PackageCache::cleanupAll();
 	}
       }
       else
@@ -32,6 +32,7 @@ extern "C"
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
+#include "zypp/base/Measure.h"
 
 #include "zypp/Date.h"
 #include "zypp/Pathname.h"
@@ -1892,6 +1893,7 @@ void RpmDb::processConfigFiles(const std::string& line, const std::string& name,
 //
 void RpmDb::installPackage( const Pathname & filename, RpmInstFlags flags )
 {
+  debug::MeasureCounter counter( "rpm::installPackage" );
   callback::SendReport<RpmInstallReport> report;
 
   report->start(filename);
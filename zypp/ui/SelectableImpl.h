@@ -16,9 +16,11 @@
 #include "zypp/base/LogTools.h"
 
 #include "zypp/base/PtrTypes.h"
+#include "zypp/base/SerialNumber.h"
 
 #include "zypp/ResPool.h"
 #include "zypp/Resolver.h"
+#include "zypp/VendorAttr.h"
 #include "zypp/ui/Selectable.h"
 #include "zypp/ui/SelectableTraits.h"
 
@@ -68,10 +70,12 @@ namespace zypp
         for_( it, begin_r, end_r )
         {
           if ( it->status().isInstalled() )
-            _installedItems.insert( *it );
+            _installedItems.push_back( *it );
           else
-            _availableItems.insert( *it );
+            _availableItems.push_back( *it );
         }
+        std::sort( _installedItems.begin(), _installedItems.end(), SelectableTraits::IOrder() );
+        std::sort( _availableItems.begin(), _availableItems.end(), SelectableTraits::AVOrder() );
       }
 
     public:
@@ -143,32 +147,14 @@ namespace zypp
        */
       PoolItem updateCandidateObj() const
       {
-	PoolItem defaultCand( defaultCandidate() );
-
 	// multiversionInstall: This returns the candidate for the last
 	// instance installed. Actually we'd need a list here.
 
-        if ( installedEmpty() || ! defaultCand )
-          return defaultCand;
-        // Here: installed and defaultCand are non NULL and it's not a
-        //       multiversion install.
-
-        PoolItem installed( installedObj() );
-        // check vendor change
-        if ( ! ( ResPool::instance().resolver().allowVendorChange()
-                 || VendorAttr::instance().equivalent( defaultCand->vendor(), installed->vendor() ) ) )
-          return PoolItem();
-
-        // check arch change (arch noarch changes are allowed)
-        if ( defaultCand->arch() != installed->arch()
-           && ! ( defaultCand->arch() == Arch_noarch || installed->arch() == Arch_noarch ) )
-          return PoolItem();
-
-        // check greater edition
-        if ( defaultCand->edition() <= installed->edition() )
-          return PoolItem();
-
-        return defaultCand;
+        const Candidates & cands( candidates() );
+        PoolItem installed( transactingInstalled() );
+        if ( ! installed || installed == *_installedItems.begin() )
+          return cands._updateCandidate;
+        return updateCandidateFor( installed, cands._defaultCandidate, cands._allowVendorChange );
       }
 
       /** \copydoc Selectable::highestAvailableVersionObj()const */
@@ -370,12 +356,69 @@ namespace zypp
         return PoolItem();
       }
 
+      /** The candidate preferring the installed objects arch and vendor (cached). */
       PoolItem defaultCandidate() const
+      { return candidates()._defaultCandidate; }
+
+      /** Candidates not depending on the items status.
+       * They are cached until the pool content, the solvers vendor change
+       * policy or the vendor equivalence changes.
+       */
+      struct Candidates
+      {
+        Candidates()
+        : _allowVendorChange( false )
+        {}
+        PoolItem _defaultCandidate;
+        PoolItem _updateCandidate;	//!< for the best installed object
+        bool     _allowVendorChange;	//!< solver policy they were computed for
+      };
+
+      const Candidates & candidates() const
+      {
+        bool solver_allowVendorChange( ResPool::instance().resolver().allowVendorChange() );
+        // remember both serials!
+        bool dirty = _poolSerial.remember( sat::Pool::instance().serial() );
+        if ( _vendorSerial.remember( VendorAttr::instance().serial() ) )
+          dirty = true;
+        if ( dirty || solver_allowVendorChange != _candidates._allowVendorChange )
+        {
+          _candidates._allowVendorChange = solver_allowVendorChange;
+          _candidates._defaultCandidate = computeDefaultCandidate( solver_allowVendorChange );
+          _candidates._updateCandidate = installedEmpty() ? _candidates._defaultCandidate
+                                                          : updateCandidateFor( *_installedItems.begin(), _candidates._defaultCandidate, solver_allowVendorChange );
+        }
+        return _candidates;
+      }
+
+      /** \a defaultCand if it is an update candidate for \a installed. */
+      PoolItem updateCandidateFor( const PoolItem & installed, const PoolItem & defaultCand, bool solver_allowVendorChange ) const
+      {
+        if ( ! defaultCand )
+          return defaultCand;
+
+        // check vendor change
+        if ( ! ( solver_allowVendorChange
+                 || VendorAttr::instance().equivalent( defaultCand->vendor(), installed->vendor() ) ) )
+          return PoolItem();
+
+        // check arch change (arch noarch changes are allowed)
+        if ( defaultCand->arch() != installed->arch()
+           && ! ( defaultCand->arch() == Arch_noarch || installed->arch() == Arch_noarch ) )
+          return PoolItem();
+
+        // check greater edition
+        if ( defaultCand->edition() <= installed->edition() )
+          return PoolItem();
+
+        return defaultCand;
+      }
+
+      PoolItem computeDefaultCandidate( bool solver_allowVendorChange ) const
       {
         if ( ! installedEmpty() )
         {
           // prefer the installed objects arch and vendor
-          bool solver_allowVendorChange( ResPool::instance().resolver().allowVendorChange() );
           for ( const PoolItem & ipi : installed() )
           {
             PoolItem sameArch; // in case there's no same vendor at least stay with same arch.
@@ -436,6 +479,10 @@ namespace zypp
       PoolItem               _candidate;
       //! lazy initialized picklist
       mutable scoped_ptr<PickList> _picklistPtr;
+      //! cached candidates
+      mutable Candidates _candidates;
+      mutable SerialNumberWatcher _poolSerial;
+      mutable SerialNumberWatcher _vendorSerial;
     };
     ///////////////////////////////////////////////////////////////////
 
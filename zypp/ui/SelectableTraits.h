@@ -111,15 +111,17 @@ namespace zypp
         }
       };
 
-      typedef std::set<PoolItem,AVOrder>       AvailableItemSet;
-      typedef AvailableItemSet::iterator       available_iterator;
+      /** Available items, sorted by \ref AVOrder. */
+      typedef std::vector<PoolItem>            AvailableItemSet;
+      typedef AvailableItemSet::const_iterator available_iterator;
       typedef AvailableItemSet::const_iterator available_const_iterator;
       typedef AvailableItemSet::size_type      available_size_type;
 
-      typedef std::set<PoolItem,IOrder>        InstalledItemSet;
-      typedef AvailableItemSet::iterator       installed_iterator;
-      typedef AvailableItemSet::const_iterator installed_const_iterator;
-      typedef AvailableItemSet::size_type      installed_size_type;
+      /** Installed items, sorted by \ref IOrder. */
+      typedef std::vector<PoolItem>            InstalledItemSet;
+      typedef InstalledItemSet::const_iterator installed_iterator;
+      typedef InstalledItemSet::const_iterator installed_const_iterator;
+      typedef InstalledItemSet::size_type      installed_size_type;
 
       typedef std::vector<PoolItem>             PickList;
       typedef PickList::const_iterator          picklist_iterator;
@@ -19,6 +19,7 @@
 #include "zypp/target/TargetImpl.h"
 #include "zypp/ZYpp.h"
 #include "zypp/DiskUsageCounter.h"
+#include "zypp/media/UrlResolverPlugin.h"
 #include "zypp/ZConfig.h"
 #include "zypp/sat/Pool.h"
 #include "zypp/PoolItem.h"
@@ -78,7 +79,10 @@ namespace zypp
     //	METHOD TYPE : Destructor
     //
     ZYppImpl::~ZYppImpl()
-    {}
+    {
+      // don't leave it to static destruction
+      media::UrlResolverPlugin::shutdown();
+    }
 
     //------------------------------------------------------------------------
     // add/remove resolvables